@@ -0,0 +1,104 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <netbase.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+
+#include <vector>
+
+/** The number of loopback peers connected to the node. Kept below FD_SETSIZE for select(). */
+static constexpr size_t NUM_PEERS = 400;
+/** The number of peers that send a message on each wake-up. */
+static constexpr size_t NUM_ACTIVE_PEERS = 8;
+
+// Measures one socket handler wake-up on a node with many mostly idle peers,
+// each connected over loopback.
+static void ConnmanSocketHandler(benchmark::Bench& bench, const SocketEventsMode mode)
+{
+    const BasicTestingSetup testing_setup{CBaseChainParams::REGTEST, {"-nodebuglogfile", "-nodebug"}};
+
+    ConnmanTestMsg connman{0x1337, 0x1337};
+    CConnman::Options options;
+    options.nReceiveFloodSize = 1 << 20;
+    options.m_peer_connect_timeout = 60 * 60;
+    options.m_socket_events_mode = mode;
+    connman.Init(options);
+    assert(connman.StartSocketEvents());
+
+    CService addr = LookupNumeric("127.0.0.1", 0);
+    SOCKET listener = CreateSocket(addr);
+    assert(listener != INVALID_SOCKET);
+    struct sockaddr_storage sockaddr;
+    socklen_t len = sizeof(sockaddr);
+    assert(addr.GetSockAddr((struct sockaddr*)&sockaddr, &len));
+    assert(bind(listener, (struct sockaddr*)&sockaddr, len) != SOCKET_ERROR);
+    assert(listen(listener, SOMAXCONN) != SOCKET_ERROR);
+    len = sizeof(sockaddr);
+    assert(getsockname(listener, (struct sockaddr*)&sockaddr, &len) != SOCKET_ERROR);
+    assert(addr.SetSockAddr((const struct sockaddr*)&sockaddr));
+    SetSocketNonBlocking(listener, false);
+
+    std::vector<SOCKET> clients;
+    std::vector<CNode*> nodes;
+    for (size_t i = 0; i < NUM_PEERS; i++) {
+        SOCKET client = CreateSocket(addr);
+        assert(client != INVALID_SOCKET);
+        assert(ConnectSocketDirectly(addr, client, DEFAULT_CONNECT_TIMEOUT, true));
+        clients.push_back(client);
+
+        SOCKET server = accept(listener, nullptr, nullptr);
+        assert(server != INVALID_SOCKET);
+        SetSocketNonBlocking(server, true);
+
+        CNode* node = new CNode(i, NODE_NONE, 0, server, CAddress(), 0, 0, CAddress(), "", ConnectionType::INBOUND);
+        connman.AddTestNode(*node);
+        connman.RegisterSocketEvents(node);
+        nodes.push_back(node);
+    }
+
+    CSerializedNetMsg msg = CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, uint64_t{0});
+    std::vector<unsigned char> bytes;
+    V1TransportSerializer().prepareForTransport(msg, bytes);
+    bytes.insert(bytes.end(), msg.data.begin(), msg.data.end());
+
+    size_t next_peer = 0;
+    bench.run([&] {
+        for (size_t i = 0; i < NUM_ACTIVE_PEERS; i++) {
+            const SOCKET client = clients[next_peer++ % NUM_PEERS];
+            assert(send(client, (const char*)bytes.data(), bytes.size(), MSG_NOSIGNAL) == (int)bytes.size());
+        }
+
+        size_t received = 0;
+        while (received < NUM_ACTIVE_PEERS) {
+            connman.SocketHandler();
+            for (CNode* node : nodes) {
+                received += connman.ClearProcessMsg(*node);
+            }
+        }
+    });
+
+    connman.ClearTestNodes();
+    for (SOCKET client : clients) {
+        CloseSocket(client);
+    }
+    CloseSocket(listener);
+}
+
+#ifdef USE_POLL
+static void ConnmanSocketHandlerPoll(benchmark::Bench& bench) { ConnmanSocketHandler(bench, SocketEventsMode::POLL); }
+BENCHMARK(ConnmanSocketHandlerPoll);
+#else
+static void ConnmanSocketHandlerSelect(benchmark::Bench& bench) { ConnmanSocketHandler(bench, SocketEventsMode::SELECT); }
+BENCHMARK(ConnmanSocketHandlerSelect);
+#endif
+
+#ifdef USE_EPOLL
+static void ConnmanSocketHandlerEpoll(benchmark::Bench& bench) { ConnmanSocketHandler(bench, SocketEventsMode::EPOLL); }
+BENCHMARK(ConnmanSocketHandlerEpoll);
+#endif
@@ -0,0 +1,32 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/mweb_fixture.h>
+
+#include <mw/node/CoinsView.h>
+
+// Number of transactions in the benchmarked block. Each one spends an
+// output created by the previous block.
+static constexpr size_t NUM_BLOCK_TXS = 100;
+
+static void MWEBApplyBlock(benchmark::Bench& bench)
+{
+    MWEBBenchFixture fixture;
+    auto pDBView = mw::CoinsViewDB::Open(GetDataDir(), nullptr, fixture.GetDB());
+    auto pBaseView = std::make_shared<mw::CoinsViewCache>(pDBView);
+
+    std::vector<test::TxOutput> outputs;
+    test::MinedBlock block1 = fixture.MinePegInBlock(NUM_BLOCK_TXS, &outputs);
+    pBaseView->ApplyBlock(block1.GetBlock());
+
+    test::MinedBlock block2 = fixture.MineSpendBlock(outputs);
+
+    bench.unit("block").run([&] {
+        mw::CoinsViewCache view(pBaseView);
+        view.ApplyBlock(block2.GetBlock());
+    });
+}
+
+BENCHMARK(MWEBApplyBlock);
@@ -0,0 +1,74 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/mweb_fixture.h>
+
+#include <mw/crypto/Bulletproofs.h>
+#include <mw/crypto/Schnorr.h>
+
+// Schnorr::BatchVerify remembers the last 3000 signatures it verified.
+static constexpr size_t SCHNORR_CACHE_SIZE = 3000;
+
+static void BulletproofsBatchVerify(benchmark::Bench& bench, const size_t num_proofs)
+{
+    const std::vector<ProofData> proofs = MWEBBenchFixture::CreateProofs(num_proofs);
+
+    // Reset the verified proof cache before each batch, so every proof is checked.
+    bench.unit("proof").batch(num_proofs).run([&] {
+        Bulletproofs::InitCache(0);
+        bool result = Bulletproofs::BatchVerify(proofs);
+        assert(result);
+    });
+
+    Bulletproofs::InitCache(DEFAULT_MAX_RANGEPROOF_CACHE_SIZE << 20);
+}
+
+// Every proof in the batch was already verified, e.g. on mempool acceptance.
+static void BulletproofsBatchVerifyCached(benchmark::Bench& bench)
+{
+    const std::vector<ProofData> proofs = MWEBBenchFixture::CreateProofs(100);
+    Bulletproofs::BatchVerify(proofs);
+
+    bench.unit("proof").batch(proofs.size()).run([&] {
+        bool result = Bulletproofs::BatchVerify(proofs);
+        assert(result);
+    });
+}
+
+static void SchnorrBatchVerify(benchmark::Bench& bench, const size_t num_sigs)
+{
+    // Rotate through more signatures than the cache can hold, so none are cached when verified again.
+    const std::vector<SignedMessage> pool = MWEBBenchFixture::CreateSignedMessages(SCHNORR_CACHE_SIZE + 2 * num_sigs);
+    size_t offset = 0;
+
+    bench.unit("signature").batch(num_sigs).run([&] {
+        if (offset + num_sigs > pool.size()) offset = 0;
+        std::vector<SignedMessage> batch(pool.begin() + offset, pool.begin() + offset + num_sigs);
+        offset += num_sigs;
+
+        bool result = Schnorr::BatchVerify(batch);
+        assert(result);
+    });
+}
+
+static void BulletproofsBatchVerify1(benchmark::Bench& bench) { BulletproofsBatchVerify(bench, 1); }
+static void BulletproofsBatchVerify10(benchmark::Bench& bench) { BulletproofsBatchVerify(bench, 10); }
+static void BulletproofsBatchVerify100(benchmark::Bench& bench) { BulletproofsBatchVerify(bench, 100); }
+static void BulletproofsBatchVerify1000(benchmark::Bench& bench) { BulletproofsBatchVerify(bench, 1000); }
+
+static void SchnorrBatchVerify1(benchmark::Bench& bench) { SchnorrBatchVerify(bench, 1); }
+static void SchnorrBatchVerify10(benchmark::Bench& bench) { SchnorrBatchVerify(bench, 10); }
+static void SchnorrBatchVerify100(benchmark::Bench& bench) { SchnorrBatchVerify(bench, 100); }
+static void SchnorrBatchVerify1000(benchmark::Bench& bench) { SchnorrBatchVerify(bench, 1000); }
+
+BENCHMARK(BulletproofsBatchVerify1);
+BENCHMARK(BulletproofsBatchVerify10);
+BENCHMARK(BulletproofsBatchVerify100);
+BENCHMARK(BulletproofsBatchVerify1000);
+BENCHMARK(BulletproofsBatchVerifyCached);
+BENCHMARK(SchnorrBatchVerify1);
+BENCHMARK(SchnorrBatchVerify10);
+BENCHMARK(SchnorrBatchVerify100);
+BENCHMARK(SchnorrBatchVerify1000);
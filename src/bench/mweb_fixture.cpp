@@ -0,0 +1,89 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/mweb_fixture.h>
+
+#include <mw/crypto/Bulletproofs.h>
+#include <mw/crypto/Schnorr.h>
+#include <util/system.h>
+
+static constexpr size_t NUM_DISTINCT_PROOFS = 10;
+static constexpr CAmount PEGIN_AMOUNT = 5'000'000;
+static constexpr CAmount SPEND_FEE = 10'000;
+
+MWEBBenchFixture::MWEBBenchFixture()
+    : BasicTestingSetup(CBaseChainParams::REGTEST, {"-nodebuglogfile", "-nodebug"}),
+      m_miner(GetDataDir())
+{
+    m_db = MakeUnique<CDBWrapper>(GetDataDir() / "mweb_db", 1 << 20);
+    m_mweb_db = std::make_shared<MWEB::DBWrapper>(m_db.get());
+}
+
+test::MinedBlock MWEBBenchFixture::MinePegInBlock(size_t num_pegins, std::vector<test::TxOutput>* outputs)
+{
+    std::vector<test::Tx> txs;
+    txs.reserve(num_pegins);
+    for (size_t i = 0; i < num_pegins; ++i) {
+        txs.push_back(test::Tx::CreatePegIn(PEGIN_AMOUNT));
+        if (outputs != nullptr) {
+            const auto& tx_outputs = txs.back().GetOutputs();
+            outputs->insert(outputs->end(), tx_outputs.begin(), tx_outputs.end());
+        }
+    }
+
+    return m_miner.MineBlock(++m_height, txs);
+}
+
+test::MinedBlock MWEBBenchFixture::MineSpendBlock(const std::vector<test::TxOutput>& outputs)
+{
+    std::vector<test::Tx> txs;
+    txs.reserve(outputs.size());
+    for (const test::TxOutput& output : outputs) {
+        txs.push_back(test::TxBuilder()
+            .AddInput(output)
+            .AddOutput(output.GetAmount() - SPEND_FEE)
+            .AddPlainKernel(SPEND_FEE, true)
+            .Build());
+    }
+
+    return m_miner.MineBlock(++m_height, txs);
+}
+
+std::vector<ProofData> MWEBBenchFixture::CreateProofs(size_t num)
+{
+    std::vector<ProofData> distinct;
+    for (size_t i = 0; i < std::min(num, NUM_DISTINCT_PROOFS); ++i) {
+        const uint64_t value = PEGIN_AMOUNT + i;
+        BlindingFactor blind = BlindingFactor::Random();
+        std::vector<uint8_t> extra_data = secret_key_t<32>::Random().vec();
+        RangeProof::CPtr pRangeProof = Bulletproofs::Generate(
+            value,
+            SecretKey(blind.vec()),
+            SecretKey::Random(),
+            SecretKey::Random(),
+            ProofMessage(secret_key_t<20>::Random().GetBigInt()),
+            extra_data
+        );
+        distinct.push_back(ProofData{Commitment::Blinded(blind, value), pRangeProof, extra_data});
+    }
+
+    std::vector<ProofData> proofs;
+    proofs.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        proofs.push_back(distinct[i % distinct.size()]);
+    }
+
+    return proofs;
+}
+
+std::vector<SignedMessage> MWEBBenchFixture::CreateSignedMessages(size_t num)
+{
+    std::vector<SignedMessage> messages;
+    messages.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        messages.push_back(Schnorr::SignMessage(SecretKey::Random(), SecretKey::Random().GetBigInt()));
+    }
+
+    return messages;
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_MWEB_FIXTURE_H
+#define BITCOIN_BENCH_MWEB_FIXTURE_H
+
+#include <dbwrapper.h>
+#include <mweb/mweb_db.h>
+#include <test/util/setup_common.h>
+
+#include <test_framework/Miner.h>
+#include <test_framework/TxBuilder.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Generates synthetic MWEB blocks, transactions, proofs and signatures for
+ * benchmarks, using the libmw test framework's TxBuilder and Miner. Owns a
+ * temporary datadir and an MWEB database for the MMRs and leafsets.
+ */
+class MWEBBenchFixture : public BasicTestingSetup
+{
+public:
+    MWEBBenchFixture();
+
+    mw::DBWrapper::Ptr GetDB() const { return m_mweb_db; }
+
+    /**
+     * Mines the next block, containing num_pegins peg-in transactions.
+     * The spendable outputs are appended to outputs, if given.
+     */
+    test::MinedBlock MinePegInBlock(size_t num_pegins, std::vector<test::TxOutput>* outputs = nullptr);
+
+    /** Mines the next block, spending each of the given outputs to a new output. */
+    test::MinedBlock MineSpendBlock(const std::vector<test::TxOutput>& outputs);
+
+    /**
+     * Returns num range proofs. Generating range proofs is slow, so only a
+     * handful are distinct; batch verification does the same work for each.
+     */
+    static std::vector<ProofData> CreateProofs(size_t num);
+
+    /** Returns num signed messages, each with a distinct key and message. */
+    static std::vector<SignedMessage> CreateSignedMessages(size_t num);
+
+private:
+    std::unique_ptr<CDBWrapper> m_db;
+    std::shared_ptr<mw::DBWrapper> m_mweb_db;
+    test::Miner m_miner;
+    uint64_t m_height{0};
+};
+
+#endif // BITCOIN_BENCH_MWEB_FIXTURE_H
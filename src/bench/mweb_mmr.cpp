@@ -0,0 +1,105 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/mweb_fixture.h>
+
+#include <mw/mmr/LeafSet.h>
+#include <mw/mmr/MMR.h>
+#include <random.h>
+
+static std::vector<std::vector<uint8_t>> CreateLeaves(const size_t num_leaves)
+{
+    FastRandomContext rng(true);
+    std::vector<std::vector<uint8_t>> leaves;
+    leaves.reserve(num_leaves);
+    for (size_t i = 0; i < num_leaves; ++i) {
+        leaves.push_back(rng.randbytes(32));
+    }
+
+    return leaves;
+}
+
+// Appends a block's worth of output IDs, then rewinds them again.
+static void PMMRAppendRewind(benchmark::Bench& bench)
+{
+    MWEBBenchFixture fixture;
+    PMMR::Ptr pmmr = PMMR::Open('O', GetDataDir() / "mmr", 0, fixture.GetDB(), nullptr);
+    const std::vector<std::vector<uint8_t>> leaves = CreateLeaves(1000);
+
+    bench.unit("leaf").batch(leaves.size()).run([&] {
+        for (const auto& leaf : leaves) {
+            pmmr->Add(leaf);
+        }
+        pmmr->Rewind(0);
+    });
+}
+
+// Appends a large block's worth of output leaves to a cache on top of an
+// existing MMR, one leaf at a time or all at once through AddLeaves.
+static void PMMRCacheAppend(benchmark::Bench& bench, const bool bulk)
+{
+    MWEBBenchFixture fixture;
+    PMMR::Ptr pmmr = PMMR::Open('O', GetDataDir() / "mmr", 0, fixture.GetDB(), nullptr);
+    for (const auto& leaf : CreateLeaves(1000)) {
+        pmmr->Add(leaf);
+    }
+
+    PMMRCache cache(pmmr);
+    const std::vector<std::vector<uint8_t>> data = CreateLeaves(5000);
+    std::vector<mmr::Leaf> leaves;
+    for (size_t i = 0; i < data.size(); ++i) {
+        leaves.push_back(mmr::Leaf::Create(mmr::LeafIndex::At(pmmr->GetNumLeaves() + i), data[i]));
+    }
+
+    bench.unit("leaf").batch(leaves.size()).run([&] {
+        if (bulk) {
+            cache.AddLeaves(leaves);
+        } else {
+            for (const mmr::Leaf& leaf : leaves) {
+                cache.AddLeaf(leaf);
+            }
+        }
+        cache.Rewind(pmmr->GetNumLeaves());
+    });
+}
+
+static void PMMRCacheAddLeaf(benchmark::Bench& bench) { PMMRCacheAppend(bench, false); }
+static void PMMRCacheAddLeaves(benchmark::Bench& bench) { PMMRCacheAppend(bench, true); }
+
+static void PMMRRoot(benchmark::Bench& bench)
+{
+    MWEBBenchFixture fixture;
+    PMMR::Ptr pmmr = PMMR::Open('O', GetDataDir() / "mmr", 0, fixture.GetDB(), nullptr);
+    for (const auto& leaf : CreateLeaves(100'000)) {
+        pmmr->Add(leaf);
+    }
+
+    bench.run([&] {
+        mw::Hash root = pmmr->Root();
+        ankerl::nanobench::doNotOptimizeAway(root);
+    });
+}
+
+static void LeafSetAddRemove(benchmark::Bench& bench)
+{
+    MWEBBenchFixture fixture;
+    LeafSet::Ptr pLeafSet = LeafSet::Open(GetDataDir(), 0);
+    constexpr uint64_t NUM_LEAVES = 1000;
+
+    bench.unit("leaf").batch(NUM_LEAVES).run([&] {
+        for (uint64_t i = 0; i < NUM_LEAVES; ++i) {
+            pLeafSet->Add(mmr::LeafIndex::At(i));
+        }
+        for (uint64_t i = 0; i < NUM_LEAVES; ++i) {
+            pLeafSet->Remove(mmr::LeafIndex::At(i));
+        }
+    });
+}
+
+BENCHMARK(PMMRAppendRewind);
+BENCHMARK(PMMRCacheAddLeaf);
+BENCHMARK(PMMRCacheAddLeaves);
+BENCHMARK(PMMRRoot);
+BENCHMARK(LeafSetAddRemove);
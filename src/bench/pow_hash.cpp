@@ -0,0 +1,96 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/pow_hash/cn_slow_hash.hpp>
+#include <primitives/block.h>
+#include <uint256.h>
+
+static CBlockHeader MakeHeader()
+{
+    CBlockHeader header;
+    header.nVersion = 0x20000000;
+    header.hashPrevBlock = uint256S("0x7c3a1d2a6f4f1bd1dbb5a15a6d2e6b5b9b1f2b6a5c9d4e3f2a1b0c9d8e7f6a5b");
+    header.hashMerkleRoot = uint256S("0x4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b");
+    header.nTime = 1617000000;
+    header.nBits = 0x1e0ffff0;
+    header.nNonce = 0;
+    return header;
+}
+
+// Baseline: a fresh context (and scratchpad allocation) for every hash.
+static void CNPoWHashFreshContext(benchmark::Bench& bench)
+{
+    CBlockHeader header = MakeHeader();
+    uint256 hash;
+    bench.unit("hash").run([&] {
+        cn_pow_hash_v3 ctx;
+        ctx.hash(BEGIN(header.nVersion), 80, BEGIN(hash));
+        ++header.nNonce;
+    });
+}
+
+// CBlockHeader::GetPoWHash() reuses the calling thread's scratchpad.
+static void BlockHeaderGetPoWHash(benchmark::Bench& bench)
+{
+    CBlockHeader header = MakeHeader();
+    bench.unit("hash").run([&] {
+        header.GetPoWHash();
+        ++header.nNonce;
+    });
+}
+
+// Per-version, per-backend costs. The v3 (CryptoNight-GPU) hardware and
+// software paths both switch to the AVX2 inner loop when the CPU supports it.
+template <typename Hasher>
+static void CNSlowHashSoftware(benchmark::Bench& bench, const bool v3_loop)
+{
+    CBlockHeader header = MakeHeader();
+    uint256 hash;
+    Hasher ctx;
+    bench.unit("hash").run([&] {
+        if (v3_loop) {
+            ctx.software_hash_3(BEGIN(header.nVersion), 80, BEGIN(hash));
+        } else {
+            ctx.software_hash(BEGIN(header.nVersion), 80, BEGIN(hash));
+        }
+        ++header.nNonce;
+    });
+}
+
+template <typename Hasher>
+static void CNSlowHashHardware(benchmark::Bench& bench, const bool v3_loop)
+{
+#if defined(HAS_INTEL_HW) || defined(HAS_ARM_HW)
+    if (!hw_check_aes()) return;
+
+    CBlockHeader header = MakeHeader();
+    uint256 hash;
+    Hasher ctx;
+    bench.unit("hash").run([&] {
+        if (v3_loop) {
+            ctx.hardware_hash_3(BEGIN(header.nVersion), 80, BEGIN(hash));
+        } else {
+            ctx.hardware_hash(BEGIN(header.nVersion), 80, BEGIN(hash));
+        }
+        ++header.nNonce;
+    });
+#endif
+}
+
+static void CNPoWHashV1Soft(benchmark::Bench& bench) { CNSlowHashSoftware<cn_pow_hash_v1>(bench, false); }
+static void CNPoWHashV1Hard(benchmark::Bench& bench) { CNSlowHashHardware<cn_pow_hash_v1>(bench, false); }
+static void CNPoWHashV2Soft(benchmark::Bench& bench) { CNSlowHashSoftware<cn_pow_hash_v2>(bench, false); }
+static void CNPoWHashV2Hard(benchmark::Bench& bench) { CNSlowHashHardware<cn_pow_hash_v2>(bench, false); }
+static void CNPoWHashV3Soft(benchmark::Bench& bench) { CNSlowHashSoftware<cn_pow_hash_v3>(bench, true); }
+static void CNPoWHashV3Hard(benchmark::Bench& bench) { CNSlowHashHardware<cn_pow_hash_v3>(bench, true); }
+
+BENCHMARK(CNPoWHashFreshContext);
+BENCHMARK(BlockHeaderGetPoWHash);
+BENCHMARK(CNPoWHashV1Soft);
+BENCHMARK(CNPoWHashV1Hard);
+BENCHMARK(CNPoWHashV2Soft);
+BENCHMARK(CNPoWHashV2Hard);
+BENCHMARK(CNPoWHashV3Soft);
+BENCHMARK(CNPoWHashV3Hard);
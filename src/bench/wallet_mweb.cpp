@@ -0,0 +1,54 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <interfaces/chain.h>
+#include <key.h>
+#include <mw/wallet/Keychain.h>
+#include <node/context.h>
+#include <test/util/setup_common.h>
+#include <wallet/wallet.h>
+
+// Keychain::RewindOutput is called for every output the wallet scans,
+// so both the owned case and the (far more common) foreign case matter.
+static void MWEBRewindOutput(benchmark::Bench& bench, const bool owned)
+{
+    TestingSetup test_setup{
+        CBaseChainParams::REGTEST,
+        /* extra_args */ {
+            "-nodebuglogfile",
+            "-nodebug",
+        },
+    };
+
+    NodeContext node;
+    std::unique_ptr<interfaces::Chain> chain = interfaces::MakeChain(node);
+    CWallet wallet{chain.get(), "", CreateMockWalletDatabase()};
+    wallet.SetMinVersion(WalletFeature::FEATURE_HD_SPLIT);
+    LegacyScriptPubKeyMan& keyman = *wallet.GetOrCreateLegacyScriptPubKeyMan();
+
+    CKey seed_key;
+    seed_key.MakeNewKey(true);
+    keyman.SetHDSeed(keyman.DeriveNewSeed(seed_key));
+    keyman.TopUp();
+
+    mw::Keychain::Ptr keychain = keyman.GetMWEBKeychain();
+    assert(keychain != nullptr);
+
+    StealthAddress address = owned ? keychain->GetStealthAddress(2) : StealthAddress::Random();
+    BlindingFactor blind;
+    Output output = Output::Create(&blind, SecretKey::Random(), address, 1'000'000);
+
+    bench.unit("output").run([&] {
+        mw::Coin coin;
+        bool result = keychain->RewindOutput(output, coin);
+        assert(result == owned);
+    });
+}
+
+static void MWEBRewindOwnedOutput(benchmark::Bench& bench) { MWEBRewindOutput(bench, true); }
+static void MWEBRewindForeignOutput(benchmark::Bench& bench) { MWEBRewindOutput(bench, false); }
+
+BENCHMARK(MWEBRewindOwnedOutput);
+BENCHMARK(MWEBRewindForeignOutput);
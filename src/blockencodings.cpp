@@ -13,6 +13,7 @@
 #include <txmempool.h>
 #include <validation.h>
 #include <util/system.h>
+#include <mw/consensus/Params.h>
 
 #include <unordered_map>
 
@@ -34,6 +35,38 @@ CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool f
             shorttxids.push_back(GetShortID(fUseWTXID ? tx.GetWitnessHash() : tx.GetHash()));
         }
     }
+
+    // MWEB: Short IDs of the extension block's components, for peers that request them individually
+    if (!mweb_block.IsNull()) {
+        mweb_header = mweb_block.GetMWEBHeader();
+        for (const Input& input : mweb_block.m_block->GetInputs()) {
+            mweb_input_shortids.push_back(GetShortID(input.GetHash()));
+        }
+        for (const Output& output : mweb_block.m_block->GetOutputs()) {
+            mweb_output_shortids.push_back(GetShortID(output.GetHash()));
+        }
+        for (const Kernel& kernel : mweb_block.m_block->GetKernels()) {
+            mweb_kernel_shortids.push_back(GetShortID(kernel.GetHash()));
+        }
+    }
+}
+
+template <typename T>
+static bool FillMWEBComponents(std::vector<T>& components, const std::vector<T>& block_components, const std::vector<uint32_t>& indexes)
+{
+    components.reserve(indexes.size());
+    for (const uint32_t index : indexes) {
+        if (index >= block_components.size()) return false;
+        components.push_back(block_components[index]);
+    }
+    return true;
+}
+
+bool FillMWEBTransactions(MWEBTransactions& mweb_txn, const mw::Block& mweb_block, const MWEBTransactionsRequest& req)
+{
+    return FillMWEBComponents(mweb_txn.inputs, mweb_block.GetInputs(), req.input_indexes) &&
+        FillMWEBComponents(mweb_txn.outputs, mweb_block.GetOutputs(), req.output_indexes) &&
+        FillMWEBComponents(mweb_txn.kernels, mweb_block.GetKernels(), req.kernel_indexes);
 }
 
 void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
@@ -171,18 +204,91 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
             break;
     }
 
+    const ReadStatus mweb_status = InitMWEBData(cmpctblock, extra_txn);
+    if (mweb_status != READ_STATUS_OK) {
+        return mweb_status;
+    }
+
     LogPrint(BCLog::CMPCTBLOCK, "Initialized PartiallyDownloadedBlock for block %s using a cmpctblock of size %lu\n", cmpctblock.header.GetHash().ToString(), GetSerializeSize(cmpctblock, PROTOCOL_VERSION));
 
     return READ_STATUS_OK;
 }
 
+ReadStatus PartiallyDownloadedBlock::InitMWEBData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn) {
+    mweb_header = cmpctblock.mweb_header;
+    if (mweb_header == nullptr) {
+        // The MWEB block (if any) was sent in full.
+        mweb_block = cmpctblock.mweb_block;
+        return READ_STATUS_OK;
+    }
+
+    // Every input, output and kernel adds weight, so a valid block can't have more than this.
+    if (cmpctblock.mweb_input_shortids.size() > mw::MAX_NUM_INPUTS ||
+        cmpctblock.mweb_output_shortids.size() * mw::BASE_OUTPUT_WEIGHT + cmpctblock.mweb_kernel_shortids.size() * mw::BASE_KERNEL_WEIGHT > mw::MAX_BLOCK_WEIGHT)
+        return READ_STATUS_INVALID;
+
+    for (const ReadStatus status : {
+            mweb_inputs.Init(cmpctblock.mweb_input_shortids),
+            mweb_outputs.Init(cmpctblock.mweb_output_shortids),
+            mweb_kernels.Init(cmpctblock.mweb_kernel_shortids)}) {
+        if (status != READ_STATUS_OK) return status;
+    }
+
+    {
+    LOCK(pool->cs);
+    for (const auto& entry : pool->vTxHashes) {
+        const CTransaction& tx = entry.second->GetTx();
+        if (tx.HasMWEBTx()) {
+            OfferMWEBTx(cmpctblock, *tx.mweb_tx.m_transaction);
+        }
+    }
+    }
+
+    for (const auto& extra : extra_txn) {
+        if (extra.second->HasMWEBTx()) {
+            OfferMWEBTx(cmpctblock, *extra.second->mweb_tx.m_transaction);
+        }
+    }
+
+    LogPrint(BCLog::CMPCTBLOCK, "Found %lu/%lu MWEB inputs, %lu/%lu outputs and %lu/%lu kernels of block %s in mempool\n",
+        mweb_inputs.found_count, cmpctblock.mweb_input_shortids.size(),
+        mweb_outputs.found_count, cmpctblock.mweb_output_shortids.size(),
+        mweb_kernels.found_count, cmpctblock.mweb_kernel_shortids.size(),
+        cmpctblock.header.GetHash().ToString());
+
+    return READ_STATUS_OK;
+}
+
+void PartiallyDownloadedBlock::OfferMWEBTx(const CBlockHeaderAndShortTxIDs& cmpctblock, const mw::Transaction& tx) {
+    for (const Input& input : tx.GetInputs()) {
+        mweb_inputs.Offer(cmpctblock.GetShortID(input.GetHash()), input);
+    }
+    for (const Output& output : tx.GetOutputs()) {
+        mweb_outputs.Offer(cmpctblock.GetShortID(output.GetHash()), output);
+    }
+    for (const Kernel& kernel : tx.GetKernels()) {
+        mweb_kernels.Offer(cmpctblock.GetShortID(kernel.GetHash()), kernel);
+    }
+}
+
 bool PartiallyDownloadedBlock::IsTxAvailable(size_t index) const {
     assert(!header.IsNull());
     assert(index < txn_available.size());
     return txn_available[index] != nullptr;
 }
 
-ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing) {
+MWEBTransactionsRequest PartiallyDownloadedBlock::GetMissingMWEB() const {
+    assert(!header.IsNull());
+    MWEBTransactionsRequest req;
+    if (mweb_header != nullptr) {
+        req.input_indexes = mweb_inputs.GetMissing();
+        req.output_indexes = mweb_outputs.GetMissing();
+        req.kernel_indexes = mweb_kernels.GetMissing();
+    }
+    return req;
+}
+
+ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, const MWEBTransactions& mweb_missing) {
     assert(!header.IsNull());
     uint256 hash = header.GetHash();
     block = header;
@@ -195,6 +301,11 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
             if (vtx_missing.size() <= tx_missing_offset)
                 return READ_STATUS_INVALID;
             block.vtx[i] = vtx_missing[tx_missing_offset++];
+        } else if (txn_available[i]->HasMWEBTx()) {
+            // MWEB: Transactions from the mempool carry their MWEB data, which blocks store separately.
+            CMutableTransaction stripped_tx(*txn_available[i]);
+            stripped_tx.mweb_tx.SetNull();
+            block.vtx[i] = MakeTransactionRef(std::move(stripped_tx));
         } else
             block.vtx[i] = std::move(txn_available[i]);
     }
@@ -206,6 +317,22 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
     if (vtx_missing.size() != tx_missing_offset)
         return READ_STATUS_INVALID;
 
+    if (mweb_header != nullptr) {
+        std::vector<Input> inputs;
+        std::vector<Output> outputs;
+        std::vector<Kernel> kernels;
+        if (!mweb_inputs.Fill(inputs, mweb_missing.inputs) ||
+            !mweb_outputs.Fill(outputs, mweb_missing.outputs) ||
+            !mweb_kernels.Fill(kernels, mweb_missing.kernels))
+            return READ_STATUS_INVALID;
+
+        // A short ID collision can't be detected here, since the MWEB header only commits to the
+        // components through MMR roots that depend on the chain. It results in a mutated block instead.
+        block.mweb_block = MWEB::Block(std::make_shared<mw::Block>(mweb_header, TxBody{std::move(inputs), std::move(outputs), std::move(kernels)}));
+    } else if (!mweb_missing.inputs.empty() || !mweb_missing.outputs.empty() || !mweb_missing.kernels.empty()) {
+        return READ_STATUS_INVALID;
+    }
+
     BlockValidationState state;
     if (!CheckBlock(block, state, Params().GetConsensus())) {
         // TODO: We really want to just check merkle tree manually here,
@@ -218,6 +345,9 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
     }
 
     LogPrint(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
+    if (mweb_header != nullptr) {
+        LogPrint(BCLog::CMPCTBLOCK, "Reconstructed block %s requested %lu MWEB inputs, %lu outputs and %lu kernels\n", hash.ToString(), mweb_missing.inputs.size(), mweb_missing.outputs.size(), mweb_missing.kernels.size());
+    }
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing) {
             LogPrint(BCLog::CMPCTBLOCK, "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
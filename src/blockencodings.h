@@ -7,9 +7,20 @@
 
 #include <primitives/block.h>
 
+#include <boost/optional.hpp>
+
+#include <unordered_map>
 
 class CTxMemPool;
 
+/**
+ * Serialization flag for cmpctblock, getblocktxn and blocktxn messages exchanged with
+ * peers that support MWEB_SHORT_IDS_VERSION. When set, a compact block's MWEB inputs,
+ * outputs and kernels are sent as short IDs, and missing ones are requested alongside
+ * missing transactions.
+ */
+static const int SERIALIZE_MWEB_SHORT_IDS = 0x10000000;
+
 // Transaction compression schemes for compact block relay can be introduced by writing
 // an actual formatter here.
 using TransactionCompression = DefaultFormatter;
@@ -36,15 +47,51 @@ public:
     }
 };
 
+// Indexes of the MWEB inputs, outputs and kernels missing from a compact block
+class MWEBTransactionsRequest {
+public:
+    std::vector<uint32_t> input_indexes;
+    std::vector<uint32_t> output_indexes;
+    std::vector<uint32_t> kernel_indexes;
+
+    bool IsNull() const { return input_indexes.empty() && output_indexes.empty() && kernel_indexes.empty(); }
+
+    SERIALIZE_METHODS(MWEBTransactionsRequest, obj)
+    {
+        READWRITE(
+            Using<VectorFormatter<DifferenceFormatter>>(obj.input_indexes),
+            Using<VectorFormatter<DifferenceFormatter>>(obj.output_indexes),
+            Using<VectorFormatter<DifferenceFormatter>>(obj.kernel_indexes)
+        );
+    }
+};
+
+// The MWEB inputs, outputs and kernels requested by a MWEBTransactionsRequest
+class MWEBTransactions {
+public:
+    std::vector<Input> inputs;
+    std::vector<Output> outputs;
+    std::vector<Kernel> kernels;
+
+    SERIALIZE_METHODS(MWEBTransactions, obj) { READWRITE(obj.inputs, obj.outputs, obj.kernels); }
+};
+
+// Copies the MWEB inputs, outputs and kernels requested from an MWEB block. Returns false if an index is out of range.
+bool FillMWEBTransactions(MWEBTransactions& mweb_txn, const mw::Block& mweb_block, const MWEBTransactionsRequest& req);
+
 class BlockTransactionsRequest {
 public:
     // A BlockTransactionsRequest message
     uint256 blockhash;
     std::vector<uint16_t> indexes;
+    MWEBTransactionsRequest mweb_req;
 
     SERIALIZE_METHODS(BlockTransactionsRequest, obj)
     {
         READWRITE(obj.blockhash, Using<VectorFormatter<DifferenceFormatter>>(obj.indexes));
+        if (s.GetVersion() & SERIALIZE_MWEB_SHORT_IDS) {
+            READWRITE(obj.mweb_req);
+        }
     }
 };
 
@@ -53,6 +100,7 @@ public:
     // A BlockTransactions message
     uint256 blockhash;
     std::vector<CTransactionRef> txn;
+    MWEBTransactions mweb_txn;
 
     BlockTransactions() {}
     explicit BlockTransactions(const BlockTransactionsRequest& req) :
@@ -61,6 +109,9 @@ public:
     SERIALIZE_METHODS(BlockTransactions, obj)
     {
         READWRITE(obj.blockhash, Using<VectorFormatter<TransactionCompression>>(obj.txn));
+        if (s.GetVersion() & SERIALIZE_MWEB_SHORT_IDS) {
+            READWRITE(obj.mweb_txn);
+        }
     }
 };
 
@@ -96,6 +147,12 @@ protected:
     std::vector<uint64_t> shorttxids;
     std::vector<PrefilledTransaction> prefilledtxn;
 
+    // With SERIALIZE_MWEB_SHORT_IDS, the MWEB header and the short IDs of the MWEB inputs, outputs and kernels are sent instead of mweb_block
+    mw::Header::CPtr mweb_header;
+    std::vector<uint64_t> mweb_input_shortids;
+    std::vector<uint64_t> mweb_output_shortids;
+    std::vector<uint64_t> mweb_kernel_shortids;
+
 public:
     static constexpr int SHORTTXIDS_LENGTH = 6;
 
@@ -108,6 +165,7 @@ public:
     CBlockHeaderAndShortTxIDs(const CBlock& block, bool fUseWTXID);
 
     uint64_t GetShortID(const uint256& txhash) const;
+    uint64_t GetShortID(const mw::Hash& hash) const { return GetShortID(uint256(hash.vec())); }
 
     size_t BlockTxCount() const { return shorttxids.size() + prefilledtxn.size(); }
 
@@ -116,7 +174,16 @@ public:
         const bool fAllowMWEB = !(s.GetVersion() & SERIALIZE_NO_MWEB);
 		
         READWRITE(obj.header, obj.nonce, Using<VectorFormatter<CustomUintFormatter<SHORTTXIDS_LENGTH>>>(obj.shorttxids), obj.prefilledtxn);
-        if (fAllowMWEB) {
+        if (fAllowMWEB && (s.GetVersion() & SERIALIZE_MWEB_SHORT_IDS)) {
+            READWRITE(WrapOptionalPtr(obj.mweb_header));
+            if (obj.mweb_header != nullptr) {
+                READWRITE(
+                    Using<VectorFormatter<CustomUintFormatter<SHORTTXIDS_LENGTH>>>(obj.mweb_input_shortids),
+                    Using<VectorFormatter<CustomUintFormatter<SHORTTXIDS_LENGTH>>>(obj.mweb_output_shortids),
+                    Using<VectorFormatter<CustomUintFormatter<SHORTTXIDS_LENGTH>>>(obj.mweb_kernel_shortids)
+                );
+            }
+        } else if (fAllowMWEB) {
             READWRITE(obj.mweb_block);
         }
 
@@ -129,11 +196,93 @@ public:
     }
 };
 
+/**
+ * The inputs, outputs or kernels of an MWEB block being reconstructed from their short IDs,
+ * by matching the short IDs against those of the components of known MWEB transactions.
+ */
+template <typename T>
+class PartialMWEBComponents {
+    std::unordered_map<uint64_t, uint32_t> positions;
+    std::vector<boost::optional<T>> available;
+    std::vector<bool> matched;
+
+public:
+    size_t found_count = 0;
+
+    ReadStatus Init(const std::vector<uint64_t>& shortids)
+    {
+        positions.reserve(shortids.size());
+        for (size_t i = 0; i < shortids.size(); i++) {
+            positions.emplace(shortids[i], (uint32_t)i);
+        }
+        available.resize(shortids.size());
+        matched.resize(shortids.size());
+
+        // As with transactions, treat colliding short IDs as a failure, and fall back to a full block.
+        return positions.size() == shortids.size() ? READ_STATUS_OK : READ_STATUS_FAILED;
+    }
+
+    void Offer(const uint64_t shortid, const T& component)
+    {
+        auto iter = positions.find(shortid);
+        if (iter == positions.end()) return;
+
+        const uint32_t pos = iter->second;
+        if (!matched[pos]) {
+            available[pos] = component;
+            matched[pos] = true;
+            found_count++;
+        } else if (available[pos] && available[pos]->GetHash() != component.GetHash()) {
+            // If two different components match the short ID, just request it.
+            available[pos] = boost::none;
+            found_count--;
+        }
+    }
+
+    std::vector<uint32_t> GetMissing() const
+    {
+        std::vector<uint32_t> missing;
+        for (size_t i = 0; i < available.size(); i++) {
+            if (!available[i]) missing.push_back(i);
+        }
+        return missing;
+    }
+
+    bool IsComplete() const { return found_count == available.size(); }
+
+    // Returns false if the number of components supplied doesn't match the number missing.
+    bool Fill(std::vector<T>& components, const std::vector<T>& missing)
+    {
+        components.clear();
+        components.reserve(available.size());
+
+        size_t missing_offset = 0;
+        for (size_t i = 0; i < available.size(); i++) {
+            if (available[i]) {
+                components.push_back(std::move(*available[i]));
+            } else {
+                if (missing.size() <= missing_offset) return false;
+                components.push_back(missing[missing_offset++]);
+            }
+        }
+        return missing.size() == missing_offset;
+    }
+};
+
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
     size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
     const CTxMemPool* pool;
+
+    // Only used when the compact block's MWEB data was sent as short IDs
+    mw::Header::CPtr mweb_header;
+    PartialMWEBComponents<Input> mweb_inputs;
+    PartialMWEBComponents<Output> mweb_outputs;
+    PartialMWEBComponents<Kernel> mweb_kernels;
+
+    ReadStatus InitMWEBData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
+    void OfferMWEBTx(const CBlockHeaderAndShortTxIDs& cmpctblock, const mw::Transaction& tx);
 public:
     CBlockHeader header;
     MWEB::Block mweb_block;
@@ -142,7 +291,9 @@ public:
     // extra_txn is a list of extra transactions to look at, in <witness hash, reference> form
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
-    ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
+    // Indexes of the MWEB inputs, outputs and kernels that couldn't be found and must be requested
+    MWEBTransactionsRequest GetMissingMWEB() const;
+    ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, const MWEBTransactions& mweb_missing = {});
 };
 
 #endif // BITCOIN_BLOCKENCODINGS_H
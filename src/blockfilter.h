@@ -88,6 +88,7 @@ constexpr uint32_t BASIC_FILTER_M = 784931;
 enum class BlockFilterType : uint8_t
 {
     BASIC = 0,
+    MWEB = 1, //!< MWEB output IDs, spent output IDs and pegout scripts
     INVALID = 255,
 };
 
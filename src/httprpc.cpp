@@ -7,8 +7,10 @@
 #include <chainparams.h>
 #include <crypto/hmac_sha256.h>
 #include <httpserver.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <util/memory.h>
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <util/translation.h>
@@ -27,6 +29,44 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Maximum size of a request that's parsed to pick its work queue. Larger requests are served on the default queue. */
+static const size_t MAX_CLASSIFIED_REQUEST_SIZE = 64 * 1024;
+
+/** Methods that only report a little state, as polled by monitoring */
+static const std::set<std::string> LIGHT_RPC_METHODS{
+    "getbestblockhash",
+    "getblockchaininfo",
+    "getblockcount",
+    "getblockhash",
+    "getconnectioncount",
+    "getdifficulty",
+    "getmempoolinfo",
+    "getnetworkinfo",
+    "getrpcinfo",
+    "ping",
+    "uptime",
+};
+
+/** Methods that serialize whole blocks or the mempool, or scan the UTXO set or the chain */
+static const std::set<std::string> HEAVY_RPC_METHODS{
+    "dumptxoutset",
+    "getblock",
+    "getblockstats",
+    "getchaintxstats",
+    "getmempoolancestors",
+    "getmempooldescendants",
+    "getrawmempool",
+    "getrawtransaction",
+    "gettxoutproof",
+    "gettxoutsetinfo",
+    "importdescriptors",
+    "importmulti",
+    "importwallet",
+    "rescanblockchain",
+    "scantxoutset",
+    "verifychain",
+};
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -180,6 +220,8 @@ static bool HTTPReq_JSONRPC(const util::Ref& context, HTTPRequest* req)
         return false;
     }
 
+    // Set once a method starts streaming its result
+    std::unique_ptr<JSONStreamWriter> stream;
     try {
         // Parse request
         UniValue valRequest;
@@ -204,8 +246,30 @@ static bool HTTPReq_JSONRPC(const util::Ref& context, HTTPRequest* req)
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
+            jreq.start_result_stream = [req, &stream]() -> JSONStreamWriter& {
+                assert(!stream);
+                req->WriteHeader("Content-Type", "application/json");
+                req->StartChunkedReply(HTTP_OK);
+                stream = MakeUnique<JSONStreamWriter>([req](std::string&& chunk) {
+                    req->WriteReplyChunk(std::move(chunk));
+                });
+                stream->BeginObject();
+                stream->Key("result");
+                return *stream;
+            };
             UniValue result = tableRPC.execute(jreq);
 
+            if (stream) {
+                // The result was streamed, so finish the reply object around it
+                stream->KeyValue("error", NullUniValue);
+                stream->KeyValue("id", jreq.id);
+                stream->EndObject();
+                stream->Flush();
+                req->WriteReplyChunk("\n");
+                req->EndChunkedReply();
+                return true;
+            }
+
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
 
@@ -235,15 +299,57 @@ static bool HTTPReq_JSONRPC(const util::Ref& context, HTTPRequest* req)
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
+        if (stream) {
+            // Too late to send an error reply, so cut the reply short
+            LogPrintf("RPC method %s failed while streaming its result: %s\n", jreq.strMethod, objError.write());
+            req->EndChunkedReply();
+            return false;
+        }
         JSONErrorReply(req, objError, jreq.id);
         return false;
     } catch (const std::exception& e) {
+        if (stream) {
+            LogPrintf("RPC method %s failed while streaming its result: %s\n", jreq.strMethod, e.what());
+            req->EndChunkedReply();
+            return false;
+        }
         JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
         return false;
     }
     return true;
 }
 
+static HTTPWorkClass GetRPCWorkClass(const UniValue& request)
+{
+    if (!request.isObject()) return HTTPWorkClass::DEFAULT;
+    const UniValue& method = find_value(request, "method");
+    if (!method.isStr()) return HTTPWorkClass::DEFAULT;
+
+    if (LIGHT_RPC_METHODS.count(method.get_str())) return HTTPWorkClass::LIGHT;
+    if (HEAVY_RPC_METHODS.count(method.get_str())) return HTTPWorkClass::HEAVY;
+    return HTTPWorkClass::DEFAULT;
+}
+
+/** Pick the work queue of a JSON-RPC request from the methods it calls */
+static HTTPWorkClass ClassifyJSONRPC(HTTPRequest* req)
+{
+    std::string body;
+    UniValue valRequest;
+    if (!req->PeekBody(MAX_CLASSIFIED_REQUEST_SIZE, body) || !valRequest.read(body)) {
+        return HTTPWorkClass::DEFAULT;
+    }
+    if (!valRequest.isArray() || valRequest.empty()) {
+        return GetRPCWorkClass(valRequest);
+    }
+
+    // A batch is served on the queue of its most expensive request
+    HTTPWorkClass work_class = HTTPWorkClass::LIGHT;
+    for (size_t i = 0; i < valRequest.size(); i++) {
+        work_class = std::max(work_class, GetRPCWorkClass(valRequest[i]));
+    }
+    return work_class;
+}
+
 static bool InitRPCAuthentication()
 {
     if (gArgs.GetArg("-rpcpassword", "") == "")
@@ -291,9 +397,10 @@ bool StartHTTPRPC(const util::Ref& context)
         return false;
 
     auto handle_rpc = [&context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    auto classify_rpc = [](HTTPRequest* req, const std::string&) { return ClassifyJSONRPC(req); };
+    RegisterHTTPHandler("/", true, handle_rpc, classify_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, classify_rpc);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -16,6 +16,7 @@
 #include <util/threadnames.h>
 #include <util/translation.h>
 
+#include <array>
 #include <deque>
 #include <memory>
 #include <stdio.h>
@@ -73,9 +74,14 @@ private:
     /** Mutex protects entire object */
     Mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
+    /** Work items, with the time they were queued in microseconds */
+    std::deque<std::pair<std::unique_ptr<WorkItem>, int64_t>> queue;
     bool running;
     size_t maxDepth;
+    uint64_t served{0};
+    uint64_t rejected{0};
+    int64_t totalWait{0};
+    int64_t maxWait{0};
 
 public:
     explicit WorkQueue(size_t _maxDepth) : running(true),
@@ -92,9 +98,10 @@ public:
     {
         LOCK(cs);
         if (queue.size() >= maxDepth) {
+            rejected++;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queue.emplace_back(std::unique_ptr<WorkItem>(item), GetTimeMicros());
         cond.notify_one();
         return true;
     }
@@ -109,8 +116,12 @@ public:
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
+                i = std::move(queue.front().first);
+                const int64_t wait = GetTimeMicros() - queue.front().second;
                 queue.pop_front();
+                served++;
+                totalWait += wait;
+                maxWait = std::max(maxWait, wait);
             }
             (*i)();
         }
@@ -122,17 +133,45 @@ public:
         running = false;
         cond.notify_all();
     }
+    /** Fill in the depth and latency of the queue */
+    void GetStats(HTTPWorkQueueStats& stats)
+    {
+        LOCK(cs);
+        stats.max_depth = maxDepth;
+        stats.depth = queue.size();
+        stats.served = served;
+        stats.rejected = rejected;
+        stats.total_wait = totalWait;
+        stats.max_wait = maxWait;
+    }
 };
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
+};
+
+static constexpr size_t NUM_HTTP_WORK_CLASSES = 3;
+
+/** Options for the work queue of each HTTPWorkClass, in the order of HTTPWorkClass */
+static const struct {
+    HTTPWorkClass work_class;
+    const char* thread_name;
+    const char* threads_arg;
+    int default_threads;
+    const char* depth_arg;
+    int default_depth;
+} work_queue_options[NUM_HTTP_WORK_CLASSES] = {
+      {HTTPWorkClass::LIGHT, "httplight", "-rpclightthreads", DEFAULT_HTTP_LIGHT_THREADS, "-rpclightworkqueue", DEFAULT_HTTP_LIGHT_WORKQUEUE},
+      {HTTPWorkClass::DEFAULT, "httpworker", "-rpcthreads", DEFAULT_HTTP_THREADS, "-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE},
+      {HTTPWorkClass::HEAVY, "httpheavy", "-rpcheavythreads", DEFAULT_HTTP_HEAVY_THREADS, "-rpcheavyworkqueue", DEFAULT_HTTP_HEAVY_WORKQUEUE},
 };
 
 /** HTTP module state */
@@ -143,8 +182,10 @@ static struct event_base* eventBase = nullptr;
 static struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = nullptr;
+//! Work queues for handling longer requests off the event loop thread, one per HTTPWorkClass
+static std::array<WorkQueue<HTTPClosure>*, NUM_HTTP_WORK_CLASSES> workQueues{};
+//! Number of threads serving each work queue
+static std::array<int, NUM_HTTP_WORK_CLASSES> workQueueThreads{};
 //! Handlers for (sub)paths
 static std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -189,6 +230,19 @@ static bool InitHTTPAllowList()
     return true;
 }
 
+std::string HTTPWorkClassString(HTTPWorkClass work_class)
+{
+    switch (work_class) {
+    case HTTPWorkClass::LIGHT:
+        return "light";
+    case HTTPWorkClass::DEFAULT:
+        return "default";
+    case HTTPWorkClass::HEAVY:
+        return "heavy";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
 /** HTTP request method as string - use for logging only */
 std::string RequestMethodString(HTTPRequest::RequestMethod m)
 {
@@ -263,12 +317,15 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        const HTTPWorkClass work_class = i->classifier ? i->classifier(hreq.get(), path) : HTTPWorkClass::DEFAULT;
+        const size_t queue_index = static_cast<size_t>(work_class);
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        assert(workQueues[queue_index]);
+        if (workQueues[queue_index]->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            LogPrintf("WARNING: request rejected because %s http work queue depth exceeded, it can be increased with the %s= setting\n",
+                      HTTPWorkClassString(work_class), work_queue_options[queue_index].depth_arg);
             item->req->WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Work queue depth exceeded");
         }
     } else {
@@ -337,9 +394,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, const char* thread_name, int worker_num)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    util::ThreadRename(strprintf("%s.%i", thread_name, worker_num));
     queue->Run();
 }
 
@@ -397,10 +454,15 @@ bool InitHTTPServer()
     }
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    for (size_t i = 0; i < NUM_HTTP_WORK_CLASSES; i++) {
+        const auto& options = work_queue_options[i];
+        assert(static_cast<size_t>(options.work_class) == i);
+        int workQueueDepth = std::max((long)gArgs.GetArg(options.depth_arg, options.default_depth), 1L);
+        LogPrintf("HTTP: creating %s work queue of depth %d\n", HTTPWorkClassString(options.work_class), workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+        workQueues[i] = new WorkQueue<HTTPClosure>(workQueueDepth);
+        workQueueThreads[i] = std::max((long)gArgs.GetArg(options.threads_arg, options.default_threads), 1L);
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -427,12 +489,13 @@ static std::vector<std::thread> g_thread_http_workers;
 void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, i);
+    for (size_t i = 0; i < NUM_HTTP_WORK_CLASSES; i++) {
+        LogPrintf("HTTP: starting %d %s worker threads\n", workQueueThreads[i], HTTPWorkClassString(work_queue_options[i].work_class));
+        for (int j = 0; j < workQueueThreads[i]; j++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueues[i], work_queue_options[i].thread_name, j);
+        }
     }
 }
 
@@ -443,19 +506,21 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (workQueue)
-        workQueue->Interrupt();
+    for (WorkQueue<HTTPClosure>* workQueue : workQueues) {
+        if (workQueue)
+            workQueue->Interrupt();
+    }
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (workQueue) {
-        LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
-        for (auto& thread: g_thread_http_workers) {
-            thread.join();
-        }
-        g_thread_http_workers.clear();
+    LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
+    for (auto& thread: g_thread_http_workers) {
+        thread.join();
+    }
+    g_thread_http_workers.clear();
+    for (WorkQueue<HTTPClosure>*& workQueue : workQueues) {
         delete workQueue;
         workQueue = nullptr;
     }
@@ -485,6 +550,20 @@ struct event_base* EventBase()
     return eventBase;
 }
 
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    std::vector<HTTPWorkQueueStats> stats;
+    for (size_t i = 0; i < NUM_HTTP_WORK_CLASSES; i++) {
+        if (!workQueues[i]) continue;
+        HTTPWorkQueueStats queue_stats;
+        queue_stats.work_class = work_queue_options[i].work_class;
+        queue_stats.threads = workQueueThreads[i];
+        workQueues[i]->GetStats(queue_stats);
+        stats.push_back(queue_stats);
+    }
+    return stats;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
 {
     // Static handler: simply call inner handler
@@ -517,7 +596,11 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_re
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (replyStarted && !replySent) {
+        // The status was sent already, so end the reply as it is
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -556,6 +639,23 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+bool HTTPRequest::PeekBody(size_t max_size, std::string& body) const
+{
+    body.clear();
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return true;
+    size_t size = evbuffer_get_length(buf);
+    if (size > max_size)
+        return false;
+    body.resize(size);
+    if (size > 0 && evbuffer_copyout(buf, &body[0], size) != (ev_ssize_t)size) {
+        body.clear();
+        return false;
+    }
+    return true;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -563,6 +663,22 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket once a reply was sent. This is the
+ * second part of the libevent workaround in http_request_cb.
+ */
+static void http_reenable_read(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -570,7 +686,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
-    assert(!replySent && req);
+    assert(!replySent && !replyStarted && req);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -581,17 +697,57 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
-        }
+        http_reenable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/* Chunked replies are sent by the main http thread too. Events are handled
+ * in the order they're triggered, so the chunks are sent in order.
+ */
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !replyStarted && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+    replyStarted = true;
+}
+
+void HTTPRequest::WriteReplyChunk(std::string&& chunk)
+{
+    assert(replyStarted && !replySent && req);
+    if (chunk.empty()) return;
+
+    // Hand the chunk to libevent without copying it, freeing it once it's sent
+    std::string* data = new std::string(std::move(chunk));
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add_reference(evb, data->data(), data->size(), [](const void*, size_t, void* arg) {
+        delete static_cast<std::string*>(arg);
+    }, data);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb]{
+        evhttp_send_reply_chunk(req_copy, evb);
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(replyStarted && !replySent && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy]{
+        evhttp_send_reply_end(req_copy);
+        http_reenable_read(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
@@ -638,10 +794,10 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -5,13 +5,41 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <cstdint>
 #include <string>
 #include <functional>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
+static const int DEFAULT_HTTP_LIGHT_THREADS=2;
+static const int DEFAULT_HTTP_LIGHT_WORKQUEUE=16;
+static const int DEFAULT_HTTP_HEAVY_THREADS=2;
+static const int DEFAULT_HTTP_HEAVY_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/** How expensive a request is to serve. Each class has its own work queue
+ * and threads, so slow requests can't hold up cheap ones.
+ */
+enum class HTTPWorkClass {
+    LIGHT,   //!< Cheap status queries, such as polling for the best block
+    DEFAULT,
+    HEAVY,   //!< Requests that serialize whole blocks or the mempool, or scan the UTXO set
+};
+std::string HTTPWorkClassString(HTTPWorkClass work_class);
+
+/** Statistics of the work queue of one HTTPWorkClass */
+struct HTTPWorkQueueStats {
+    HTTPWorkClass work_class;
+    int threads;
+    size_t max_depth;
+    size_t depth;        //!< Requests waiting for a thread
+    uint64_t served;     //!< Requests taken off the queue by a thread
+    uint64_t rejected;   //!< Requests rejected because the queue was full
+    int64_t total_wait;  //!< Time served requests waited in the queue, in microseconds
+    int64_t max_wait;    //!< Longest time a served request waited in the queue, in microseconds
+};
+
 struct evhttp_request;
 struct event_base;
 class CService;
@@ -35,13 +63,21 @@ void StopHTTPServer();
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
 
+/** Statistics of the work queues, in the order of HTTPWorkClass. Empty if the server isn't initialized. */
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work queue a request to a certain HTTP path is served on.
+ * Called on the HTTP event loop thread, so it must be quick.
+ */
+typedef std::function<HTTPWorkClass(HTTPRequest* req, const std::string &)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are served on the DEFAULT work queue, unless
+ * a classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -58,6 +94,7 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool replyStarted{false};
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, bool replySent = false);
@@ -97,6 +134,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Read request body without consuming it, if it's at most max_size bytes.
+     * Returns false if the body is larger.
+     */
+    bool PeekBody(size_t max_size, std::string& body) const;
+
     /**
      * Write output header.
      *
@@ -113,6 +156,27 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start an HTTP reply whose body is sent in chunks, using chunked transfer
+     * encoding, so it can be sent before all of it has been built.
+     * nStatus is the HTTP status code to send.
+     *
+     * @note Call this instead of WriteReply, then call WriteReplyChunk for each
+     * chunk of the body and EndChunkedReply once it's complete.
+     */
+    void StartChunkedReply(int nStatus);
+
+    /** Write the next chunk of a reply started with StartChunkedReply. */
+    void WriteReplyChunk(std::string&& chunk);
+
+    /**
+     * End a reply started with StartChunkedReply.
+     *
+     * @note As this will give the request back to the main thread, do not call
+     * any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
 };
 
 /** Event handler closure.
@@ -0,0 +1,112 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/mwebindex.h>
+#include <chain.h>
+#include <clientversion.h>
+#include <util/system.h>
+#include <validation.h>
+
+constexpr char DB_MWEB_OUTPUT = 'o';
+
+std::unique_ptr<MWEBIndex> g_mwebindex;
+
+/** Access to the MWEB output index database (indexes/mwebindex/) */
+class MWEBIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the location of the output with the given ID. Returns false if the
+    /// output ID is not indexed.
+    bool ReadOutputPos(const uint256& output_id, MWEBOutputPos& pos) const;
+
+    /// Write a batch of output locations to the DB.
+    bool WriteOutputs(const std::vector<std::pair<uint256, MWEBOutputPos>>& v_pos);
+};
+
+MWEBIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "mwebindex", n_cache_size, f_memory, f_wipe)
+{}
+
+bool MWEBIndex::DB::ReadOutputPos(const uint256& output_id, MWEBOutputPos& pos) const
+{
+    return Read(std::make_pair(DB_MWEB_OUTPUT, output_id), pos);
+}
+
+bool MWEBIndex::DB::WriteOutputs(const std::vector<std::pair<uint256, MWEBOutputPos>>& v_pos)
+{
+    CDBBatch batch(*this);
+    for (const auto& tuple : v_pos) {
+        batch.Write(std::make_pair(DB_MWEB_OUTPUT, tuple.first), tuple.second);
+    }
+    return WriteBatch(batch);
+}
+
+MWEBIndex::MWEBIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<MWEBIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+MWEBIndex::~MWEBIndex() {}
+
+bool MWEBIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (block.mweb_block.IsNull()) return true;
+
+    const mw::Block::CPtr& mweb_block = block.mweb_block.m_block;
+    const std::vector<Output>& outputs = mweb_block->GetOutputs();
+
+    // The header commits to the size of the output MMR after the block's outputs were appended.
+    const uint64_t first_leaf = block.mweb_block.GetMWEBHeader()->GetNumTXOs() - outputs.size();
+
+    // After the block header come the transactions, the MWEB block's presence flag,
+    // its header and inputs, and then the outputs.
+    uint32_t output_offset = ::GetSerializeSize(block.vtx, CLIENT_VERSION) + 1 +
+        ::GetSerializeSize(*mweb_block->GetHeader(), CLIENT_VERSION) +
+        ::GetSerializeSize(mweb_block->GetInputs(), CLIENT_VERSION) +
+        GetSizeOfCompactSize(outputs.size());
+
+    std::vector<std::pair<uint256, MWEBOutputPos>> vPos;
+    vPos.reserve(outputs.size());
+    for (size_t i = 0; i < outputs.size(); i++) {
+        MWEBOutputPos pos;
+        pos.block_pos = pindex->GetBlockPos();
+        pos.height = pindex->nHeight;
+        pos.position = i;
+        pos.leaf_index = first_leaf + i;
+        pos.output_offset = output_offset;
+        vPos.emplace_back(uint256(outputs[i].GetOutputID().vec()), pos);
+        output_offset += ::GetSerializeSize(outputs[i], CLIENT_VERSION);
+    }
+    return m_db->WriteOutputs(vPos);
+}
+
+BaseIndex::DB& MWEBIndex::GetDB() const { return *m_db; }
+
+bool MWEBIndex::FindOutput(const mw::Hash& output_id, uint256& block_hash, MWEBOutputPos& pos, Output& output) const
+{
+    if (!m_db->ReadOutputPos(uint256(output_id.vec()), pos)) {
+        return false;
+    }
+
+    CAutoFile file(OpenBlockFile(pos.block_pos, true), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        return error("%s: OpenBlockFile failed", __func__);
+    }
+    CBlockHeader header;
+    try {
+        file >> header;
+        if (fseek(file.Get(), pos.output_offset, SEEK_CUR)) {
+            return error("%s: fseek(...) failed", __func__);
+        }
+        file >> output;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    if (output.GetOutputID() != output_id) {
+        return error("%s: output id mismatch", __func__);
+    }
+    block_hash = header.GetHash();
+    return true;
+}
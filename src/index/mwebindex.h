@@ -0,0 +1,75 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_MWEBINDEX_H
+#define BITCOIN_INDEX_MWEBINDEX_H
+
+#include <flatfile.h>
+#include <index/base.h>
+#include <mw/models/crypto/Hash.h>
+#include <mw/models/tx/Output.h>
+#include <serialize.h>
+
+/** Location of an MWEB output in the chain. */
+struct MWEBOutputPos
+{
+    //! Disk location of the block that created the output.
+    FlatFilePos block_pos;
+    //! Height of the block that created the output.
+    int height{0};
+    //! Position of the output within the block's MWEB outputs.
+    uint32_t position{0};
+    //! Leaf index of the output in the output MMR.
+    uint64_t leaf_index{0};
+    //! Offset of the serialized output from the end of the block header on disk.
+    uint32_t output_offset{0};
+
+    SERIALIZE_METHODS(MWEBOutputPos, obj)
+    {
+        READWRITE(obj.block_pos, VARINT_MODE(obj.height, VarIntMode::NONNEGATIVE_SIGNED), VARINT(obj.position), VARINT(obj.leaf_index), VARINT(obj.output_offset));
+    }
+};
+
+/**
+ * MWEBIndex is used to look up MWEB outputs included in the blockchain by output ID,
+ * whether or not they have since been spent. The index is written to a LevelDB
+ * database and records the block, position, disk offset and output MMR leaf index of
+ * each output, so an output is read from disk without deserializing its block.
+ */
+class MWEBIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "mwebindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit MWEBIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~MWEBIndex() override;
+
+    /// Look up an MWEB output by its ID.
+    ///
+    /// @param[in]   output_id  The ID of the output to be returned.
+    /// @param[out]  block_hash  The hash of the block that created the output.
+    /// @param[out]  pos  The location of the output in the chain.
+    /// @param[out]  output  The output itself.
+    /// @return  true if the output is found, false otherwise
+    bool FindOutput(const mw::Hash& output_id, uint256& block_hash, MWEBOutputPos& pos, Output& output) const;
+};
+
+/// The global MWEB output index. May be null.
+extern std::unique_ptr<MWEBIndex> g_mwebindex;
+
+#endif // BITCOIN_INDEX_MWEBINDEX_H
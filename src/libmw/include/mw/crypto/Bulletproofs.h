@@ -8,9 +8,20 @@
 #include <mw/models/crypto/SecretKey.h>
 #include <memory>
 
+// Default size of the verified range proof cache, in MiB.
+static constexpr size_t DEFAULT_MAX_RANGEPROOF_CACHE_SIZE = 16;
+
 class Bulletproofs
 {
 public:
+    /// <summary>
+    /// Resizes the cache of verified range proofs. Not thread-safe with concurrent verification,
+    /// so this should only be called during startup.
+    /// </summary>
+    /// <param name="max_bytes">The maximum number of bytes to use for the cache.</param>
+    /// <returns>The number of proofs the cache is able to store.</returns>
+    static size_t InitCache(const size_t max_bytes);
+
     static bool BatchVerify(
         const std::vector<ProofData>& rangeProofs
     );
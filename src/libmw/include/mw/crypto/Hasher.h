@@ -71,6 +71,33 @@ private:
 extern mw::Hash Hashed(const std::vector<uint8_t>& serialized);
 extern mw::Hash Hashed(const Traits::ISerializable& serializable);
 
+/// <summary>
+/// Hashes many inputs of the same length at once, letting the BLAKE3 SIMD backends
+/// compress several inputs side by side. Equivalent to calling Hashed on each input.
+/// </summary>
+/// <param name="serialized">The inputs, concatenated.</param>
+/// <param name="input_len">The length of each input. Must be between 1 and 1024 bytes.</param>
+/// <returns>The hash of each input, in order.</returns>
+extern std::vector<mw::Hash> HashedMany(const std::vector<uint8_t>& serialized, const size_t input_len);
+
+/// <summary>
+/// Calculates the BLAKE3 chaining value of one 1 KiB chunk of an input that spans more than one chunk.
+/// Together with HashedFromChunks, this lets the hash of a large input be updated by rehashing only the chunks that changed.
+/// </summary>
+/// <param name="chunk">The chunk's bytes.</param>
+/// <param name="len">The length of the chunk. Must be BLAKE3_CHUNK_LEN, except for the input's last chunk.</param>
+/// <param name="chunk_idx">The position of the chunk in the input.</param>
+/// <returns>The chunk's chaining value.</returns>
+extern mw::Hash ChunkChainingValue(const uint8_t* chunk, const size_t len, const uint64_t chunk_idx);
+
+/// <summary>
+/// Calculates the hash of an input from the chaining values of all of its chunks.
+/// Equivalent to calling Hashed on the whole input.
+/// </summary>
+/// <param name="chunk_cvs">The chaining value of each chunk, in order. There must be at least 2 chunks.</param>
+/// <returns>The hash of the input.</returns>
+extern mw::Hash HashedFromChunks(const std::vector<mw::Hash>& chunk_cvs);
+
 template<class T>
 mw::Hash Hashed(const EHashTag tag, const T& serializable)
 {
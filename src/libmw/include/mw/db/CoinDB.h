@@ -12,6 +12,24 @@ class CoinDB
 public:
 	using UPtr = std::unique_ptr<CoinDB>;
 
+	//
+	// Iterates over every UTXO in the database, in order of output ID.
+	// The UTXOs are read from a snapshot of the database taken when the cursor was created,
+	// so writes made afterwards are not visible.
+	//
+	class Cursor
+	{
+	public:
+		explicit Cursor(std::unique_ptr<mw::DBIterator>&& pIterator);
+
+		bool Valid() const;
+		void Next() { m_pIterator->Next(); }
+		UTXO::CPtr GetUTXO() const;
+
+	private:
+		std::unique_ptr<mw::DBIterator> m_pIterator;
+	};
+
 	CoinDB(mw::DBWrapper* pDBWrapper, mw::DBBatch* pBatch = nullptr);
 	~CoinDB();
 
@@ -41,6 +59,19 @@ public:
 	//
 	void RemoveAllUTXOs();
 
+	//
+	// Creates a cursor positioned at the UTXO with the lowest output ID.
+	//
+	Cursor GetCursor() const;
+
+	//
+	// Rewrites up to max_utxos UTXOs stored under the legacy hex-encoded output ID key
+	// to the binary key format, returning the number of UTXOs migrated.
+	// Each legacy key is deleted along with its rewrite, so a migration done
+	// over several batches resumes where it left off if it's interrupted.
+	//
+	size_t MigrateHexKeys(const size_t max_utxos);
+
 private:
 	std::unique_ptr<Database> m_pDatabase;
 };
\ No newline at end of file
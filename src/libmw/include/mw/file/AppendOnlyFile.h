@@ -89,23 +89,66 @@ public:
     }
 
     std::vector<uint8_t> Read(const uint64_t position, const uint64_t numBytes) const
+    {
+        std::vector<uint8_t> bytes;
+        bytes.reserve(numBytes);
+        ForEachSpan(position, numBytes, [&bytes](Span<const uint8_t> span) {
+            bytes.insert(bytes.end(), span.begin(), span.end());
+        });
+        return bytes;
+    }
+
+    //
+    // Returns a view of the bytes without copying them.
+    // The bytes must lie entirely within the mapped file or entirely within the pending appends.
+    // The view is only valid until the next call to Append, Rewind, Commit, or Rollback.
+    //
+    Span<const uint8_t> ReadSpan(const uint64_t position, const uint64_t numBytes) const
+    {
+        Span<const uint8_t> result;
+        size_t num_spans = 0;
+        ForEachSpan(position, numBytes, [&result, &num_spans](Span<const uint8_t> span) {
+            result = span;
+            ++num_spans;
+        });
+
+        if (num_spans > 1) {
+            ThrowFile_F("Tried to read across the end of the mapped region of {}", m_file);
+        }
+
+        return result;
+    }
+
+    //
+    // Calls fn with zero-copy views covering the requested bytes, in order.
+    // At most two views are visited: one over the mapped file, and one over the pending appends.
+    // The views are only valid until the next call to Append, Rewind, Commit, or Rollback.
+    //
+    template <typename F>
+    void ForEachSpan(const uint64_t position, const uint64_t numBytes, F fn) const
     {
         if ((position + numBytes) > (m_bufferIndex + m_buffer.size()))
         {
             ThrowFile_F("Tried to read past end of {}", m_file);
         }
 
-        if (position < m_bufferIndex)
-        {
-            // FUTURE: Read from mapped and then from buffer, if necessary
-            return m_mmap.Read(position, numBytes);
+        if (numBytes == 0) {
+            return;
         }
-        else
+
+        uint64_t buffer_pos = position;
+        if (position < m_bufferIndex)
         {
-            auto begin = m_buffer.cbegin() + position - m_bufferIndex;
-            auto end = begin + numBytes;
-            return std::vector<uint8_t>(begin, end);
+            const uint64_t num_mapped = std::min(numBytes, m_bufferIndex - position);
+            fn(m_mmap.ReadSpan(position, num_mapped));
+            if (num_mapped == numBytes) {
+                return;
+            }
+
+            buffer_pos = m_bufferIndex;
         }
+
+        fn(Span<const uint8_t>(m_buffer.data() + (buffer_pos - m_bufferIndex), position + numBytes - buffer_pos));
     }
 
 private:
@@ -6,6 +6,7 @@
 // file LICENSE or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/common/Macros.h>
+#include <boost/optional.hpp>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -33,6 +34,7 @@ public:
     virtual void Seek(const std::string& key) = 0;
     virtual void Next() = 0;
     virtual bool GetKey(std::string& key) const = 0;
+    virtual bool GetValue(std::vector<uint8_t>& value) const = 0;
     virtual bool Valid() const = 0;
 };
 
@@ -44,6 +46,26 @@ public:
     virtual ~DBWrapper() = default;
 
     virtual bool Read(const std::string& key, std::vector<uint8_t>& value) const = 0;
+
+    /// <summary>
+    /// Reads the values of many keys at once.
+    /// Implementations should read the keys in sorted order, so each block is only visited once.
+    /// </summary>
+    /// <param name="keys">The keys to read, in any order.</param>
+    /// <returns>The value of each key, in the same order as the keys, or boost::none if a key is missing.</returns>
+    virtual std::vector<boost::optional<std::vector<uint8_t>>> MultiRead(const std::vector<std::string>& keys) const
+    {
+        std::vector<boost::optional<std::vector<uint8_t>>> values(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            std::vector<uint8_t> value;
+            if (Read(keys[i], value)) {
+                values[i] = std::move(value);
+            }
+        }
+
+        return values;
+    }
+
     virtual std::unique_ptr<DBIterator> NewIterator() = 0;
     virtual std::unique_ptr<DBBatch> CreateBatch() = 0;
 };
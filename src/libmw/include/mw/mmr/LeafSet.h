@@ -3,9 +3,12 @@
 #include <mw/common/Macros.h>
 #include <mw/common/BitSet.h>
 #include <mw/file/File.h>
-#include <mw/file/MemMap.h>
 #include <mw/models/crypto/Hash.h>
 #include <mw/mmr/LeafIndex.h>
+#include <mw/mmr/LeafSetContainer.h>
+#include <map>
+#include <mutex>
+#include <set>
 #include <unordered_map>
 
 class ILeafSet
@@ -26,6 +29,15 @@ public:
 	const mmr::LeafIndex& GetNextLeafIdx() const noexcept { return m_nextLeafIdx; }
 	BitSet ToBitSet() const;
 
+	/// <summary>
+	/// The leafset root is the BLAKE3 hash of the leafset bytes. Root() assembles it from the chaining value
+	/// of each 1 KiB chunk of those bytes, so implementations can cache the values of unmodified chunks.
+	/// </summary>
+	/// <param name="chunk_idx">The index of the chunk.</param>
+	/// <param name="chunk_len">The number of leafset bytes in the chunk, which is only less than BLAKE3_CHUNK_LEN for the last chunk.</param>
+	/// <returns>The chunk's chaining value.</returns>
+	virtual mw::Hash GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const;
+
 	virtual void ApplyUpdates(
 		const uint32_t file_index,
 		const mmr::LeafIndex& nextLeafIdx,
@@ -34,6 +46,7 @@ public:
 
 protected:
 	uint8_t BitToByte(const uint8_t bit) const;
+	mw::Hash CalcChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const;
 
 	ILeafSet(const mmr::LeafIndex& nextLeafIdx)
 		: m_nextLeafIdx(nextLeafIdx) { }
@@ -41,6 +54,13 @@ protected:
 	mmr::LeafIndex m_nextLeafIdx;
 };
 
+/// <summary>
+/// The persisted leafset, held in memory as roaring-style containers of 2^16 leaves each
+/// (see LeafSetContainer). Each flush writes the compressed containers to a new file.
+/// Files in the original flat bitmap format are migrated when opened. Releases that only know
+/// that format would find no leafset file and start from an empty one, so the node's chainstate
+/// version is bumped along with this format to make them refuse the chainstate instead.
+/// </summary>
 class LeafSet : public ILeafSet
 {
 public:
@@ -51,6 +71,7 @@ public:
 
 	uint8_t GetByte(const uint64_t byteIdx) const final;
 	void SetByte(const uint64_t byteIdx, const uint8_t value) final;
+	mw::Hash GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const final;
 
 	void ApplyUpdates(
 		const uint32_t file_index,
@@ -60,13 +81,46 @@ public:
 	void Flush(const uint32_t file_index);
 	void Cleanup(const uint32_t current_file_index) const;
 
+	/// <summary>
+	/// Serializes the leafset in its compressed form, so it can be shared in a UTXO snapshot.
+	/// </summary>
+	std::vector<uint8_t> ExportSnapshot() const;
+
+	/// <summary>
+	/// Creates a leafset from the output of ExportSnapshot, and writes it to the file with the given index.
+	/// </summary>
+	static LeafSet::Ptr ImportSnapshot(const FilePath& leafset_dir, const uint32_t file_index, const std::vector<uint8_t>& snapshot);
+
+	size_t GetNumContainers() const noexcept { return m_containers.size(); }
+
+	/// <summary>
+	/// Counts the leaves in the set.
+	/// </summary>
+	uint64_t GetNumUnspent() const noexcept;
+
 private:
-	LeafSet(FilePath dir, MemMap&& mmap, const mmr::LeafIndex& nextLeafIdx)
-        : ILeafSet(nextLeafIdx), m_dir(std::move(dir)), m_mmap(std::move(mmap)) {}
+	// Version byte written at the start of each file, ahead of the next leaf index and containers.
+	static constexpr uint8_t COMPRESSED_VERSION = 1;
+
+	LeafSet(FilePath dir, const mmr::LeafIndex& nextLeafIdx)
+		: ILeafSet(nextLeafIdx), m_dir(std::move(dir)) {}
+
+	static FilePath GetLegacyPath(const FilePath& leafset_dir, const uint32_t file_index);
+	static LeafSet::Ptr Deserialize(const FilePath& leafset_dir, const std::vector<uint8_t>& serialized);
+	static LeafSet::Ptr MigrateLegacy(const FilePath& leafset_dir, const uint32_t file_index);
+
+	// Clears all leaves at or beyond the next leaf index.
+	void Truncate();
+	void MarkChunkDirty(const uint64_t byteIdx) const;
 
 	FilePath m_dir;
-	MemMap m_mmap;
-	std::unordered_map<uint64_t, uint8_t> m_modifiedBytes;
+	std::map<uint64_t, mmr::LeafSetContainer> m_containers;
+
+	// Chaining value and length of each chunk whose bytes are unchanged since it was last hashed.
+	// Filled in by the const GetChunkCV, so guarded by m_chunkCVsMutex to allow concurrent readers.
+	// Modifying the leafset still requires exclusive access.
+	mutable std::mutex m_chunkCVsMutex;
+	mutable std::unordered_map<uint64_t, std::pair<size_t, mw::Hash>> m_chunkCVs;
 };
 
 class LeafSetCache : public ILeafSet
@@ -80,6 +134,7 @@ public:
 
 	uint8_t GetByte(const uint64_t byteIdx) const final;
 	void SetByte(const uint64_t byteIdx, const uint8_t value) final;
+	mw::Hash GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const final;
 
 	void ApplyUpdates(
 		const uint32_t file_index,
@@ -91,4 +146,7 @@ public:
 private:
 	ILeafSet::Ptr m_pBacked;
 	std::unordered_map<uint64_t, uint8_t> m_modifiedBytes;
+
+	// Chunks containing any of m_modifiedBytes, which can't use the backing leafset's chaining values.
+	std::set<uint64_t> m_modifiedChunks;
 };
\ No newline at end of file
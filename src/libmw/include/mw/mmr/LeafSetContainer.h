@@ -0,0 +1,161 @@
+#pragma once
+
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/common/Macros.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <serialize.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+MMR_NAMESPACE
+
+/// <summary>
+/// The unspent leaves of a LeafSet within one block of 2^16 consecutive leaf indices.
+/// Like a roaring bitmap container, positions are kept in a sorted array while there are few of them,
+/// and in a bitmap once an array would be larger. On disk, each container is written using whichever
+/// of the array, bitmap, or run-length encodings is the smallest.
+/// </summary>
+class LeafSetContainer
+{
+public:
+    static constexpr uint32_t NUM_LEAVES = 1 << 16;
+    static constexpr uint32_t NUM_BYTES = NUM_LEAVES / 8;
+
+    // An array holding more positions than this would be larger than the bitmap.
+    static constexpr size_t MAX_ARRAY_SIZE = NUM_BYTES / sizeof(uint16_t);
+
+    bool IsEmpty() const noexcept { return GetCardinality() == 0; }
+    uint32_t GetCardinality() const noexcept { return IsBitmap() ? m_cardinality : (uint32_t)m_array.size(); }
+    bool IsBitmap() const noexcept { return !m_bitmap.empty(); }
+
+    bool Contains(const uint16_t pos) const noexcept;
+    void Set(const uint16_t pos, const bool value);
+
+    /// <summary>
+    /// Gets or sets 8 positions at once, using the same bit order as the leafset root
+    /// (the first position is the most significant bit).
+    /// </summary>
+    uint8_t GetByte(const uint16_t byte_idx) const noexcept;
+    void SetByte(const uint16_t byte_idx, const uint8_t value);
+
+    /// <summary>
+    /// Writes the bitmap bytes [first_byte, first_byte + num_bytes) to out.
+    /// </summary>
+    void ReadBytes(const uint32_t first_byte, const uint32_t num_bytes, uint8_t* out) const;
+
+    /// <summary>
+    /// Clears every position at or beyond pos.
+    /// </summary>
+    void Truncate(const uint32_t pos);
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        std::vector<std::pair<uint16_t, uint16_t>> runs = GetRuns();
+        const size_t array_size = GetCardinality() * sizeof(uint16_t);
+        const size_t runs_size = runs.size() * 2 * sizeof(uint16_t);
+
+        if (runs_size <= array_size && runs_size < NUM_BYTES) {
+            s << (uint8_t)EEncoding::RUNS;
+            WriteCompactSize(s, runs.size());
+            for (const auto& run : runs) {
+                s << run.first << run.second;
+            }
+        } else if (array_size < NUM_BYTES) {
+            s << (uint8_t)EEncoding::ARRAY;
+            WriteCompactSize(s, GetCardinality());
+            ForEach([&s](const uint16_t pos) { s << pos; });
+        } else {
+            std::vector<uint8_t> bytes(NUM_BYTES);
+            ReadBytes(0, NUM_BYTES, bytes.data());
+            s << (uint8_t)EEncoding::BITMAP;
+            s.write((const char*)bytes.data(), bytes.size());
+        }
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        m_array.clear();
+        m_bitmap.clear();
+        m_cardinality = 0;
+
+        uint8_t encoding;
+        s >> encoding;
+        if (encoding == (uint8_t)EEncoding::ARRAY) {
+            const uint64_t size = ReadCompactSize(s);
+            if (size > MAX_ARRAY_SIZE) {
+                ThrowDeserialization("LeafSetContainer array too large");
+            }
+
+            for (uint64_t i = 0; i < size; i++) {
+                uint16_t pos;
+                s >> pos;
+                Set(pos, true);
+            }
+        } else if (encoding == (uint8_t)EEncoding::BITMAP) {
+            std::vector<uint8_t> bytes(NUM_BYTES);
+            s.read((char*)bytes.data(), bytes.size());
+            LoadBitmap(std::move(bytes));
+        } else if (encoding == (uint8_t)EEncoding::RUNS) {
+            const uint64_t num_runs = ReadCompactSize(s);
+            for (uint64_t i = 0; i < num_runs; i++) {
+                uint16_t start, length_minus_one;
+                s >> start >> length_minus_one;
+                if ((uint32_t)start + length_minus_one >= NUM_LEAVES) {
+                    ThrowDeserialization("LeafSetContainer run out of range");
+                }
+
+                for (uint32_t pos = start; pos <= (uint32_t)start + length_minus_one; pos++) {
+                    Set((uint16_t)pos, true);
+                }
+            }
+        } else {
+            ThrowDeserialization("Unknown LeafSetContainer encoding");
+        }
+    }
+
+private:
+    enum class EEncoding : uint8_t
+    {
+        ARRAY = 0,
+        BITMAP = 1,
+        RUNS = 2
+    };
+
+    template <typename F>
+    void ForEach(const F& func) const
+    {
+        if (IsBitmap()) {
+            for (uint32_t pos = 0; pos < NUM_LEAVES; pos++) {
+                if (m_bitmap[pos / 8] & (0x80 >> (pos % 8))) {
+                    func((uint16_t)pos);
+                }
+            }
+        } else {
+            for (const uint16_t pos : m_array) {
+                func(pos);
+            }
+        }
+    }
+
+    // Returns the (start, length - 1) of every run of consecutive positions.
+    std::vector<std::pair<uint16_t, uint16_t>> GetRuns() const;
+
+    void ToBitmap();
+    void ToArray();
+    void LoadBitmap(std::vector<uint8_t>&& bytes);
+
+    // Sorted positions. Only used while the container is not a bitmap.
+    std::vector<uint16_t> m_array;
+
+    // NUM_BYTES bytes when in use, empty otherwise.
+    std::vector<uint8_t> m_bitmap;
+    uint32_t m_cardinality{0};
+};
+
+END_NAMESPACE
@@ -10,6 +10,7 @@
 #include <mw/models/crypto/Hash.h>
 #include <mw/mmr/LeafIndex.h>
 #include <mw/mmr/Leaf.h>
+#include <mw/mmr/NodeCache.h>
 #include <mw/mmr/PruneList.h>
 #include <mw/interfaces/db_interface.h>
 
@@ -31,6 +32,39 @@ public:
     mmr::LeafIndex Add(const std::vector<uint8_t>& data) { return AddLeaf(mmr::Leaf::Create(GetNextLeafIdx(), data)); }
     mmr::LeafIndex Add(const Traits::ISerializable& serializable) { return AddLeaf(mmr::Leaf::Create(GetNextLeafIdx(), serializable.Serialized())); }
 
+    /// <summary>
+    /// Adds new leaves to the end of the MMR.
+    /// Rather than walking up the tree after each leaf, the parent hashes are computed one level at a time,
+    /// hashing every new parent of a level together (see MMRUtil::CalcParentHashes).
+    /// </summary>
+    /// <param name="leaves">The leaves to add. These must be consecutive, starting at GetNextLeafIdx().</param>
+    virtual void AddLeaves(const std::vector<mmr::Leaf>& leaves) = 0;
+
+    /// <summary>
+    /// Adds a new leaf for each of the serialized leaf data, in order.
+    /// </summary>
+    /// <param name="data">The serialized data of each leaf.</param>
+    /// <returns>The LeafIndex of each added leaf.</returns>
+    template <typename T>
+    std::vector<mmr::LeafIndex> AddAll(const std::vector<T>& data)
+    {
+        std::vector<mmr::Leaf> leaves;
+        leaves.reserve(data.size());
+
+        std::vector<mmr::LeafIndex> indices;
+        indices.reserve(data.size());
+
+        mmr::LeafIndex next_idx = GetNextLeafIdx();
+        for (const T& item : data) {
+            leaves.push_back(mmr::Leaf::Create(next_idx, item.Serialized()));
+            indices.push_back(next_idx);
+            next_idx = next_idx.Next();
+        }
+
+        AddLeaves(leaves);
+        return indices;
+    }
+
     /// <summary>
     /// Retrieves the leaf at the given leaf index.
     /// </summary>
@@ -94,6 +128,14 @@ public:
         const std::vector<mmr::Leaf>& leaves,
         const std::unique_ptr<mw::DBBatch>& pBatch
     ) = 0;
+
+protected:
+    /// <summary>
+    /// Calculates the hashes of every node (leaves and parents) created by appending the given leaves.
+    /// </summary>
+    /// <param name="leaves">The leaves being appended. These must be consecutive, starting at GetNextLeafIdx().</param>
+    /// <returns>The hashes of the new nodes, in position order, starting with the first leaf.</returns>
+    std::vector<mw::Hash> CalcAppendedHashes(const std::vector<mmr::Leaf>& leaves) const;
 };
 
 /// <summary>
@@ -108,6 +150,7 @@ public:
     virtual ~MemMMR() = default;
 
     mmr::LeafIndex AddLeaf(const mmr::Leaf& leaf) final;
+    void AddLeaves(const std::vector<mmr::Leaf>& leaves) final;
     mmr::Leaf GetLeaf(const mmr::LeafIndex& leafIdx) const final;
     mw::Hash GetHash(const mmr::Index& idx) const final;
 
@@ -136,31 +179,41 @@ public:
         const FilePath& mmr_dir,
         const uint32_t file_index,
         const mw::DBWrapper::Ptr& pDBWrapper,
-        const std::shared_ptr<const PruneList>& pPruneList
+        const std::shared_ptr<const PruneList>& pPruneList,
+        const mmr::NodeCache::Ptr& pNodeCache = nullptr
     );
 
     PMMR(const char dbPrefix,
         const FilePath& mmr_dir,
         const AppendOnlyFile::Ptr& pHashFile,
         const std::shared_ptr<mw::DBWrapper>& pDBWrapper,
-        const PruneList::CPtr& pPruneList
+        const PruneList::CPtr& pPruneList,
+        const mmr::NodeCache::Ptr& pNodeCache = nullptr
     ) :
         m_dbPrefix(dbPrefix),
         m_dir(mmr_dir),
         m_pHashFile(pHashFile),
         m_pDatabase(pDBWrapper),
-        m_pPruneList(pPruneList) { }
+        m_pPruneList(pPruneList),
+        m_pNodeCache(pNodeCache) { }
 
     virtual ~PMMR() = default;
 
     static FilePath GetPath(const FilePath& dir, const char prefix, const uint32_t file_index);
 
     mmr::LeafIndex AddLeaf(const mmr::Leaf& leaf) final;
+    void AddLeaves(const std::vector<mmr::Leaf>& leaves) final;
 
     mmr::Leaf GetLeaf(const mmr::LeafIndex& leafIdx) const final;
     mw::Hash GetHash(const mmr::Index& idx) const final;
     mmr::LeafIndex GetNextLeafIdx() const noexcept final { return mmr::LeafIndex::At(GetNumLeaves()); }
 
+    //
+    // Reads the hashes of count consecutive nodes, starting at first.
+    // Unless pruned nodes lie within the range, the hashes are read straight from the mapped file.
+    //
+    std::vector<mw::Hash> GetHashes(const mmr::Index& first, const uint64_t count) const;
+
     uint64_t GetNumLeaves() const noexcept final;
     uint64_t GetNumNodes() const noexcept;
     void Rewind(const uint64_t numLeaves) final;
@@ -181,6 +234,7 @@ private:
     std::map<mmr::LeafIndex, size_t> m_leafMap;
     std::shared_ptr<mw::DBWrapper> m_pDatabase;
     PruneList::CPtr m_pPruneList;
+    mmr::NodeCache::Ptr m_pNodeCache;
 };
 
 class PMMRCache : public IMMR
@@ -193,6 +247,7 @@ public:
     virtual ~PMMRCache() = default;
 
     mmr::LeafIndex AddLeaf(const mmr::Leaf& leaf) final;
+    void AddLeaves(const std::vector<mmr::Leaf>& leaves) final;
 
     mmr::Leaf GetLeaf(const mmr::LeafIndex& leafIdx) const final;
     mmr::LeafIndex GetNextLeafIdx() const noexcept final;
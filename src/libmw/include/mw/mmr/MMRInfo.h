@@ -9,8 +9,12 @@
 /// </summary>
 struct MMRInfo : public Traits::ISerializable
 {
+    // Since version 1, the UTXO table is keyed by binary output IDs rather than hex strings.
+    static constexpr uint8_t BINARY_UTXO_KEYS_VERSION = 1;
+    static constexpr uint8_t CURRENT_VERSION = BINARY_UTXO_KEYS_VERSION;
+
     MMRInfo()
-        : version(0), index(0), pruned(mw::Hash()), compact_index(0), compacted(boost::none) { }
+        : version(CURRENT_VERSION), index(0), pruned(mw::Hash()), compact_index(0), compacted(boost::none) { }
     MMRInfo(uint8_t version, uint32_t index_in, mw::Hash pruned_in, uint32_t compact_index_in, boost::optional<mw::Hash> compacted_in)
         : version(version), index(index_in), pruned(std::move(pruned_in)), compact_index(compact_index_in), compacted(std::move(compacted_in)) { }
 
@@ -9,6 +9,15 @@ class MMRUtil
 public:
     static mw::Hash CalcParentHash(const mmr::Index& index, const mw::Hash& left_hash, const mw::Hash& right_hash);
 
+    /// <summary>
+    /// Calculates the hashes of many parent nodes at once.
+    /// Equivalent to calling CalcParentHash for each parent, but hashes them in parallel SIMD lanes.
+    /// </summary>
+    /// <param name="indices">The indices of the parent nodes.</param>
+    /// <param name="child_hashes">The left and right child hashes of each parent, in order (2 per parent).</param>
+    /// <returns>The parent hashes, in the same order as indices.</returns>
+    static std::vector<mw::Hash> CalcParentHashes(const std::vector<mmr::Index>& indices, const std::vector<mw::Hash>& child_hashes);
+
     static BitSet BuildCompactBitSet(const uint64_t num_leaves, const BitSet& unspent_leaf_indices);
     static BitSet DiffCompactBitSet(const BitSet& prev_compact, const BitSet& new_compact);
 
@@ -0,0 +1,72 @@
+#pragma once
+
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/models/crypto/Hash.h>
+#include <mw/mmr/Index.h>
+#include <boost/optional.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace mmr
+{
+
+/// <summary>
+/// Size-bounded, least-recently-used cache of MMR node hashes, keyed by the MMR's
+/// db prefix and the node's position. A single cache can be shared by all PMMRs.
+/// Nodes written by AddLeaf are inserted as well, so peaks and the most recent
+/// subtrees stay hot and hashing new leaves rarely touches the hash file.
+/// </summary>
+class NodeCache
+{
+public:
+    using Ptr = std::shared_ptr<NodeCache>;
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t num_entries;
+        size_t max_entries;
+
+        double HitRate() const noexcept { return hits + misses == 0 ? 0.0 : (double)hits / (hits + misses); }
+    };
+
+    explicit NodeCache(const size_t max_bytes)
+        : m_maxEntries(max_bytes / ENTRY_SIZE), m_hits(0), m_misses(0), m_evictions(0) { }
+
+    /// <summary>
+    /// Approximate memory used per cached node, including container overhead.
+    /// </summary>
+    static constexpr size_t ENTRY_SIZE = 160;
+
+    boost::optional<mw::Hash> Get(const char prefix, const Index& idx);
+    void Put(const char prefix, const Index& idx, const mw::Hash& hash);
+
+    /// <summary>
+    /// Removes all nodes of the given MMR at or beyond idx. Used when the MMR is rewound.
+    /// </summary>
+    void EraseFrom(const char prefix, const Index& idx);
+
+    Stats GetStats() const;
+
+private:
+    using Key = std::pair<char, uint64_t>;
+    using LRUList = std::list<std::pair<Key, mw::Hash>>;
+
+    mutable std::mutex m_mutex;
+    size_t m_maxEntries;
+    LRUList m_lru;
+    std::map<Key, LRUList::iterator> m_entries;
+
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+};
+
+}
@@ -18,6 +18,7 @@ public:
     uint64_t GetShift(const mmr::Index& index) const noexcept;
     uint64_t GetShift(const mmr::LeafIndex& index) const noexcept;
     uint64_t GetTotalShift() const noexcept { return m_totalShift; }
+    bool IsCompacted(const mmr::Index& index) const noexcept { return m_compacted.test(index.GetPosition()); }
 
     void Commit(const uint32_t file_index, const BitSet& compacted);
 
@@ -72,8 +72,9 @@ public:
 
     //
     // Context-free validation of the block.
+    // If verify_crypto is false, the signatures and range proofs are not verified.
     //
-    void Validate() const;
+    void Validate(const bool verify_crypto = true) const;
 
 private:
     mw::Header::CPtr m_pHeader;
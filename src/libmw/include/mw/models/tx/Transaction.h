@@ -112,6 +112,16 @@ public:
 
     bool IsStandard() const noexcept;
     void Validate() const;
+
+    /// <summary>
+    /// Batch verifies the signatures and range proofs of all of the transactions at once.
+    /// Verified signatures and proofs are cached, so when the batch is valid,
+    /// Validate() no longer has to verify them for any of the transactions.
+    /// </summary>
+    /// <param name="txs">The transactions to verify.</param>
+    /// <returns>True if every signature and range proof is valid.</returns>
+    /// <throws>std::exception if a kernel excess, key, or commitment isn't a valid curve point.</throws>
+    static bool BatchVerify(const std::vector<mw::Transaction::CPtr>& txs);
     
     std::string Print() const noexcept
     {
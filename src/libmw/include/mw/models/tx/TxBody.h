@@ -94,6 +94,13 @@ public:
     CAmount GetSupplyChange() const noexcept;
     int32_t GetLockHeight() const noexcept;
 
+    // Messages signed by each kernel, input, and output, in that order.
+    // Throws if a kernel excess or input public key isn't a valid curve point.
+    std::vector<SignedMessage> BuildSignedMsgs() const;
+
+    // Range proofs for each output.
+    std::vector<ProofData> BuildProofData() const;
+
     //
     // Serialization/Deserialization
     //
@@ -102,7 +109,12 @@ public:
         READWRITE(obj.m_inputs, obj.m_outputs, obj.m_kernels);
     }
 
-    void Validate() const;
+    //
+    // Context-free validation of the body.
+    // Callers that verify the signatures and range proofs themselves (e.g. in parallel)
+    // may set verify_crypto to false to skip them here.
+    //
+    void Validate(const bool verify_crypto = true) const;
 
 private:
     // List of inputs spent by the transaction.
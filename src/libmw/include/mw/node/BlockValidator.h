@@ -7,10 +7,15 @@ class BlockValidator
 public:
     BlockValidator() = default;
 
+    //
+    // Validates the block and verifies its pegins and pegouts match the expected coins.
+    // If verify_crypto is false, the caller is responsible for verifying the signatures and range proofs.
+    //
     static bool ValidateBlock(
         const mw::Block::CPtr& pBlock,
         const std::vector<PegInCoin>& pegInCoins,
-        const std::vector<PegOutCoin>& pegOutCoins
+        const std::vector<PegOutCoin>& pegOutCoins,
+        const bool verify_crypto = true
     ) noexcept;
 
 private:
@@ -10,6 +10,7 @@
 #include <mw/mmr/LeafSet.h>
 #include <mw/interfaces/db_interface.h>
 #include <memory>
+#include <unordered_map>
 
 // Forward Declarations
 class CoinDB;
@@ -41,6 +42,14 @@ public:
 
     // Virtual functions
     virtual UTXO::CPtr GetUTXO(const mw::Hash& output_id) const = 0;
+
+    /// <summary>
+    /// Looks up many UTXOs at once, which is much faster than calling GetUTXO for each when they're read from disk.
+    /// </summary>
+    /// <param name="output_ids">The output IDs of the UTXOs to look for.</param>
+    /// <returns>The unspent coins that were found, by output ID.</returns>
+    virtual std::unordered_map<mw::Hash, UTXO::CPtr> GetUTXOs(const std::vector<mw::Hash>& output_ids) const = 0;
+
     virtual void WriteBatch(
         const mw::DBBatch::UPtr& pBatch,
         const CoinsViewUpdates& updates,
@@ -86,6 +95,7 @@ public:
     bool IsCache() const noexcept final { return true; }
 
     UTXO::CPtr GetUTXO(const mw::Hash& output_id) const noexcept final;
+    std::unordered_map<mw::Hash, UTXO::CPtr> GetUTXOs(const std::vector<mw::Hash>& output_ids) const final;
 
     /// <summary>
     /// Validates and connects the block to the end of the chain.
@@ -127,8 +137,8 @@ public:
     IMMR::Ptr GetOutputPMMR() const noexcept final { return m_pOutputPMMR; }
 
 private:
-    void AddUTXO(const uint64_t header_height, const Output& output);
-    UTXO SpendUTXO(const mw::Hash& output_id);
+    void AddUTXOs(const uint64_t header_height, const std::vector<Output>& outputs);
+    std::vector<UTXO> SpendUTXOs(const std::vector<Input>& inputs);
 
     ICoinsView::Ptr m_pBase;
 
@@ -146,12 +156,14 @@ public:
     static CoinsViewDB::Ptr Open(
         const FilePath& datadir,
         const mw::Header::CPtr& pBestHeader,
-        const mw::DBWrapper::Ptr& pDBWrapper
+        const mw::DBWrapper::Ptr& pDBWrapper,
+        const mmr::NodeCache::Ptr& pNodeCache = nullptr
     );
 
     bool IsCache() const noexcept final { return false; }
 
     UTXO::CPtr GetUTXO(const mw::Hash& output_id) const final;
+    std::unordered_map<mw::Hash, UTXO::CPtr> GetUTXOs(const std::vector<mw::Hash>& output_ids) const final;
     void WriteBatch(
         const mw::DBBatch::UPtr& pBatch,
         const CoinsViewUpdates& updates,
@@ -176,8 +188,6 @@ private:
 
     void AddUTXO(CoinDB& coinDB, const Output& output);
     void AddUTXO(CoinDB& coinDB, const UTXO::CPtr& pUTXO);
-    void SpendUTXO(CoinDB& coinDB, const mw::Hash& output_id);
-    UTXO::CPtr GetUTXO(const CoinDB& coinDB, const mw::Hash& output_id) const;
 
     LeafSet::Ptr m_pLeafSet;
     PMMR::Ptr m_pOutputPMMR;
@@ -0,0 +1,128 @@
+#pragma once
+
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/common/Macros.h>
+#include <mw/db/CoinDB.h>
+#include <mw/file/AppendOnlyFile.h>
+#include <mw/file/FilePath.h>
+#include <mw/interfaces/db_interface.h>
+#include <mw/models/block/Header.h>
+#include <mw/models/crypto/Hash.h>
+#include <functional>
+
+// Forward Declarations
+class CAutoFile;
+
+MW_NAMESPACE
+
+/// <summary>
+/// The sections of the MWEB state in a UTXO snapshot, in the order they're written.
+/// Every section has at least one chunk. HEADER and END have exactly one.
+/// </summary>
+enum class ESnapshotSection : uint8_t
+{
+    HEADER = 0,        // The MWEB header of the snapshot's base block.
+    PRUNE_LIST = 1,    // The bitset of compacted output PMMR nodes.
+    OUTPUT_HASHES = 2, // The output PMMR hash file, which excludes compacted nodes.
+    LEAFSET = 3,       // The compressed leafset (see LeafSet::ExportSnapshot).
+    UTXOS = 4,         // Serialized UTXOs, ordered by output ID.
+    END = 5            // Empty. Its hash commits to the entire MWEB state.
+};
+
+struct SnapshotInfo
+{
+    mw::Header::CPtr pHeader;
+
+    // The hash of the END chunk.
+    mw::Hash hash;
+
+    uint64_t num_utxos;
+};
+
+/// <summary>
+/// Writes the MWEB state to a UTXO snapshot, so nodes bootstrapped from the snapshot
+/// can validate MWEB blocks without replaying the chain.
+///
+/// The state is written as a stream of chunks, each holding a section type, a payload of at most
+/// MAX_CHUNK_SIZE bytes, and the hash of the chunk chained with the hash of the chunk before it.
+/// A reader can reject a corrupt chunk as soon as it arrives, and the hash of the final chunk
+/// commits to everything before it, so it's what chainparams commits to.
+/// </summary>
+class SnapshotWriter
+{
+public:
+    static constexpr size_t MAX_CHUNK_SIZE = 1 << 20;
+
+    /// <summary>
+    /// Captures the MWEB state last flushed to the database and the MMR files in datadir.
+    /// Nothing may flush the MWEB view during this call. Once it returns, the writer reads from
+    /// a snapshot of the database and files it already opened, so later flushes don't affect it.
+    /// </summary>
+    /// <param name="datadir">The directory holding the MMR files.</param>
+    /// <param name="pDBWrapper">The database the view was flushed to. Must not be null.</param>
+    /// <param name="pHeader">The MWEB header of the flushed view. Must not be null.</param>
+    static SnapshotWriter Capture(const FilePath& datadir, const mw::DBWrapper::Ptr& pDBWrapper, const mw::Header::CPtr& pHeader);
+
+    /// <summary>
+    /// Writes every section to the file.
+    /// </summary>
+    /// <param name="file">The snapshot file, positioned after the canonical coins.</param>
+    /// <param name="interruption_point">Called between chunks. May throw to abort the write.</param>
+    SnapshotInfo Write(CAutoFile& file, const std::function<void()>& interruption_point = []() {});
+
+private:
+    SnapshotWriter(
+        const mw::DBWrapper::Ptr& pDBWrapper,
+        const mw::Header::CPtr& pHeader,
+        std::vector<uint8_t>&& prune_list,
+        const AppendOnlyFile::Ptr& pHashFile,
+        std::vector<uint8_t>&& leafset,
+        CoinDB::Cursor&& cursor
+    ) : m_pDatabase(pDBWrapper),
+        m_pHeader(pHeader),
+        m_pruneList(std::move(prune_list)),
+        m_pHashFile(pHashFile),
+        m_leafset(std::move(leafset)),
+        m_cursor(std::move(cursor)) { }
+
+    void WriteChunk(CAutoFile& file, const ESnapshotSection section, const std::vector<uint8_t>& payload);
+    void WriteChunks(CAutoFile& file, const ESnapshotSection section, const std::vector<uint8_t>& bytes);
+
+    mw::DBWrapper::Ptr m_pDatabase;
+    mw::Header::CPtr m_pHeader;
+    std::vector<uint8_t> m_pruneList;
+    AppendOnlyFile::Ptr m_pHashFile;
+    std::vector<uint8_t> m_leafset;
+    CoinDB::Cursor m_cursor;
+
+    mw::Hash m_hash;
+};
+
+class SnapshotReader
+{
+public:
+    /// <summary>
+    /// Loads the MWEB state of a UTXO snapshot into datadir and a database without any MWEB state.
+    /// Each chunk's hash is verified as it's read. The output PMMR root and size and the leafset root
+    /// must match the snapshot's header, and every UTXO must be an unspent leaf of the output PMMR.
+    /// The caller is responsible for checking the returned hash against the expected commitment,
+    /// and for discarding the database and files if loading fails.
+    /// </summary>
+    /// <param name="file">The snapshot file, positioned after the canonical coins.</param>
+    /// <param name="datadir">The directory to write the MMR files to.</param>
+    /// <param name="pDBWrapper">The database to write the UTXOs to. Must not be null.</param>
+    /// <param name="interruption_point">Called between chunks. May throw to abort the load.</param>
+    /// <throws>DeserializationException if the chunks are malformed, or their hashes don't match.</throws>
+    /// <throws>ValidationException if the MMRs or UTXOs don't match the header.</throws>
+    static SnapshotInfo Load(
+        CAutoFile& file,
+        const FilePath& datadir,
+        const mw::DBWrapper::Ptr& pDBWrapper,
+        const std::function<void()>& interruption_point = []() {}
+    );
+};
+
+END_NAMESPACE
@@ -5,6 +5,7 @@
 #include <mw/models/wallet/Coin.h>
 #include <mw/models/wallet/StealthAddress.h>
 #include <memory>
+#include <vector>
 
 // Forward Declarations
 class LegacyScriptPubKeyMan;
@@ -28,6 +29,11 @@ public:
     // used to calculate the spend key when the wallet becomes unlocked.
     bool RewindOutput(const Output& output, mw::Coin& coin) const;
 
+    // Rewinds many outputs at once, returning a coin for each output that belongs to the wallet.
+    // The outputs are scanned in chunks on up to num_threads threads. Each chunk is first
+    // filtered by view tag, so only the rare matches pay for a full rewind.
+    std::vector<mw::Coin> RewindOutputs(const std::vector<Output>& outputs, const size_t num_threads = 1) const;
+
     // Calculates the output secret key for the given coin.
     // If the address index is known, it calculates from the keychain's master spend key.
     // If not, it attempts to lookup the spend key in the database.
@@ -53,6 +59,12 @@ public:
     void Unlock(const SecretKey& spend_secret) { m_spendSecret = spend_secret; }
     
 private:
+    // Returns the shared secret if the output's view tag matches, or boost::none.
+    boost::optional<PublicKey> CheckViewTag(const Output& output) const;
+
+    // Completes the rewind of an output whose view tag matched.
+    bool RewindOutput(const Output& output, const PublicKey& shared_secret, mw::Coin& coin) const;
+
     const LegacyScriptPubKeyMan& m_spk_man;
     SecretKey m_scanSecret;
     SecretKey m_spendSecret;
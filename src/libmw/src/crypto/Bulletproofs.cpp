@@ -1,19 +1,153 @@
 #include <mw/crypto/Bulletproofs.h>
+#include <mw/crypto/Hasher.h>
 #include "Context.h"
 #include "ConversionUtil.h"
 
-#include <caches/Cache.h>
 #include <mw/exceptions/CryptoException.h>
 #include <mw/util/VectorUtil.h>
 
+#include <cuckoocache.h>
+#include <random.h>
+#include <uint256.h>
+
+#include <array>
+#include <cstring>
+#include <shared_mutex>
+
 static constexpr uint64_t MAX_WIDTH = 1 << 20;
 static constexpr size_t SCRATCH_SPACE_SIZE = 256 * MAX_WIDTH;
 static constexpr size_t PROOF_LEN = 675;
 static constexpr size_t NUM_BITS_PROVEN = 64;
 
-static Locked<LRUCache<Commitment, ProofData>> CACHE(std::make_shared<LRUCache<Commitment, ProofData>>(3000));
 static Locked<Context> BP_CONTEXT(std::make_shared<Context>());
 
+namespace {
+
+/// <summary>
+/// Entries are salted hashes of the full ProofData, so the bytes of an entry are uniformly random.
+/// </summary>
+class RangeProofCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select < 8, "RangeProofCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+/// <summary>
+/// Set of range proofs that have already been verified, so proofs checked on mempool acceptance
+/// don't need to be verified again when the block is connected.
+/// The set is split into shards, each with its own lock, so threads verifying different proofs rarely contend.
+/// </summary>
+class RangeProofCache
+{
+    static constexpr size_t NUM_SHARDS = 16;
+    static constexpr size_t DEFAULT_MAX_BYTES = DEFAULT_MAX_RANGEPROOF_CACHE_SIZE << 20;
+
+    struct Shard {
+        CuckooCache::cache<uint256, RangeProofCacheHasher> set;
+        mutable std::shared_timed_mutex mutex;
+    };
+
+public:
+    RangeProofCache()
+    {
+        uint256 nonce = GetRandHash();
+        m_salted_hasher.write((const char*)nonce.begin(), nonce.size());
+        SetupBytes(DEFAULT_MAX_BYTES);
+    }
+
+    uint256 ComputeEntry(const ProofData& proof) const
+    {
+        Hasher hasher = m_salted_hasher;
+        hasher << proof.commitment << *proof.pRangeProof << proof.extraData;
+
+        uint256 entry;
+        std::memcpy(entry.begin(), hasher.hash().data(), entry.size());
+        return entry;
+    }
+
+    bool Contains(const uint256& entry) const
+    {
+        const Shard& shard = GetShard(entry);
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+        return shard.set.contains(entry, false);
+    }
+
+    void Insert(const std::vector<uint256>& entries)
+    {
+        for (const uint256& entry : entries) {
+            Shard& shard = GetShard(entry);
+            std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+            shard.set.insert(entry);
+        }
+    }
+
+    size_t SetupBytes(const size_t max_bytes)
+    {
+        size_t num_elems = 0;
+        for (Shard& shard : m_shards) {
+            std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+            num_elems += shard.set.setup_bytes(max_bytes / NUM_SHARDS);
+        }
+
+        return num_elems;
+    }
+
+private:
+    // The cuckoo hashes already use every byte of the entry, so the shard is picked by folding them together.
+    // Since entries are salted, this is still unpredictable to peers.
+    const Shard& GetShard(const uint256& entry) const noexcept
+    {
+        uint8_t folded = 0;
+        for (const uint8_t byte : entry) {
+            folded ^= byte;
+        }
+
+        return m_shards[folded % NUM_SHARDS];
+    }
+
+    Shard& GetShard(const uint256& entry) noexcept
+    {
+        return const_cast<Shard&>(static_cast<const RangeProofCache*>(this)->GetShard(entry));
+    }
+
+    Hasher m_salted_hasher;
+    std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+/// <summary>
+/// Each thread keeps its own scratch space, so verification doesn't need to hold an exclusive lock.
+/// Memory for the scratch space is only allocated while a proof is being verified or generated.
+/// </summary>
+class ScratchSpace
+{
+public:
+    ScratchSpace()
+        : m_pScratch(secp256k1_scratch_space_create(BP_CONTEXT.Read()->Get(), SCRATCH_SPACE_SIZE)) { }
+    ~ScratchSpace() { secp256k1_scratch_space_destroy(m_pScratch); }
+
+    secp256k1_scratch_space* Get() noexcept { return m_pScratch; }
+
+private:
+    secp256k1_scratch_space* m_pScratch;
+};
+
+} // namespace
+
+static RangeProofCache CACHE;
+static thread_local ScratchSpace SCRATCH_SPACE;
+
+size_t Bulletproofs::InitCache(const size_t max_bytes)
+{
+    return CACHE.SetupBytes(max_bytes);
+}
+
 bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
 {
     std::vector<secp256k1_pedersen_commitment> secpCommitments;
@@ -28,10 +162,13 @@ bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
     std::vector<size_t> extraDataLen;
     extraDataLen.reserve(proofs.size());
 
+    std::vector<uint256> entries;
+    entries.reserve(proofs.size());
+
     for (const auto& proof : proofs)
     {
-        auto cache_writer = CACHE.Write();
-        if (!cache_writer->Cached(proof.commitment) || proof != cache_writer->Get(proof.commitment)) {
+        entries.push_back(CACHE.ComputeEntry(proof));
+        if (!CACHE.Contains(entries.back())) {
             secpCommitments.push_back(ConversionUtil::ToSecp256k1(proof.commitment));
             bulletproofPointers.emplace_back(proof.pRangeProof->data());
 
@@ -58,14 +195,11 @@ bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
 
     std::vector<secp256k1_pedersen_commitment*> commitmentPointers = VectorUtil::ToPointerVec(secpCommitments);
 
-    secp256k1_scratch_space* pScratchSpace = secp256k1_scratch_space_create(
-        BP_CONTEXT.Read()->Get(),
-        SCRATCH_SPACE_SIZE
-    );
+    auto context_reader = BP_CONTEXT.Read();
     const int result = secp256k1_bulletproof_rangeproof_verify_multi(
-        BP_CONTEXT.Read()->Get(),
-        pScratchSpace,
-        BP_CONTEXT.Read()->GetGenerators(),
+        context_reader->Get(),
+        SCRATCH_SPACE.Get(),
+        context_reader->GetGenerators(),
         bulletproofPointers.data(),
         secpCommitments.size(),
         PROOF_LEN,
@@ -77,14 +211,9 @@ bool Bulletproofs::BatchVerify(const std::vector<ProofData>& proofs)
         extraData.data(),
         extraDataLen.data()
     );
-    secp256k1_scratch_space_destroy(pScratchSpace);
 
     if (result == 1) {
-        auto cache_writer = CACHE.Write();
-        for (const auto& proof : proofs)
-        {
-            cache_writer->Put(proof.commitment, proof);
-        }
+        CACHE.Insert(entries);
     }
 
     return result == 1;
@@ -98,14 +227,15 @@ RangeProof::CPtr Bulletproofs::Generate(
     const ProofMessage& proofMessage,
     const std::vector<uint8_t>& extraData)
 {
+    // The thread's scratch space must be created before taking the write lock, since creating it reads the context.
+    secp256k1_scratch_space* pScratchSpace = SCRATCH_SPACE.Get();
+
     auto contextWriter = BP_CONTEXT.Write();
     secp256k1_context* pContext = contextWriter->Randomized();
 
     std::vector<uint8_t> proofBytes(RangeProof::SIZE, 0);
     size_t proofLen = RangeProof::SIZE;
 
-    secp256k1_scratch_space* pScratchSpace = secp256k1_scratch_space_create(pContext, SCRATCH_SPACE_SIZE);
-
     std::vector<const uint8_t*> blindingFactors({ key.data() });
     int result = secp256k1_bulletproof_rangeproof_prove(
         pContext,
@@ -129,7 +259,6 @@ RangeProof::CPtr Bulletproofs::Generate(
         extraData.size(),
         proofMessage.data()
     );
-    secp256k1_scratch_space_destroy(pScratchSpace);
 
     if (result != 1) {
         ThrowCrypto_F("secp256k1_bulletproof_rangeproof_prove failed with error: {}", result);
@@ -1,9 +1,22 @@
+#if defined(HAVE_CONFIG_H)
+#include <config/bitcoin-config.h>
+#endif
+
 #include <mw/crypto/Hasher.h>
 
-#define BLAKE3_NO_AVX512 1
-#define BLAKE3_NO_AVX2 1
-#define BLAKE3_NO_SSE41 1
+// The SIMD backends are compiled into the optional crypto libraries, so they
+// are only dispatched to when configure found support for them. SSE2 is never
+// used, since every CPU that lacks SSE4.1 would need it built without -msse4.1.
 #define BLAKE3_NO_SSE2 1
+#if !defined(ENABLE_SSE41) || defined(BUILD_BITCOIN_INTERNAL)
+#define BLAKE3_NO_SSE41 1
+#endif
+#if !defined(ENABLE_AVX2) || defined(BUILD_BITCOIN_INTERNAL)
+#define BLAKE3_NO_AVX2 1
+#endif
+#if !defined(ENABLE_AVX512) || defined(BUILD_BITCOIN_INTERNAL)
+#define BLAKE3_NO_AVX512 1
+#endif
 extern "C" {
 #include <crypto/blake3/blake3.c>
 #include <crypto/blake3/blake3_dispatch.c>
@@ -20,4 +33,105 @@ mw::Hash Hashed(const std::vector<uint8_t>& serialized)
 mw::Hash Hashed(const Traits::ISerializable& serializable)
 {
     return Hashed(serializable.Serialized());
-}
\ No newline at end of file
+}
+
+std::vector<mw::Hash> HashedMany(const std::vector<uint8_t>& serialized, const size_t input_len)
+{
+    assert(input_len > 0 && input_len <= BLAKE3_CHUNK_LEN);
+    assert(serialized.size() % input_len == 0);
+
+    const size_t num_inputs = serialized.size() / input_len;
+    std::vector<const uint8_t*> inputs(num_inputs);
+    for (size_t i = 0; i < num_inputs; i++) {
+        inputs[i] = serialized.data() + (i * input_len);
+    }
+
+    // Each input fits in a single chunk. All blocks but the last one are
+    // compressed for all inputs at once, and the last block of each input is
+    // then compressed as the root to produce its hash.
+    const size_t full_blocks = (input_len - 1) / BLAKE3_BLOCK_LEN;
+    const size_t last_block_len = input_len - (full_blocks * BLAKE3_BLOCK_LEN);
+
+    std::vector<uint8_t> cvs(num_inputs * BLAKE3_OUT_LEN);
+    if (full_blocks > 0) {
+        blake3_hash_many(inputs.data(), num_inputs, full_blocks, IV, 0, false, 0, CHUNK_START, 0, cvs.data());
+    }
+
+    std::vector<mw::Hash> hashes(num_inputs);
+    for (size_t i = 0; i < num_inputs; i++) {
+        uint32_t cv[8];
+        if (full_blocks > 0) {
+            load_key_words(cvs.data() + (i * BLAKE3_OUT_LEN), cv);
+        } else {
+            memcpy(cv, IV, BLAKE3_KEY_LEN);
+        }
+
+        uint8_t block[BLAKE3_BLOCK_LEN] = {0};
+        memcpy(block, inputs[i] + (full_blocks * BLAKE3_BLOCK_LEN), last_block_len);
+
+        uint8_t flags = CHUNK_END | ROOT;
+        if (full_blocks == 0) {
+            flags |= CHUNK_START;
+        }
+
+        blake3_compress_in_place(cv, block, (uint8_t)last_block_len, 0, flags);
+        store_cv_words(hashes[i].data(), cv);
+    }
+
+    return hashes;
+}
+
+mw::Hash ChunkChainingValue(const uint8_t* chunk, const size_t len, const uint64_t chunk_idx)
+{
+    assert(len > 0 && len <= BLAKE3_CHUNK_LEN);
+
+    blake3_chunk_state state;
+    chunk_state_init(&state, IV, 0);
+    state.chunk_counter = chunk_idx;
+    chunk_state_update(&state, chunk, len);
+
+    output_t output = chunk_state_output(&state);
+    mw::Hash cv;
+    output_chaining_value(&output, cv.data());
+    return cv;
+}
+
+// Merges the chaining values of consecutive chunks into their parent node, using the same
+// tree shape as blake3_hasher: the left subtree holds the largest power of 2 number of
+// chunks that leaves at least one chunk for the right subtree.
+static void MergeChunks(const mw::Hash* chunk_cvs, const size_t num_chunks, const bool is_root, uint8_t out[BLAKE3_OUT_LEN])
+{
+    assert(num_chunks >= 2);
+
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    const size_t num_left = (size_t)round_down_to_power_of_2(num_chunks - 1);
+    const size_t num_right = num_chunks - num_left;
+
+    if (num_left == 1) {
+        memcpy(block, chunk_cvs[0].data(), BLAKE3_OUT_LEN);
+    } else {
+        MergeChunks(chunk_cvs, num_left, false, block);
+    }
+
+    if (num_right == 1) {
+        memcpy(block + BLAKE3_OUT_LEN, chunk_cvs[num_left].data(), BLAKE3_OUT_LEN);
+    } else {
+        MergeChunks(chunk_cvs + num_left, num_right, false, block + BLAKE3_OUT_LEN);
+    }
+
+    output_t output = parent_output(block, IV, 0);
+    if (is_root) {
+        output_root_bytes(&output, 0, out, BLAKE3_OUT_LEN);
+    } else {
+        output_chaining_value(&output, out);
+    }
+}
+
+mw::Hash HashedFromChunks(const std::vector<mw::Hash>& chunk_cvs)
+{
+    assert(chunk_cvs.size() >= 2);
+
+    mw::Hash hashed;
+    MergeChunks(chunk_cvs.data(), chunk_cvs.size(), true, hashed.data());
+    return hashed;
+}
@@ -1,8 +1,40 @@
 #include <mw/db/CoinDB.h>
 #include "common/Database.h"
+#include <mw/exceptions/DatabaseException.h>
 
 static const DBTable UTXO_TABLE = { 'U' };
 
+// UTXOs are keyed by the raw bytes of their output ID.
+// Before MMRInfo::BINARY_UTXO_KEYS_VERSION, the hex-encoded output ID was used.
+static std::string UTXOKey(const mw::Hash& output_id)
+{
+    return std::string(output_id.data(), output_id.data() + mw::Hash::size());
+}
+
+CoinDB::Cursor::Cursor(std::unique_ptr<mw::DBIterator>&& pIterator)
+    : m_pIterator(std::move(pIterator)) { }
+
+bool CoinDB::Cursor::Valid() const
+{
+    std::string key;
+    return m_pIterator->Valid()
+        && m_pIterator->GetKey(key)
+        && key.size() == mw::Hash::size() + 1
+        && key.front() == UTXO_TABLE.GetPrefix();
+}
+
+UTXO::CPtr CoinDB::Cursor::GetUTXO() const
+{
+    std::vector<uint8_t> value;
+    if (!m_pIterator->GetValue(value)) {
+        ThrowDatabase("Failed to read UTXO");
+    }
+
+    auto pUTXO = std::make_shared<UTXO>();
+    CDataStream(value, SER_DISK, PROTOCOL_VERSION) >> *pUTXO;
+    return pUTXO;
+}
+
 CoinDB::CoinDB(mw::DBWrapper* pDBWrapper, mw::DBBatch* pBatch)
     : m_pDatabase(std::make_unique<Database>(pDBWrapper, pBatch)) { }
 
@@ -10,12 +42,21 @@ CoinDB::~CoinDB() { }
 
 std::unordered_map<mw::Hash, UTXO::CPtr> CoinDB::GetUTXOs(const std::vector<mw::Hash>& output_ids) const
 {
+    std::vector<std::string> keys;
+    keys.reserve(output_ids.size());
+    std::transform(
+        output_ids.cbegin(), output_ids.cend(),
+        std::back_inserter(keys),
+        [](const mw::Hash& output_id) { return UTXOKey(output_id); }
+    );
+
     std::unordered_map<mw::Hash, UTXO::CPtr> utxos;
+    utxos.reserve(output_ids.size());
 
-    for (const mw::Hash& output_id : output_ids) {
-        auto pUTXO = m_pDatabase->Get<UTXO>(UTXO_TABLE, output_id.ToHex());
-        if (pUTXO != nullptr) {
-            utxos.insert({output_id, pUTXO->item});
+    auto entries = m_pDatabase->MultiGet<UTXO>(UTXO_TABLE, keys);
+    for (size_t i = 0; i < output_ids.size(); i++) {
+        if (entries[i] != nullptr) {
+            utxos.insert({output_ids[i], entries[i]->item});
         }
     }
 
@@ -28,7 +69,7 @@ void CoinDB::AddUTXOs(const std::vector<UTXO::CPtr>& utxos)
     std::transform(
         utxos.cbegin(), utxos.cend(),
         std::back_inserter(entries),
-        [](const UTXO::CPtr& pUTXO) { return DBEntry<UTXO>(pUTXO->GetOutputID().ToHex(), pUTXO); }
+        [](const UTXO::CPtr& pUTXO) { return DBEntry<UTXO>(UTXOKey(pUTXO->GetOutputID()), pUTXO); }
     );
 
     m_pDatabase->Put(UTXO_TABLE, entries);
@@ -37,11 +78,33 @@ void CoinDB::AddUTXOs(const std::vector<UTXO::CPtr>& utxos)
 void CoinDB::RemoveUTXOs(const std::vector<mw::Hash>& output_ids)
 {
     for (const mw::Hash& output_id : output_ids) {
-        m_pDatabase->Delete(UTXO_TABLE, output_id.ToHex());
+        m_pDatabase->Delete(UTXO_TABLE, UTXOKey(output_id));
     }
 }
 
 void CoinDB::RemoveAllUTXOs()
 {
     m_pDatabase->DeleteAll(UTXO_TABLE);
-}
\ No newline at end of file
+}
+
+CoinDB::Cursor CoinDB::GetCursor() const
+{
+    return Cursor(m_pDatabase->Seek(UTXO_TABLE, mw::Hash::size()));
+}
+
+size_t CoinDB::MigrateHexKeys(const size_t max_utxos)
+{
+    const std::vector<std::string> hex_keys = m_pDatabase->GetKeys(UTXO_TABLE, mw::Hash::size() * 2, max_utxos);
+    for (const std::string& hex_key : hex_keys) {
+        auto pEntry = m_pDatabase->Get<UTXO>(UTXO_TABLE, hex_key);
+        if (pEntry != nullptr) {
+            m_pDatabase->Put(UTXO_TABLE, std::vector<DBEntry<UTXO>>{
+                DBEntry<UTXO>(UTXOKey(pEntry->item->GetOutputID()), pEntry->item)
+            });
+        }
+
+        m_pDatabase->Delete(UTXO_TABLE, hex_key);
+    }
+
+    return hex_keys.size();
+}
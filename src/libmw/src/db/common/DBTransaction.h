@@ -38,15 +38,12 @@ public:
         typename SFINAE = typename std::enable_if_t<std::is_base_of<Traits::ISerializable, T>::value>>
     std::unique_ptr<DBEntry<T>> Get(const DBTable& table, const std::string& key) const noexcept
     {
-        auto table_key = table.BuildKey(key);
-        auto iter = m_added.find_last(table_key);
-        if (iter != nullptr) {
-            auto pObject = std::dynamic_pointer_cast<const T>(iter);
-            if (pObject != nullptr) {
-                return std::make_unique<DBEntry<T>>(key, pObject);
-            }
+        auto pPending = GetPending<T>(table, key);
+        if (pPending != nullptr) {
+            return pPending;
         }
 
+        auto table_key = table.BuildKey(key);
         std::vector<uint8_t> entry;
         const bool status = m_pDB->Read(table_key, entry);
         if (status) {
@@ -58,6 +55,21 @@ public:
         return nullptr;
     }
 
+    //
+    // Returns the item most recently written to the batch for the key, if any.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of<Traits::ISerializable, T>::value>>
+    std::unique_ptr<DBEntry<T>> GetPending(const DBTable& table, const std::string& key) const noexcept
+    {
+        auto pObject = std::dynamic_pointer_cast<const T>(m_added.find_last(table.BuildKey(key)));
+        if (pObject != nullptr) {
+            return std::make_unique<DBEntry<T>>(key, pObject);
+        }
+
+        return nullptr;
+    }
+
     void Delete(const DBTable& table, const std::string& key)
     {
         auto table_key = table.BuildKey(key);
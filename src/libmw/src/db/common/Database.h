@@ -46,6 +46,83 @@ public:
         return nullptr;
     }
 
+    //
+    // Retrieves the items for all of the given keys with a single read from the database.
+    // Items written to the current batch take precedence over those in the database.
+    // The returned vector is in the same order as the keys, with nullptr for missing items.
+    //
+    template<typename T,
+        typename SFINAE = typename std::enable_if_t<std::is_base_of<Traits::ISerializable, T>::value>>
+    std::vector<std::unique_ptr<DBEntry<T>>> MultiGet(const DBTable& table, const std::vector<std::string>& keys) const
+    {
+        std::vector<std::unique_ptr<DBEntry<T>>> entries(keys.size());
+        if (!m_pDB) return entries;
+
+        std::vector<size_t> unresolved;
+        std::vector<std::string> table_keys;
+        unresolved.reserve(keys.size());
+        table_keys.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (m_pTx != nullptr) {
+                entries[i] = m_pTx->GetPending<T>(table, keys[i]);
+                if (entries[i] != nullptr) {
+                    continue;
+                }
+            }
+
+            unresolved.push_back(i);
+            table_keys.push_back(table.BuildKey(keys[i]));
+        }
+
+        std::vector<boost::optional<std::vector<uint8_t>>> values = m_pDB->MultiRead(table_keys);
+        for (size_t i = 0; i < unresolved.size(); i++) {
+            if (values[i]) {
+                T item;
+                CDataStream(*values[i], SER_DISK, PROTOCOL_VERSION) >> item;
+                entries[unresolved[i]] = std::make_unique<DBEntry<T>>(keys[unresolved[i]], std::move(item));
+            }
+        }
+
+        return entries;
+    }
+
+    //
+    // Returns the keys (excluding the table prefix) of the first max_keys items in the table whose keys are key_len bytes long.
+    //
+    std::vector<std::string> GetKeys(const DBTable& table, const size_t key_len, const size_t max_keys) const
+    {
+        std::vector<std::string> keys;
+
+        auto iter = m_pDB->NewIterator();
+        iter->Seek(table.BuildKey(std::string(key_len, '\0')));
+        while (iter->Valid() && keys.size() < max_keys) {
+            std::string key;
+            if (!iter->GetKey(key) || key.empty() || key.front() != table.GetPrefix()) {
+                break;
+            }
+
+            if (key.size() == key_len + 1) {
+                keys.push_back(key.substr(1));
+            }
+
+            iter->Next();
+        }
+
+        return keys;
+    }
+
+    //
+    // Returns an iterator positioned at the first item in the table whose key (excluding the table prefix) is key_len bytes long.
+    // Keys are stored with a length prefix, so they're ordered by length first, and items of other tables
+    // or key lengths follow. Callers should stop once a key no longer matches the table's prefix and key_len.
+    //
+    std::unique_ptr<mw::DBIterator> Seek(const DBTable& table, const size_t key_len) const
+    {
+        auto iter = m_pDB->NewIterator();
+        iter->Seek(table.BuildKey(std::string(key_len, '\0')));
+        return iter;
+    }
+
     template<typename T,
         typename SFINAE = typename std::enable_if_t<std::is_base_of<Traits::ISerializable, T>::value>>
     void Put(const DBTable& table, const std::vector<DBEntry<T>>& entries)
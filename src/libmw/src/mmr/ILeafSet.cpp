@@ -29,14 +29,40 @@ bool ILeafSet::Contains(const LeafIndex& idx) const noexcept
 mw::Hash ILeafSet::Root() const
 {
     uint64_t numBytes = (m_nextLeafIdx.Get() + 7) / 8;
+    if (numBytes <= BLAKE3_CHUNK_LEN) {
+        std::vector<uint8_t> bytes(numBytes);
+        for (uint64_t byte_idx = 0; byte_idx < numBytes; byte_idx++) {
+            bytes[byte_idx] = GetByte(byte_idx);
+        }
+
+        return Hashed(bytes);
+    }
 
-    std::vector<uint8_t> bytes(numBytes);
-    for (uint64_t byte_idx = 0; byte_idx < numBytes; byte_idx++) {
-        uint8_t byte = GetByte(byte_idx);
-        bytes[byte_idx] = byte;
+    // Large enough to span multiple chunks, so the root can be built from per-chunk chaining values.
+    const uint64_t numChunks = (numBytes + BLAKE3_CHUNK_LEN - 1) / BLAKE3_CHUNK_LEN;
+    std::vector<mw::Hash> chunk_cvs;
+    chunk_cvs.reserve(numChunks);
+    for (uint64_t chunk_idx = 0; chunk_idx < numChunks; chunk_idx++) {
+        const size_t chunk_len = (size_t)std::min<uint64_t>(BLAKE3_CHUNK_LEN, numBytes - (chunk_idx * BLAKE3_CHUNK_LEN));
+        chunk_cvs.push_back(GetChunkCV(chunk_idx, chunk_len));
     }
 
-    return Hashed(bytes);
+    return HashedFromChunks(chunk_cvs);
+}
+
+mw::Hash ILeafSet::GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const
+{
+    return CalcChunkCV(chunk_idx, chunk_len);
+}
+
+mw::Hash ILeafSet::CalcChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const
+{
+    std::vector<uint8_t> bytes(chunk_len);
+    for (size_t i = 0; i < chunk_len; i++) {
+        bytes[i] = GetByte((chunk_idx * BLAKE3_CHUNK_LEN) + i);
+    }
+
+    return ChunkChainingValue(bytes.data(), chunk_len, chunk_idx);
 }
 
 void ILeafSet::Rewind(const uint64_t numLeaves, const std::vector<LeafIndex>& leavesToAdd)
@@ -61,15 +87,22 @@ uint8_t ILeafSet::BitToByte(const uint8_t bit) const
 
 BitSet ILeafSet::ToBitSet() const
 {
-    BitSet bitset(GetNextLeafIdx().Get());
-
-    mmr::LeafIndex idx = mmr::LeafIndex::At(0);
-    while (idx < GetNextLeafIdx()) {
-        if (Contains(idx)) {
-            bitset.set(idx.Get());
+    const uint64_t numLeaves = GetNextLeafIdx().Get();
+    BitSet bitset(numLeaves);
+
+    // Read a byte at a time, so runs of spent leaves can be skipped.
+    for (uint64_t byte_idx = 0; byte_idx < (numLeaves + 7) / 8; byte_idx++) {
+        const uint8_t byte = GetByte(byte_idx);
+        if (byte == 0) {
+            continue;
         }
 
-        ++idx;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            const uint64_t leaf_idx = (byte_idx * 8) + bit;
+            if (leaf_idx < numLeaves && (byte & BitToByte(bit))) {
+                bitset.set(leaf_idx);
+            }
+        }
     }
 
     return bitset;
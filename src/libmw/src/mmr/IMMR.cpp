@@ -40,4 +40,53 @@ mw::Hash IMMR::Root() const
     }
 
     return hash;
-}
\ No newline at end of file
+}
+
+std::vector<mw::Hash> IMMR::CalcAppendedHashes(const std::vector<Leaf>& leaves) const
+{
+    if (leaves.empty()) {
+        return {};
+    }
+
+    assert(leaves.front().GetLeafIndex() == GetNextLeafIdx());
+    const uint64_t first_pos = leaves.front().GetNodeIndex().GetPosition();
+    const uint64_t num_nodes = leaves.back().GetLeafIndex().Next().GetPosition() - first_pos;
+
+    std::vector<mw::Hash> hashes(num_nodes);
+    std::vector<Index> level;
+    level.reserve(leaves.size());
+    for (size_t i = 0; i < leaves.size(); i++) {
+        assert(leaves[i].GetLeafIndex().Get() == leaves.front().GetLeafIndex().Get() + i);
+        hashes[leaves[i].GetNodeIndex().GetPosition() - first_pos] = leaves[i].GetHash();
+        level.push_back(leaves[i].GetNodeIndex());
+    }
+
+    // Each level's new parents only depend on the level below, so all of a level can be hashed at once.
+    // A new node is a right child exactly when the node that follows it is taller, and that node is its parent.
+    while (!level.empty()) {
+        std::vector<Index> parents;
+        std::vector<mw::Hash> child_hashes;
+        for (const Index& idx : level) {
+            const Index next = idx.GetNext();
+            if (next.GetHeight() <= idx.GetHeight()) {
+                continue;
+            }
+
+            const Index left_child = next.GetLeftChild();
+            parents.push_back(next);
+            child_hashes.push_back(
+                left_child.GetPosition() >= first_pos ? hashes[left_child.GetPosition() - first_pos] : GetHash(left_child)
+            );
+            child_hashes.push_back(hashes[idx.GetPosition() - first_pos]);
+        }
+
+        std::vector<mw::Hash> parent_hashes = MMRUtil::CalcParentHashes(parents, child_hashes);
+        for (size_t i = 0; i < parents.size(); i++) {
+            hashes[parents[i].GetPosition() - first_pos] = std::move(parent_hashes[i]);
+        }
+
+        level = std::move(parents);
+    }
+
+    return hashes;
+}
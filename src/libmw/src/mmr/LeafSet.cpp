@@ -1,72 +1,156 @@
 #include <mw/mmr/LeafSet.h>
+#include <mw/common/Logger.h>
 #include <mw/crypto/Hasher.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <streams.h>
+#include <version.h>
 
 using namespace mmr;
 
+constexpr uint8_t LeafSet::COMPRESSED_VERSION;
+
+static uint64_t ContainerKey(const uint64_t byteIdx) { return byteIdx / LeafSetContainer::NUM_BYTES; }
+static uint16_t ContainerByte(const uint64_t byteIdx) { return (uint16_t)(byteIdx % LeafSetContainer::NUM_BYTES); }
+
 LeafSet::Ptr LeafSet::Open(const FilePath& leafset_dir, const uint32_t file_index)
 {
     File file = GetPath(leafset_dir, file_index);
-    if (!file.Exists()) {
-        file.Create();
+    File legacy_file = GetLegacyPath(leafset_dir, file_index);
+    if (file.Exists()) {
+        try {
+            LeafSet::Ptr pLeafSet = Deserialize(leafset_dir, file.ReadBytes());
+            if (legacy_file.Exists()) {
+                legacy_file.GetPath().Remove();
+            }
+
+            return pLeafSet;
+        } catch (const std::exception& e) {
+            // A migration may have been interrupted while writing the compressed file.
+            if (!legacy_file.Exists()) {
+                throw;
+            }
+
+            LOG_WARNING_F("Failed to read leafset {}. Migrating again. Error: {}", file.GetPath(), e.what());
+        }
     }
 
-    mmr::LeafIndex nextLeafIdx = mmr::LeafIndex::At(0);
-    if (file.GetSize() < 8) {
-        file.Write(nextLeafIdx.Serialized());
-    } else {
-        nextLeafIdx = LeafIndex::Deserialize(file.ReadBytes(0, 8));
+    if (legacy_file.Exists()) {
+        return MigrateLegacy(leafset_dir, file_index);
     }
 
-    MemMap mappedFile{ file };
-    mappedFile.Map();
-    return std::shared_ptr<LeafSet>(new LeafSet{ leafset_dir, std::move(mappedFile), nextLeafIdx });
+    return std::shared_ptr<LeafSet>(new LeafSet{ leafset_dir, mmr::LeafIndex::At(0) });
 }
 
 FilePath LeafSet::GetPath(const FilePath& leafset_dir, const uint32_t file_index)
+{
+    return leafset_dir.GetChild(StringUtil::Format("lset{:0>6}.dat", file_index));
+}
+
+FilePath LeafSet::GetLegacyPath(const FilePath& leafset_dir, const uint32_t file_index)
 {
     return leafset_dir.GetChild(StringUtil::Format("leaf{:0>6}.dat", file_index));
 }
 
+LeafSet::Ptr LeafSet::Deserialize(const FilePath& leafset_dir, const std::vector<uint8_t>& serialized)
+{
+    VectorReader stream(SER_DISK, PROTOCOL_VERSION, serialized, 0);
+
+    uint8_t version;
+    stream >> version;
+    if (version != COMPRESSED_VERSION) {
+        ThrowDeserialization_F("Unsupported leafset version {}", version);
+    }
+
+    uint64_t next_leaf_idx;
+    stream >> next_leaf_idx;
+
+    auto pLeafSet = std::shared_ptr<LeafSet>(new LeafSet{ leafset_dir, mmr::LeafIndex::At(next_leaf_idx) });
+    stream >> pLeafSet->m_containers;
+    return pLeafSet;
+}
+
+LeafSet::Ptr LeafSet::MigrateLegacy(const FilePath& leafset_dir, const uint32_t file_index)
+{
+    // The legacy format is the next leaf index, followed by a flat bitmap of every leaf.
+    File legacy_file = GetLegacyPath(leafset_dir, file_index);
+    std::vector<uint8_t> bytes = legacy_file.ReadBytes();
+
+    mmr::LeafIndex next_leaf_idx = mmr::LeafIndex::At(0);
+    if (bytes.size() >= 8) {
+        next_leaf_idx = LeafIndex::Deserialize(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 8));
+    }
+
+    auto pLeafSet = std::shared_ptr<LeafSet>(new LeafSet{ leafset_dir, next_leaf_idx });
+    for (size_t i = 8; i < bytes.size(); i++) {
+        if (bytes[i] != 0) {
+            pLeafSet->SetByte(i - 8, bytes[i]);
+        }
+    }
+
+    pLeafSet->Truncate();
+    pLeafSet->Flush(file_index);
+    legacy_file.GetPath().Remove();
+
+    LOG_INFO_F(
+        "Migrated leafset {} ({} leaves) to {} compressed containers",
+        file_index,
+        next_leaf_idx.Get(),
+        pLeafSet->GetNumContainers()
+    );
+    return pLeafSet;
+}
+
+std::vector<uint8_t> LeafSet::ExportSnapshot() const
+{
+    std::vector<uint8_t> serialized;
+    CVectorWriter stream(SER_DISK, PROTOCOL_VERSION, serialized, 0);
+    stream << COMPRESSED_VERSION << m_nextLeafIdx.Get() << m_containers;
+    return serialized;
+}
+
+LeafSet::Ptr LeafSet::ImportSnapshot(const FilePath& leafset_dir, const uint32_t file_index, const std::vector<uint8_t>& snapshot)
+{
+    LeafSet::Ptr pLeafSet = Deserialize(leafset_dir, snapshot);
+    pLeafSet->Truncate();
+    pLeafSet->Flush(file_index);
+    return pLeafSet;
+}
+
+uint64_t LeafSet::GetNumUnspent() const noexcept
+{
+    uint64_t num_unspent = 0;
+    for (const auto& container : m_containers) {
+        num_unspent += container.second.GetCardinality();
+    }
+
+    return num_unspent;
+}
+
 void LeafSet::ApplyUpdates(
     const uint32_t file_index,
     const mmr::LeafIndex& nextLeafIdx,
     const std::unordered_map<uint64_t, uint8_t>& modifiedBytes)
 {
     for (auto byte : modifiedBytes) {
-        m_modifiedBytes[byte.first + 8] = byte.second;
+        SetByte(byte.first, byte.second);
     }
 
     // In case of rewind, make sure to clear everything above the new next
-    for (size_t idx = nextLeafIdx.Get(); idx < m_nextLeafIdx.Get(); idx++) {
-        Remove(mmr::LeafIndex::At(idx));
-    }
-
     m_nextLeafIdx = nextLeafIdx;
+    Truncate();
 
     Flush(file_index);
 }
 
 void LeafSet::Flush(const uint32_t file_index)
 {
-    m_mmap.Unmap();
-
-    std::vector<uint8_t> nextLeafIdxBytes = m_nextLeafIdx.Serialized();
-    assert(nextLeafIdxBytes.size() == 8);
-
-    for (uint8_t i = 0; i < 8; i++) {
-        m_modifiedBytes[i] = nextLeafIdxBytes[i];
+    // File::Write appends, so replace any file previously flushed with this index.
+    FilePath path = GetPath(m_dir, file_index);
+    if (path.Exists()) {
+        path.Remove();
     }
 
-    FilePath new_leafset_path = GetPath(m_dir, file_index);
-    m_mmap.GetFile().CopyTo(new_leafset_path);
-
-    File new_leafset_file(std::move(new_leafset_path));
-    new_leafset_file.WriteBytes(m_modifiedBytes);
-
-    m_mmap = MemMap{ new_leafset_file };
-    m_mmap.Map();
-
-    m_modifiedBytes.clear();
+    File(path).Write(ExportSnapshot());
 }
 
 void LeafSet::Cleanup(const uint32_t current_file_index) const
@@ -74,33 +158,99 @@ void LeafSet::Cleanup(const uint32_t current_file_index) const
     uint32_t file_index = current_file_index;
     while (file_index > 0) {
         FilePath prev_leafset = GetPath(m_dir, --file_index);
+        FilePath prev_legacy_leafset = GetLegacyPath(m_dir, file_index);
+        if (!prev_leafset.Exists() && !prev_legacy_leafset.Exists()) {
+            break;
+        }
+
         if (prev_leafset.Exists()) {
             prev_leafset.Remove();
-        } else {
-            break;
+        }
+
+        if (prev_legacy_leafset.Exists()) {
+            prev_legacy_leafset.Remove();
         }
     }
 }
 
 uint8_t LeafSet::GetByte(const uint64_t byteIdx) const
 {
-    // Offset by 8 bytes, since first 8 bytes in file represent the next leaf index
-    const uint64_t byteIdxWithOffset = byteIdx + 8;
+    auto iter = m_containers.find(ContainerKey(byteIdx));
+    if (iter == m_containers.cend()) {
+        return 0;
+    }
 
-    auto iter = m_modifiedBytes.find(byteIdxWithOffset);
-    if (iter != m_modifiedBytes.cend())
-    {
-        return iter->second;
+    return iter->second.GetByte(ContainerByte(byteIdx));
+}
+
+void LeafSet::SetByte(const uint64_t byteIdx, const uint8_t value)
+{
+    MarkChunkDirty(byteIdx);
+
+    auto iter = m_containers.find(ContainerKey(byteIdx));
+    if (iter == m_containers.end()) {
+        if (value == 0) {
+            return;
+        }
+
+        iter = m_containers.emplace(ContainerKey(byteIdx), LeafSetContainer{}).first;
     }
-    else if (byteIdxWithOffset < m_mmap.size())
+
+    iter->second.SetByte(ContainerByte(byteIdx), value);
+    if (iter->second.IsEmpty()) {
+        m_containers.erase(iter);
+    }
+}
+
+mw::Hash LeafSet::GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const
+{
     {
-        return m_mmap.ReadByte(byteIdxWithOffset);
+        std::unique_lock<std::mutex> lock(m_chunkCVsMutex);
+        auto cached = m_chunkCVs.find(chunk_idx);
+        if (cached != m_chunkCVs.cend() && cached->second.first == chunk_len) {
+            return cached->second.second;
+        }
     }
 
-    return 0;
+    // Chunks never straddle containers, since a container holds a whole number of chunks.
+    static_assert(LeafSetContainer::NUM_BYTES % BLAKE3_CHUNK_LEN == 0, "Chunks must not span containers");
+    const uint64_t first_byte = chunk_idx * BLAKE3_CHUNK_LEN;
+
+    uint8_t bytes[BLAKE3_CHUNK_LEN] = {0};
+    auto iter = m_containers.find(ContainerKey(first_byte));
+    if (iter != m_containers.cend()) {
+        iter->second.ReadBytes(ContainerByte(first_byte), (uint32_t)chunk_len, bytes);
+    }
+
+    mw::Hash cv = ChunkChainingValue(bytes, chunk_len, chunk_idx);
+
+    std::unique_lock<std::mutex> lock(m_chunkCVsMutex);
+    m_chunkCVs[chunk_idx] = std::make_pair(chunk_len, cv);
+    return cv;
 }
 
-void LeafSet::SetByte(const uint64_t byteIdx, const uint8_t value)
+void LeafSet::Truncate()
 {
-    m_modifiedBytes[byteIdx + 8] = value;
-}
\ No newline at end of file
+    const uint64_t num_leaves = m_nextLeafIdx.Get();
+
+    auto iter = m_containers.lower_bound(num_leaves / LeafSetContainer::NUM_LEAVES);
+    if (iter != m_containers.end() && iter->first == num_leaves / LeafSetContainer::NUM_LEAVES) {
+        iter->second.Truncate(num_leaves % LeafSetContainer::NUM_LEAVES);
+        iter = iter->second.IsEmpty() ? m_containers.erase(iter) : std::next(iter);
+    }
+
+    m_containers.erase(iter, m_containers.end());
+
+    // The chaining values of chunks beyond the new end are no longer valid.
+    const uint64_t first_invalid_chunk = (num_leaves / 8) / BLAKE3_CHUNK_LEN;
+    std::unique_lock<std::mutex> lock(m_chunkCVsMutex);
+    for (auto cv_iter = m_chunkCVs.begin(); cv_iter != m_chunkCVs.end();) {
+        cv_iter = cv_iter->first >= first_invalid_chunk ? m_chunkCVs.erase(cv_iter) : std::next(cv_iter);
+    }
+}
+
+void LeafSet::MarkChunkDirty(const uint64_t byteIdx) const
+{
+    std::unique_lock<std::mutex> lock(m_chunkCVsMutex);
+    m_chunkCVs.erase(byteIdx / BLAKE3_CHUNK_LEN);
+}
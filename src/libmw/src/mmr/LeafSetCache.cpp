@@ -12,6 +12,7 @@ void LeafSetCache::ApplyUpdates(
 
     for (auto byte : modifiedBytes) {
         m_modifiedBytes[byte.first] = byte.second;
+        m_modifiedChunks.insert(byte.first / BLAKE3_CHUNK_LEN);
     }
 }
 
@@ -19,6 +20,7 @@ void LeafSetCache::Flush(const uint32_t file_index)
 {
     m_pBacked->ApplyUpdates(file_index, m_nextLeafIdx, m_modifiedBytes);
     m_modifiedBytes.clear();
+    m_modifiedChunks.clear();
 }
 
 uint8_t LeafSetCache::GetByte(const uint64_t byteIdx) const
@@ -35,4 +37,14 @@ uint8_t LeafSetCache::GetByte(const uint64_t byteIdx) const
 void LeafSetCache::SetByte(const uint64_t byteIdx, const uint8_t value)
 {
     m_modifiedBytes[byteIdx] = value;
+    m_modifiedChunks.insert(byteIdx / BLAKE3_CHUNK_LEN);
+}
+
+mw::Hash LeafSetCache::GetChunkCV(const uint64_t chunk_idx, const size_t chunk_len) const
+{
+    if (m_modifiedChunks.count(chunk_idx) > 0) {
+        return CalcChunkCV(chunk_idx, chunk_len);
+    }
+
+    return m_pBacked->GetChunkCV(chunk_idx, chunk_len);
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/mmr/LeafSetContainer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace mmr;
+
+constexpr uint32_t LeafSetContainer::NUM_LEAVES;
+constexpr uint32_t LeafSetContainer::NUM_BYTES;
+constexpr size_t LeafSetContainer::MAX_ARRAY_SIZE;
+
+static uint8_t BitMask(const uint32_t pos) { return 0x80 >> (pos % 8); }
+
+static uint32_t PopCount(const uint8_t byte)
+{
+    uint32_t count = 0;
+    for (uint8_t b = byte; b != 0; b &= (b - 1)) {
+        ++count;
+    }
+
+    return count;
+}
+
+bool LeafSetContainer::Contains(const uint16_t pos) const noexcept
+{
+    if (IsBitmap()) {
+        return m_bitmap[pos / 8] & BitMask(pos);
+    }
+
+    return std::binary_search(m_array.cbegin(), m_array.cend(), pos);
+}
+
+void LeafSetContainer::Set(const uint16_t pos, const bool value)
+{
+    if (IsBitmap()) {
+        uint8_t& byte = m_bitmap[pos / 8];
+        if (((byte & BitMask(pos)) != 0) == value) {
+            return;
+        }
+
+        byte ^= BitMask(pos);
+        if (value) {
+            ++m_cardinality;
+        } else if (--m_cardinality <= MAX_ARRAY_SIZE / 2) {
+            // Only switch back at half the limit, so a container that hovers
+            // around MAX_ARRAY_SIZE doesn't keep flipping between encodings.
+            ToArray();
+        }
+
+        return;
+    }
+
+    auto iter = std::lower_bound(m_array.begin(), m_array.end(), pos);
+    const bool found = iter != m_array.end() && *iter == pos;
+    if (value && !found) {
+        m_array.insert(iter, pos);
+        if (m_array.size() > MAX_ARRAY_SIZE) {
+            ToBitmap();
+        }
+    } else if (!value && found) {
+        m_array.erase(iter);
+    }
+}
+
+uint8_t LeafSetContainer::GetByte(const uint16_t byte_idx) const noexcept
+{
+    if (IsBitmap()) {
+        return m_bitmap[byte_idx];
+    }
+
+    uint8_t byte = 0;
+    const uint32_t first_pos = (uint32_t)byte_idx * 8;
+    auto iter = std::lower_bound(m_array.cbegin(), m_array.cend(), first_pos);
+    while (iter != m_array.cend() && *iter < first_pos + 8) {
+        byte |= BitMask(*iter);
+        ++iter;
+    }
+
+    return byte;
+}
+
+void LeafSetContainer::SetByte(const uint16_t byte_idx, const uint8_t value)
+{
+    const uint8_t changed = GetByte(byte_idx) ^ value;
+    for (uint32_t bit = 0; bit < 8; bit++) {
+        if (changed & BitMask(bit)) {
+            Set((uint16_t)((uint32_t)byte_idx * 8 + bit), value & BitMask(bit));
+        }
+    }
+}
+
+void LeafSetContainer::ReadBytes(const uint32_t first_byte, const uint32_t num_bytes, uint8_t* out) const
+{
+    assert(first_byte + num_bytes <= NUM_BYTES);
+
+    if (IsBitmap()) {
+        memcpy(out, m_bitmap.data() + first_byte, num_bytes);
+        return;
+    }
+
+    memset(out, 0, num_bytes);
+    const uint32_t first_pos = first_byte * 8;
+    const uint32_t end_pos = (first_byte + num_bytes) * 8;
+    auto iter = std::lower_bound(m_array.cbegin(), m_array.cend(), first_pos);
+    while (iter != m_array.cend() && *iter < end_pos) {
+        out[(*iter - first_pos) / 8] |= BitMask(*iter);
+        ++iter;
+    }
+}
+
+void LeafSetContainer::Truncate(const uint32_t pos)
+{
+    if (pos >= NUM_LEAVES) {
+        return;
+    }
+
+    if (IsBitmap()) {
+        std::vector<uint8_t> bitmap = std::move(m_bitmap);
+        bitmap[pos / 8] &= (uint8_t)(0xff << (8 - (pos % 8)));
+        std::fill(bitmap.begin() + (pos / 8) + 1, bitmap.end(), 0);
+        LoadBitmap(std::move(bitmap));
+    } else {
+        m_array.erase(std::lower_bound(m_array.begin(), m_array.end(), pos), m_array.end());
+    }
+}
+
+std::vector<std::pair<uint16_t, uint16_t>> LeafSetContainer::GetRuns() const
+{
+    std::vector<std::pair<uint16_t, uint16_t>> runs;
+    ForEach([&runs](const uint16_t pos) {
+        if (!runs.empty() && (uint32_t)runs.back().first + runs.back().second + 1 == pos) {
+            ++runs.back().second;
+        } else {
+            runs.push_back({ pos, 0 });
+        }
+    });
+
+    return runs;
+}
+
+void LeafSetContainer::ToBitmap()
+{
+    assert(!IsBitmap());
+
+    std::vector<uint8_t> bitmap(NUM_BYTES);
+    for (const uint16_t pos : m_array) {
+        bitmap[pos / 8] |= BitMask(pos);
+    }
+
+    m_cardinality = (uint32_t)m_array.size();
+    m_bitmap = std::move(bitmap);
+    m_array.clear();
+    m_array.shrink_to_fit();
+}
+
+void LeafSetContainer::ToArray()
+{
+    assert(IsBitmap());
+
+    std::vector<uint16_t> array;
+    array.reserve(m_cardinality);
+    ForEach([&array](const uint16_t pos) { array.push_back(pos); });
+
+    m_array = std::move(array);
+    m_bitmap.clear();
+    m_bitmap.shrink_to_fit();
+    m_cardinality = 0;
+}
+
+void LeafSetContainer::LoadBitmap(std::vector<uint8_t>&& bytes)
+{
+    assert(bytes.size() == NUM_BYTES);
+
+    uint32_t cardinality = 0;
+    for (const uint8_t byte : bytes) {
+        cardinality += PopCount(byte);
+    }
+
+    m_array.clear();
+    m_bitmap = std::move(bytes);
+    m_cardinality = cardinality;
+    if (m_cardinality <= MAX_ARRAY_SIZE) {
+        ToArray();
+    }
+}
@@ -1,6 +1,7 @@
 #include <mw/mmr/MMRUtil.h>
 #include <mw/crypto/Hasher.h>
 #include <mw/util/BitUtil.h>
+#include <crypto/common.h>
 
 #include <boost/dynamic_bitset.hpp>
 #include <cmath>
@@ -16,6 +17,23 @@ mw::Hash MMRUtil::CalcParentHash(const Index& index, const mw::Hash& left_hash,
         .hash();
 }
 
+std::vector<mw::Hash> MMRUtil::CalcParentHashes(const std::vector<mmr::Index>& indices, const std::vector<mw::Hash>& child_hashes)
+{
+    assert(child_hashes.size() == indices.size() * 2);
+
+    // Same serialization as CalcParentHash: position (8 bytes LE), left hash, right hash
+    const size_t input_len = sizeof(uint64_t) + (mw::Hash::size() * 2);
+    std::vector<uint8_t> serialized(indices.size() * input_len);
+    for (size_t i = 0; i < indices.size(); i++) {
+        uint8_t* pInput = serialized.data() + (i * input_len);
+        WriteLE64(pInput, indices[i].GetPosition());
+        memcpy(pInput + sizeof(uint64_t), child_hashes[i * 2].data(), mw::Hash::size());
+        memcpy(pInput + sizeof(uint64_t) + mw::Hash::size(), child_hashes[(i * 2) + 1].data(), mw::Hash::size());
+    }
+
+    return HashedMany(serialized, input_len);
+}
+
 BitSet MMRUtil::BuildCompactBitSet(const uint64_t num_leaves, const BitSet& unspent_leaf_indices)
 {
     BitSet compactable_node_indices(num_leaves * 2);
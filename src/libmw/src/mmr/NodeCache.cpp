@@ -0,0 +1,67 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/mmr/NodeCache.h>
+
+using namespace mmr;
+
+constexpr size_t NodeCache::ENTRY_SIZE;
+
+boost::optional<mw::Hash> NodeCache::Get(const char prefix, const Index& idx)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto iter = m_entries.find(Key(prefix, idx.GetPosition()));
+    if (iter == m_entries.end()) {
+        m_misses++;
+        return boost::none;
+    }
+
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, iter->second);
+    return iter->second->second;
+}
+
+void NodeCache::Put(const char prefix, const Index& idx, const mw::Hash& hash)
+{
+    if (m_maxEntries == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const Key key(prefix, idx.GetPosition());
+    auto iter = m_entries.find(key);
+    if (iter != m_entries.end()) {
+        iter->second->second = hash;
+        m_lru.splice(m_lru.begin(), m_lru, iter->second);
+        return;
+    }
+
+    if (m_entries.size() >= m_maxEntries) {
+        m_entries.erase(m_lru.back().first);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+
+    m_lru.emplace_front(key, hash);
+    m_entries.emplace(key, m_lru.begin());
+}
+
+void NodeCache::EraseFrom(const char prefix, const Index& idx)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto iter = m_entries.lower_bound(Key(prefix, idx.GetPosition()));
+    while (iter != m_entries.end() && iter->first.first == prefix) {
+        m_lru.erase(iter->second);
+        iter = m_entries.erase(iter);
+    }
+}
+
+NodeCache::Stats NodeCache::GetStats() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return Stats{m_hits, m_misses, m_evictions, m_entries.size(), m_maxEntries};
+}
@@ -12,7 +12,8 @@ PMMR::Ptr PMMR::Open(
     const FilePath& mmr_dir,
     const uint32_t file_index,
     const mw::DBWrapper::Ptr& pDBWrapper,
-    const PruneList::CPtr& pPruneList)
+    const PruneList::CPtr& pPruneList,
+    const NodeCache::Ptr& pNodeCache)
 {
     auto pHashFile = AppendOnlyFile::Load(
         GetPath(mmr_dir, dbPrefix, file_index)
@@ -22,7 +23,8 @@ PMMR::Ptr PMMR::Open(
         mmr_dir,
         pHashFile,
         pDBWrapper,
-        pPruneList
+        pPruneList,
+        pNodeCache
     );
 }
 
@@ -36,6 +38,9 @@ LeafIndex PMMR::AddLeaf(const mmr::Leaf& leaf)
     m_leafMap[leaf.GetLeafIndex()] = m_leaves.size();
     m_leaves.push_back(leaf);
     m_pHashFile->Append(leaf.GetHash().vec());
+    if (m_pNodeCache) {
+        m_pNodeCache->Put(m_dbPrefix, leaf.GetNodeIndex(), leaf.GetHash());
+    }
 
     auto rightHash = leaf.GetHash();
     auto nextIdx = leaf.GetNodeIndex().GetNext();
@@ -44,12 +49,43 @@ LeafIndex PMMR::AddLeaf(const mmr::Leaf& leaf)
         rightHash = MMRUtil::CalcParentHash(nextIdx, leftHash, rightHash);
 
         m_pHashFile->Append(rightHash.vec());
+        if (m_pNodeCache) {
+            m_pNodeCache->Put(m_dbPrefix, nextIdx, rightHash);
+        }
         nextIdx = nextIdx.GetNext();
     }
 
     return leaf.GetLeafIndex();
 }
 
+void PMMR::AddLeaves(const std::vector<mmr::Leaf>& leaves)
+{
+    if (leaves.empty()) {
+        return;
+    }
+
+    const Index first_idx = leaves.front().GetNodeIndex();
+    std::vector<mw::Hash> hashes = CalcAppendedHashes(leaves);
+
+    std::vector<uint8_t> serialized;
+    serialized.reserve(hashes.size() * mw::Hash::size());
+    for (const mw::Hash& hash : hashes) {
+        serialized.insert(serialized.end(), hash.vec().begin(), hash.vec().end());
+    }
+    m_pHashFile->Append(serialized);
+
+    if (m_pNodeCache) {
+        for (size_t i = 0; i < hashes.size(); i++) {
+            m_pNodeCache->Put(m_dbPrefix, Index::At(first_idx.GetPosition() + i), hashes[i]);
+        }
+    }
+
+    for (const Leaf& leaf : leaves) {
+        m_leafMap[leaf.GetLeafIndex()] = m_leaves.size();
+        m_leaves.push_back(leaf);
+    }
+}
+
 Leaf PMMR::GetLeaf(const LeafIndex& idx) const
 {
     auto it = m_leafMap.find(idx);
@@ -68,12 +104,58 @@ Leaf PMMR::GetLeaf(const LeafIndex& idx) const
 
 mw::Hash PMMR::GetHash(const Index& idx) const
 {
+    if (m_pNodeCache) {
+        auto cached = m_pNodeCache->Get(m_dbPrefix, idx);
+        if (cached) {
+            return *cached;
+        }
+    }
+
     uint64_t pos = idx.GetPosition();
     if (m_pPruneList) {
         pos -= m_pPruneList->GetShift(idx);
     }
 
-    return mw::Hash(m_pHashFile->Read(pos * mw::Hash::size(), mw::Hash::size()));
+    mw::Hash hash(m_pHashFile->ReadSpan(pos * mw::Hash::size(), mw::Hash::size()).data());
+    if (m_pNodeCache) {
+        m_pNodeCache->Put(m_dbPrefix, idx, hash);
+    }
+
+    return hash;
+}
+
+std::vector<mw::Hash> PMMR::GetHashes(const Index& first, const uint64_t count) const
+{
+    std::vector<mw::Hash> hashes;
+    if (count == 0) {
+        return hashes;
+    }
+
+    hashes.reserve(count);
+
+    // Hashes are only stored contiguously if no nodes in the range were pruned.
+    const Index last = Index::At(first.GetPosition() + count - 1);
+    const uint64_t shift = m_pPruneList ? m_pPruneList->GetShift(first) : 0;
+    if (m_pPruneList && m_pPruneList->GetShift(last) != shift) {
+        for (uint64_t pos = first.GetPosition(); pos <= last.GetPosition(); pos++) {
+            hashes.push_back(GetHash(Index::At(pos)));
+        }
+
+        return hashes;
+    }
+
+    m_pHashFile->ForEachSpan(
+        (first.GetPosition() - shift) * mw::Hash::size(),
+        count * mw::Hash::size(),
+        [&hashes](Span<const uint8_t> bytes) {
+            assert(bytes.size() % mw::Hash::size() == 0);
+            for (size_t i = 0; i < bytes.size(); i += mw::Hash::size()) {
+                hashes.emplace_back(bytes.data() + i);
+            }
+        }
+    );
+
+    return hashes;
 }
 
 uint64_t PMMR::GetNumLeaves() const noexcept
@@ -102,6 +184,9 @@ void PMMR::Rewind(const uint64_t numLeaves)
     }
 
     m_pHashFile->Rewind(pos * mw::Hash::size());
+    if (m_pNodeCache) {
+        m_pNodeCache->EraseFrom(m_dbPrefix, next_leaf_idx.GetNodeIndex());
+    }
 }
 
 void PMMR::BatchWrite(
@@ -113,9 +198,7 @@ void PMMR::BatchWrite(
     LOG_TRACE_F("Writing batch {} with first leaf {}", file_index, firstLeafIdx.Get());
 
     Rewind(firstLeafIdx.Get());
-    for (const Leaf& leaf : leaves) {
-        AddLeaf(leaf);
-    }
+    AddLeaves(leaves);
 
     m_pHashFile->Commit(GetPath(m_dir, m_dbPrefix, file_index));
 
@@ -125,6 +208,19 @@ void PMMR::BatchWrite(
 
     m_leaves.clear();
     m_leafMap.clear();
+
+    if (m_pNodeCache) {
+        const NodeCache::Stats stats = m_pNodeCache->GetStats();
+        LOG_DEBUG_F(
+            "MMR node cache: {} hits, {} misses ({:.1f}% hit rate), {} evictions, {}/{} entries",
+            stats.hits,
+            stats.misses,
+            stats.HitRate() * 100,
+            stats.evictions,
+            stats.num_entries,
+            stats.max_entries
+        );
+    }
 }
 
 void PMMR::Cleanup(const uint32_t current_file_index) const
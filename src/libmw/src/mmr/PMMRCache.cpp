@@ -22,6 +22,13 @@ LeafIndex PMMRCache::AddLeaf(const Leaf& leaf)
     return leaf.GetLeafIndex();
 }
 
+void PMMRCache::AddLeaves(const std::vector<Leaf>& leaves)
+{
+    std::vector<mw::Hash> hashes = CalcAppendedHashes(leaves);
+    m_nodes.insert(m_nodes.end(), hashes.begin(), hashes.end());
+    m_leaves.insert(m_leaves.end(), leaves.begin(), leaves.end());
+}
+
 Leaf PMMRCache::GetLeaf(const LeafIndex& leafIdx) const
 {
     if (leafIdx < m_firstLeaf) {
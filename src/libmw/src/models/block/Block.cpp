@@ -3,21 +3,18 @@
 #include <mw/consensus/StealthSumValidator.h>
 #include <mw/mmr/MMR.h>
 
-void mw::Block::Validate() const
+void mw::Block::Validate(const bool verify_crypto) const
 {
     if (m_pHeader->GetNumKernels() != m_body.GetKernels().size()) {
         ThrowValidation(EConsensusError::MMR_MISMATCH);
     }
 
-    m_body.Validate();
+    m_body.Validate(verify_crypto);
 
     StealthSumValidator::Validate(m_pHeader->GetStealthOffset(), m_body);
 
     MemMMR kernel_mmr;
-    std::for_each(
-        GetKernels().cbegin(), GetKernels().cend(),
-        [&kernel_mmr](const Kernel& kernel) { kernel_mmr.Add(kernel); }
-    );
+    kernel_mmr.AddAll(GetKernels());
     if (m_pHeader->GetKernelRoot() != kernel_mmr.Root()) {
         ThrowValidation(EConsensusError::MMR_MISMATCH);
     }
@@ -36,7 +36,7 @@ Input Input::Create(const mw::Hash& output_id, const Commitment& commitment, con
     );
 }
 
-SignedMessage Input::BuildSignedMsg() const noexcept
+SignedMessage Input::BuildSignedMsg() const
 {
     // Calculate message hash
     Hasher msg_hasher;
@@ -1,6 +1,8 @@
 #include <mw/models/tx/Transaction.h>
 #include <mw/consensus/KernelSumValidator.h>
 #include <mw/consensus/StealthSumValidator.h>
+#include <mw/crypto/Bulletproofs.h>
+#include <mw/crypto/Schnorr.h>
 
 using namespace mw;
 
@@ -55,4 +57,20 @@ void Transaction::Validate() const
 
     KernelSumValidator::ValidateForTx(*this);
     StealthSumValidator::Validate(m_stealthOffset, m_body);
+}
+
+bool Transaction::BatchVerify(const std::vector<mw::Transaction::CPtr>& txs)
+{
+    std::vector<SignedMessage> signatures;
+    std::vector<ProofData> proofs;
+    for (const mw::Transaction::CPtr& pTx : txs) {
+        std::vector<SignedMessage> tx_signatures = pTx->m_body.BuildSignedMsgs();
+        signatures.insert(signatures.end(), tx_signatures.begin(), tx_signatures.end());
+
+        std::vector<ProofData> tx_proofs = pTx->m_body.BuildProofData();
+        proofs.insert(proofs.end(), tx_proofs.begin(), tx_proofs.end());
+    }
+
+    return (signatures.empty() || Schnorr::BatchVerify(signatures))
+        && (proofs.empty() || Bulletproofs::BatchVerify(proofs));
 }
\ No newline at end of file
@@ -6,12 +6,13 @@
 bool BlockValidator::ValidateBlock(
     const mw::Block::CPtr& pBlock,
     const std::vector<PegInCoin>& pegInCoins,
-    const std::vector<PegOutCoin>& pegOutCoins) noexcept
+    const std::vector<PegOutCoin>& pegOutCoins,
+    const bool verify_crypto) noexcept
 {
     assert(pBlock != nullptr);
 
     try {
-        pBlock->Validate();
+        pBlock->Validate(verify_crypto);
 
         ValidatePegInCoins(pBlock, pegInCoins);
         ValidatePegOutCoins(pBlock, pegOutCoins);
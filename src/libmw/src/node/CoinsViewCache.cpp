@@ -7,6 +7,8 @@
 
 #include "CoinActions.h"
 
+#include <unordered_set>
+
 using namespace mw;
 
 CoinsViewCache::CoinsViewCache(const ICoinsView::Ptr& pBase)
@@ -34,6 +36,29 @@ UTXO::CPtr CoinsViewCache::GetUTXO(const mw::Hash& output_id) const noexcept
     return pUTXO;
 }
 
+std::unordered_map<mw::Hash, UTXO::CPtr> CoinsViewCache::GetUTXOs(const std::vector<mw::Hash>& output_ids) const
+{
+    std::unordered_map<mw::Hash, UTXO::CPtr> utxos;
+
+    // Only coins without cached updates need to be looked up in the base view.
+    std::vector<mw::Hash> base_ids;
+    for (const mw::Hash& output_id : output_ids) {
+        std::vector<CoinAction> actions = m_pUpdates->GetActions(output_id);
+        if (actions.empty()) {
+            base_ids.push_back(output_id);
+        } else if (!actions.back().IsSpend()) {
+            utxos[output_id] = actions.back().pUTXO;
+        }
+    }
+
+    if (!base_ids.empty()) {
+        auto base_utxos = m_pBase->GetUTXOs(base_ids);
+        utxos.insert(base_utxos.begin(), base_utxos.end());
+    }
+
+    return utxos;
+}
+
 mw::BlockUndo::CPtr CoinsViewCache::ApplyBlock(const mw::Block::CPtr& pBlock)
 {
     assert(pBlock != nullptr);
@@ -44,23 +69,16 @@ mw::BlockUndo::CPtr CoinsViewCache::ApplyBlock(const mw::Block::CPtr& pBlock)
     BlindingFactor prev_offset = pPreviousHeader != nullptr ? pPreviousHeader->GetKernelOffset() : BlindingFactor();
     KernelSumValidator::ValidateForBlock(pBlock->GetTxBody(), pBlock->GetKernelOffset(), prev_offset);
 
+    AddUTXOs(pBlock->GetHeight(), pBlock->GetOutputs());
+
     std::vector<mw::Hash> coinsAdded;
-    std::for_each(
+    std::transform(
         pBlock->GetOutputs().cbegin(), pBlock->GetOutputs().cend(),
-        [this, &pBlock, &coinsAdded](const Output& output) {
-            AddUTXO(pBlock->GetHeight(), output);
-            coinsAdded.push_back(output.GetOutputID());
-        }
+        std::back_inserter(coinsAdded),
+        [](const Output& output) { return output.GetOutputID(); }
     );
 
-    std::vector<UTXO> coinsSpent;
-    std::for_each(
-        pBlock->GetInputs().cbegin(), pBlock->GetInputs().cend(),
-        [this, &coinsSpent](const Input& input) {
-            UTXO spentUTXO = SpendUTXO(input.GetOutputID());
-            coinsSpent.push_back(std::move(spentUTXO));
-        }
-    );
+    std::vector<UTXO> coinsSpent = SpendUTXOs(pBlock->GetInputs());
 
     auto pHeader = pBlock->GetHeader();
     if (pHeader->GetOutputRoot() != GetOutputPMMR()->Root()
@@ -77,19 +95,8 @@ static const uint32_t MEMPOOL_HEIGHT = 0x7FFFFFFF;
 
 void CoinsViewCache::AddTx(const mw::Transaction::CPtr& pTx)
 {
-    std::for_each(
-        pTx->GetOutputs().cbegin(), pTx->GetOutputs().cend(),
-        [this](const Output& output) {
-            AddUTXO(MEMPOOL_HEIGHT, output);
-        }
-    );
-
-    std::for_each(
-        pTx->GetInputs().cbegin(), pTx->GetInputs().cend(),
-        [this](const Input& input) {
-            SpendUTXO(input.GetOutputID());
-        }
-    );
+    AddUTXOs(MEMPOOL_HEIGHT, pTx->GetOutputs());
+    SpendUTXOs(pTx->GetInputs());
 }
 
 void CoinsViewCache::UndoBlock(const mw::BlockUndo::CPtr& pUndo)
@@ -134,20 +141,11 @@ mw::Block::Ptr CoinsViewCache::BuildNextBlock(const uint64_t height, const std::
     auto pTransaction = Aggregation::Aggregate(transactions);
 
     MemMMR::Ptr pKernelMMR = std::make_shared<MemMMR>();
-    std::for_each(
-        pTransaction->GetKernels().cbegin(), pTransaction->GetKernels().cend(),
-        [&pKernelMMR](const Kernel& kernel) { pKernelMMR->Add(kernel); }
-    );
+    pKernelMMR->AddAll(pTransaction->GetKernels());
 
-    std::for_each(
-        pTransaction->GetOutputs().cbegin(), pTransaction->GetOutputs().cend(),
-        [this, height](const Output& output) { AddUTXO(height, output); }
-    );
+    AddUTXOs(height, pTransaction->GetOutputs());
 
-    std::for_each(
-        pTransaction->GetInputs().cbegin(), pTransaction->GetInputs().cend(),
-        [this](const Input& input) { SpendUTXO(input.GetOutputID()); } // MW: TODO - Do we need to check the UTXO's receiver public key? Presumably, that was already done.
-    );
+    SpendUTXOs(pTransaction->GetInputs()); // MW: TODO - Do we need to check the UTXO's receiver public key? Presumably, that was already done.
 
     const uint64_t output_mmr_size = m_pOutputPMMR->GetNumLeaves();
     const uint64_t kernel_mmr_size = pKernelMMR->GetNumLeaves();
@@ -200,32 +198,56 @@ bool CoinsViewCache::HasSpendInCache(const mw::Hash& output_id) const noexcept
     return false;
 }
 
-void CoinsViewCache::AddUTXO(const uint64_t header_height, const Output& output)
+void CoinsViewCache::AddUTXOs(const uint64_t header_height, const std::vector<Output>& outputs)
 {
-    UTXO::CPtr pUTXO = GetUTXO(output.GetOutputID());
-    if (pUTXO != nullptr) {// && m_pLeafSet->Contains(pUTXO->GetLeafIndex())) {
+    std::vector<mw::Hash> output_ids;
+    output_ids.reserve(outputs.size());
+    std::transform(
+        outputs.cbegin(), outputs.cend(),
+        std::back_inserter(output_ids),
+        [](const Output& output) { return output.GetOutputID(); }
+    );
+
+    std::unordered_set<mw::Hash> unique_ids(output_ids.cbegin(), output_ids.cend());
+    if (unique_ids.size() != output_ids.size() || !GetUTXOs(output_ids).empty()) {
         ThrowValidation(EConsensusError::DUPLICATES);
     }
 
-    mmr::LeafIndex leafIdx = m_pOutputPMMR->Add(output.GetOutputID());
-    m_pLeafSet->Add(leafIdx);
-
-    pUTXO = std::make_shared<UTXO>(header_height, std::move(leafIdx), output);
-
-    m_pUpdates->AddUTXO(pUTXO);
+    // Append all outputs to the MMR at once, so parent hashes are computed a level at a time.
+    std::vector<mmr::LeafIndex> leaf_indices = m_pOutputPMMR->AddAll(output_ids);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        m_pLeafSet->Add(leaf_indices[i]);
+        m_pUpdates->AddUTXO(std::make_shared<UTXO>(header_height, std::move(leaf_indices[i]), outputs[i]));
+    }
 }
 
-UTXO CoinsViewCache::SpendUTXO(const mw::Hash& output_id)
+std::vector<UTXO> CoinsViewCache::SpendUTXOs(const std::vector<Input>& inputs)
 {
-    UTXO::CPtr pUTXO = GetUTXO(output_id);
-    if (pUTXO == nullptr || !m_pLeafSet->Contains(pUTXO->GetLeafIndex())) {
-        ThrowValidation(EConsensusError::UTXO_MISSING);
-    }
+    std::vector<mw::Hash> output_ids;
+    output_ids.reserve(inputs.size());
+    std::transform(
+        inputs.cbegin(), inputs.cend(),
+        std::back_inserter(output_ids),
+        [](const Input& input) { return input.GetOutputID(); }
+    );
 
-    m_pLeafSet->Remove(pUTXO->GetLeafIndex());
-    m_pUpdates->SpendUTXO(output_id);
+    // Look up all of the spent coins at once, rather than one at a time.
+    const std::unordered_map<mw::Hash, UTXO::CPtr> utxos = GetUTXOs(output_ids);
+
+    std::vector<UTXO> spent;
+    spent.reserve(output_ids.size());
+    for (const mw::Hash& output_id : output_ids) {
+        auto iter = utxos.find(output_id);
+        if (iter == utxos.cend() || !m_pLeafSet->Contains(iter->second->GetLeafIndex())) {
+            ThrowValidation(EConsensusError::UTXO_MISSING);
+        }
+
+        m_pLeafSet->Remove(iter->second->GetLeafIndex());
+        m_pUpdates->SpendUTXO(output_id);
+        spent.push_back(*iter->second);
+    }
 
-    return *pUTXO;
+    return spent;
 }
 
 void CoinsViewCache::WriteBatch(const std::unique_ptr<mw::DBBatch>&, const CoinsViewUpdates& updates, const mw::Header::CPtr& pHeader)
@@ -9,18 +9,45 @@
 
 using namespace mw;
 
+// Maximum number of UTXOs rewritten per batch when migrating the UTXO keys,
+// which bounds the memory used by the migration to a few MB.
+static constexpr size_t MIGRATION_BATCH_SIZE = 10'000;
+
 CoinsViewDB::Ptr CoinsViewDB::Open(
     const FilePath& datadir,
     const mw::Header::CPtr& pBestHeader,
-    const mw::DBWrapper::Ptr& pDBWrapper)
+    const mw::DBWrapper::Ptr& pDBWrapper,
+    const mmr::NodeCache::Ptr& pNodeCache)
 {
     auto current_mmr_info = MMRInfoDB(pDBWrapper.get(), nullptr).GetLatest();
+    if (current_mmr_info && current_mmr_info->version < MMRInfo::BINARY_UTXO_KEYS_VERSION) {
+        // The version is only bumped with the last batch, once no hex keys remain.
+        size_t num_migrated = 0;
+        while (true) {
+            auto pBatch = pDBWrapper->CreateBatch();
+            const size_t batch_migrated = CoinDB(pDBWrapper.get(), pBatch.get()).MigrateHexKeys(MIGRATION_BATCH_SIZE);
+            num_migrated += batch_migrated;
+
+            if (batch_migrated < MIGRATION_BATCH_SIZE) {
+                current_mmr_info->version = MMRInfo::BINARY_UTXO_KEYS_VERSION;
+                MMRInfoDB(pDBWrapper.get(), pBatch.get()).Save(*current_mmr_info);
+                pBatch->Commit();
+                break;
+            }
+
+            pBatch->Commit();
+            LOG_INFO_F("Migrated {} UTXOs to binary keys so far", num_migrated);
+        }
+
+        LOG_INFO_F("Migrated {} UTXOs to binary keys", num_migrated);
+    }
+
     uint32_t file_index = current_mmr_info ? current_mmr_info->index : 0;
     uint32_t compact_index = current_mmr_info ? current_mmr_info->compact_index : 0;
 
     auto pLeafSet = LeafSet::Open(datadir, file_index);
     auto pPruneList = PruneList::Open(datadir, compact_index);
-    auto pOutputMMR = PMMR::Open('O', datadir, file_index, pDBWrapper, pPruneList);
+    auto pOutputMMR = PMMR::Open('O', datadir, file_index, pDBWrapper, pPruneList, pNodeCache);
     auto pView = new CoinsViewDB(pBestHeader, pDBWrapper, pLeafSet, pOutputMMR);
 
     return std::shared_ptr<CoinsViewDB>(pView);
@@ -28,15 +55,7 @@ CoinsViewDB::Ptr CoinsViewDB::Open(
 
 UTXO::CPtr CoinsViewDB::GetUTXO(const mw::Hash& output_id) const
 {
-    CoinDB coinDB(GetDatabase().get(), nullptr);
-    return GetUTXO(coinDB, output_id);
-}
-
-UTXO::CPtr CoinsViewDB::GetUTXO(const CoinDB& coinDB, const mw::Hash& output_id) const
-{
-    std::vector<uint8_t> value;
-
-    auto utxos_by_hash = coinDB.GetUTXOs({output_id});
+    auto utxos_by_hash = GetUTXOs({output_id});
     auto iter = utxos_by_hash.find(output_id);
     if (iter != utxos_by_hash.cend()) {
         return iter->second;
@@ -45,6 +64,11 @@ UTXO::CPtr CoinsViewDB::GetUTXO(const CoinDB& coinDB, const mw::Hash& output_id)
     return {};
 }
 
+std::unordered_map<mw::Hash, UTXO::CPtr> CoinsViewDB::GetUTXOs(const std::vector<mw::Hash>& output_ids) const
+{
+    return CoinDB(GetDatabase().get(), nullptr).GetUTXOs(output_ids);
+}
+
 void CoinsViewDB::AddUTXO(CoinDB& coinDB, const Output& output)
 {
     mmr::LeafIndex leafIdx = m_pOutputPMMR->Add(output.GetOutputID());
@@ -58,29 +82,37 @@ void CoinsViewDB::AddUTXO(CoinDB& coinDB, const UTXO::CPtr& pUTXO)
     coinDB.AddUTXOs(std::vector<UTXO::CPtr>{ pUTXO });
 }
 
-void CoinsViewDB::SpendUTXO(CoinDB& coinDB, const mw::Hash& output_id)
-{
-    UTXO::CPtr pUTXO = GetUTXO(coinDB, output_id);
-    if (pUTXO == nullptr) {
-		ThrowValidation(EConsensusError::UTXO_MISSING);
-    }
-
-    coinDB.RemoveUTXOs(std::vector<mw::Hash>{output_id});
-}
-
 void CoinsViewDB::WriteBatch(const std::unique_ptr<mw::DBBatch>& pBatch, const CoinsViewUpdates& updates, const mw::Header::CPtr& pHeader)
 {
     assert(pBatch != nullptr);
     SetBestHeader(pHeader);
 
     CoinDB coinDB(GetDatabase().get(), pBatch.get());
+
+    // Coins whose first action is a spend must already be in the database, so look them all up at once.
+    std::vector<mw::Hash> spent_ids;
+    for (const auto& actions : updates.GetActions()) {
+        if (!actions.second.empty() && actions.second.front().IsSpend()) {
+            spent_ids.push_back(actions.first);
+        }
+    }
+
+    const std::unordered_map<mw::Hash, UTXO::CPtr> spent_utxos = coinDB.GetUTXOs(spent_ids);
+
     for (const auto& actions : updates.GetActions()) {
         const mw::Hash& output_id = actions.first;
+        bool unspent = spent_utxos.find(output_id) != spent_utxos.cend();
         for (const auto& action : actions.second) {
             if (action.IsSpend()) {
-                SpendUTXO(coinDB, output_id);
+                if (!unspent) {
+                    ThrowValidation(EConsensusError::UTXO_MISSING);
+                }
+
+                coinDB.RemoveUTXOs(std::vector<mw::Hash>{output_id});
+                unspent = false;
             } else {
                 AddUTXO(coinDB, action.pUTXO);
+                unspent = true;
             }
         }
     }
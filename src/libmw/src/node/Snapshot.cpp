@@ -0,0 +1,327 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/node/Snapshot.h>
+#include <mw/common/Logger.h>
+#include <mw/crypto/Hasher.h>
+#include <mw/db/LeafDB.h>
+#include <mw/db/MMRInfoDB.h>
+#include <mw/exceptions/DatabaseException.h>
+#include <mw/exceptions/DeserializationException.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/mmr/LeafSet.h>
+#include <mw/mmr/MMR.h>
+#include <mw/mmr/PruneList.h>
+#include <streams.h>
+#include <version.h>
+
+using namespace mw;
+
+constexpr size_t SnapshotWriter::MAX_CHUNK_SIZE;
+
+static mw::Hash ChainChunk(const mw::Hash& prev_hash, const ESnapshotSection section, const std::vector<uint8_t>& payload)
+{
+    Hasher hasher;
+    hasher << prev_hash << (uint8_t)section;
+    hasher.write((const char*)payload.data(), payload.size());
+    return hasher.hash();
+}
+
+SnapshotWriter SnapshotWriter::Capture(const FilePath& datadir, const mw::DBWrapper::Ptr& pDBWrapper, const mw::Header::CPtr& pHeader)
+{
+    assert(pDBWrapper != nullptr && pHeader != nullptr);
+
+    auto pMMRInfo = MMRInfoDB(pDBWrapper.get()).GetLatest();
+    const uint32_t file_index = pMMRInfo ? pMMRInfo->index : 0;
+    const uint32_t compact_index = pMMRInfo ? pMMRInfo->compact_index : 0;
+
+    std::vector<uint8_t> prune_list;
+    File prune_file = PruneList::GetPath(datadir, compact_index);
+    if (prune_file.Exists()) {
+        prune_list = prune_file.ReadBytes();
+    }
+
+    return SnapshotWriter(
+        pDBWrapper,
+        pHeader,
+        std::move(prune_list),
+        AppendOnlyFile::Load(PMMR::GetPath(datadir, 'O', file_index)),
+        LeafSet::Open(datadir, file_index)->ExportSnapshot(),
+        CoinDB(pDBWrapper.get()).GetCursor()
+    );
+}
+
+SnapshotInfo SnapshotWriter::Write(CAutoFile& file, const std::function<void()>& interruption_point)
+{
+    m_hash = mw::Hash();
+
+    WriteChunk(file, ESnapshotSection::HEADER, m_pHeader->Serialized());
+    WriteChunks(file, ESnapshotSection::PRUNE_LIST, m_pruneList);
+
+    // The hash file is read straight from the mapped file, a chunk at a time.
+    const uint64_t hash_file_size = m_pHashFile->GetSize();
+    uint64_t pos = 0;
+    do {
+        const uint64_t len = std::min<uint64_t>(MAX_CHUNK_SIZE, hash_file_size - pos);
+        WriteChunk(file, ESnapshotSection::OUTPUT_HASHES, m_pHashFile->Read(pos, len));
+        pos += len;
+        interruption_point();
+    } while (pos < hash_file_size);
+
+    WriteChunks(file, ESnapshotSection::LEAFSET, m_leafset);
+
+    uint64_t num_utxos = 0;
+    std::vector<uint8_t> utxos;
+    for (; m_cursor.Valid(); m_cursor.Next()) {
+        std::vector<uint8_t> serialized = m_cursor.GetUTXO()->Serialized();
+        if (utxos.size() + serialized.size() > MAX_CHUNK_SIZE) {
+            WriteChunk(file, ESnapshotSection::UTXOS, utxos);
+            utxos.clear();
+            interruption_point();
+        }
+
+        utxos.insert(utxos.end(), serialized.begin(), serialized.end());
+        ++num_utxos;
+    }
+
+    WriteChunk(file, ESnapshotSection::UTXOS, utxos);
+    WriteChunk(file, ESnapshotSection::END, {});
+
+    return SnapshotInfo{m_pHeader, m_hash, num_utxos};
+}
+
+void SnapshotWriter::WriteChunk(CAutoFile& file, const ESnapshotSection section, const std::vector<uint8_t>& payload)
+{
+    assert(payload.size() <= MAX_CHUNK_SIZE);
+
+    m_hash = ChainChunk(m_hash, section, payload);
+
+    file << (uint8_t)section;
+    WriteCompactSize(file, payload.size());
+    file.write((const char*)payload.data(), payload.size());
+    file << m_hash;
+}
+
+void SnapshotWriter::WriteChunks(CAutoFile& file, const ESnapshotSection section, const std::vector<uint8_t>& bytes)
+{
+    size_t pos = 0;
+    do {
+        const size_t len = std::min(MAX_CHUNK_SIZE, bytes.size() - pos);
+        WriteChunk(file, section, std::vector<uint8_t>(bytes.begin() + pos, bytes.begin() + pos + len));
+        pos += len;
+    } while (pos < bytes.size());
+}
+
+namespace {
+
+//
+// Reads the chunks of a snapshot in order, verifying the hash of each as it's read.
+//
+class ChunkReader
+{
+public:
+    explicit ChunkReader(CAutoFile& file) : m_file(file), m_section(ESnapshotSection::HEADER) { Next(); }
+
+    const mw::Hash& GetHash() const noexcept { return m_hash; }
+
+    //
+    // Returns the payload of the current chunk, which must be the only chunk of the given section.
+    // Unless the section is END, the next chunk is then read.
+    //
+    std::vector<uint8_t> ReadOnly(const ESnapshotSection section)
+    {
+        Expect(section);
+        std::vector<uint8_t> payload = std::move(m_payload);
+        if (section != ESnapshotSection::END) {
+            Next();
+            if (m_section == section) {
+                ThrowDeserialization_F("Snapshot section {} has more than one chunk", (int)section);
+            }
+        }
+
+        return payload;
+    }
+
+    //
+    // Calls fn with the payload of each consecutive chunk of the given section.
+    //
+    template <typename F>
+    void ForEach(const ESnapshotSection section, const F& fn)
+    {
+        Expect(section);
+        do {
+            fn(m_payload);
+            Next();
+        } while (m_section == section);
+    }
+
+private:
+    void Expect(const ESnapshotSection section) const
+    {
+        if (m_section != section) {
+            ThrowDeserialization_F("Expected snapshot section {}, but found {}", (int)section, (int)m_section);
+        }
+    }
+
+    void Next()
+    {
+        uint8_t section;
+        m_file >> section;
+        if (section > (uint8_t)ESnapshotSection::END || section < (uint8_t)m_section) {
+            ThrowDeserialization_F("Unexpected snapshot section {}", section);
+        }
+
+        const uint64_t len = ReadCompactSize(m_file);
+        if (len > SnapshotWriter::MAX_CHUNK_SIZE) {
+            ThrowDeserialization_F("Snapshot chunk of {} bytes is too large", len);
+        }
+
+        m_payload.resize(len);
+        m_file.read((char*)m_payload.data(), len);
+
+        mw::Hash chunk_hash;
+        m_file >> chunk_hash;
+
+        m_section = (ESnapshotSection)section;
+        m_hash = ChainChunk(m_hash, m_section, m_payload);
+        if (chunk_hash != m_hash) {
+            ThrowDeserialization("Snapshot chunk hash mismatch");
+        }
+    }
+
+    CAutoFile& m_file;
+    ESnapshotSection m_section;
+    std::vector<uint8_t> m_payload;
+    mw::Hash m_hash;
+};
+
+} // namespace
+
+SnapshotInfo SnapshotReader::Load(
+    CAutoFile& file,
+    const FilePath& datadir,
+    const mw::DBWrapper::Ptr& pDBWrapper,
+    const std::function<void()>& interruption_point)
+{
+    assert(pDBWrapper != nullptr);
+    if (MMRInfoDB(pDBWrapper.get()).GetLatest() != nullptr) {
+        ThrowDatabase("Can't load an MWEB snapshot into a database that already has MWEB state");
+    }
+
+    ChunkReader chunks(file);
+
+    auto pHeader = std::make_shared<mw::Header>();
+    VectorReader(SER_DISK, PROTOCOL_VERSION, chunks.ReadOnly(ESnapshotSection::HEADER), 0) >> *pHeader;
+
+    // The MMR files are written with index 0, so the next flush moves on to index 1.
+    std::vector<uint8_t> prune_list;
+    chunks.ForEach(ESnapshotSection::PRUNE_LIST, [&prune_list](const std::vector<uint8_t>& payload) {
+        prune_list.insert(prune_list.end(), payload.begin(), payload.end());
+    });
+
+    datadir.CreateDir();
+    File prune_file = PruneList::GetPath(datadir, 0);
+    if (prune_file.Exists()) {
+        prune_file.GetPath().Remove();
+    }
+
+    if (!prune_list.empty()) {
+        prune_file.Write(prune_list);
+    }
+
+    File hash_file = PMMR::GetPath(datadir, 'O', 0);
+    if (hash_file.Exists()) {
+        hash_file.GetPath().Remove();
+    }
+
+    hash_file.Create();
+    chunks.ForEach(ESnapshotSection::OUTPUT_HASHES, [&](const std::vector<uint8_t>& payload) {
+        if (payload.size() % mw::Hash::size() != 0) {
+            ThrowDeserialization("Snapshot output hashes are not a whole number of hashes");
+        }
+
+        hash_file.Write(payload);
+        interruption_point();
+    });
+
+    std::vector<uint8_t> leafset;
+    chunks.ForEach(ESnapshotSection::LEAFSET, [&leafset](const std::vector<uint8_t>& payload) {
+        leafset.insert(leafset.end(), payload.begin(), payload.end());
+    });
+
+    auto pLeafSet = LeafSet::ImportSnapshot(datadir, 0, leafset);
+    auto pPruneList = PruneList::Open(datadir, 0);
+    auto pOutputPMMR = PMMR::Open('O', datadir, 0, pDBWrapper, pPruneList);
+    if (pOutputPMMR->GetNumLeaves() != pHeader->GetNumTXOs()
+        || pOutputPMMR->Root() != pHeader->GetOutputRoot()
+        || pLeafSet->GetNextLeafIdx().Get() != pHeader->GetNumTXOs()
+        || pLeafSet->Root() != pHeader->GetLeafsetRoot()) {
+        ThrowValidation(EConsensusError::MMR_MISMATCH);
+    }
+
+    uint64_t num_utxos = 0;
+    mw::Hash prev_output_id;
+    chunks.ForEach(ESnapshotSection::UTXOS, [&](const std::vector<uint8_t>& payload) {
+        std::vector<UTXO::CPtr> utxos;
+        std::vector<mmr::Leaf> leaves;
+
+        VectorReader stream(SER_DISK, PROTOCOL_VERSION, payload, 0);
+        while (!stream.empty()) {
+            auto pUTXO = std::make_shared<UTXO>();
+            stream >> *pUTXO;
+
+            // UTXOs are written in the order of their database keys, which also rules out duplicates.
+            if (num_utxos > 0 && !(prev_output_id < pUTXO->GetOutputID())) {
+                ThrowValidation(EConsensusError::NOT_SORTED);
+            }
+
+            // Binds the UTXO to the output PMMR, which was already checked against the header.
+            const mmr::LeafIndex& leaf_idx = pUTXO->GetLeafIndex();
+            mmr::Leaf leaf = mmr::Leaf::Create(leaf_idx, pUTXO->GetOutputID().Serialized());
+            if (pUTXO->GetBlockHeight() > pHeader->GetHeight()
+                || !pLeafSet->Contains(leaf_idx)
+                || pPruneList->IsCompacted(leaf_idx.GetNodeIndex())
+                || pOutputPMMR->GetHash(leaf_idx.GetNodeIndex()) != leaf.GetHash()) {
+                ThrowValidation(EConsensusError::UTXO_MISMATCH);
+            }
+
+            prev_output_id = pUTXO->GetOutputID();
+            leaves.push_back(std::move(leaf));
+            utxos.push_back(std::move(pUTXO));
+            ++num_utxos;
+        }
+
+        if (!utxos.empty()) {
+            auto pBatch = pDBWrapper->CreateBatch();
+            CoinDB(pDBWrapper.get(), pBatch.get()).AddUTXOs(utxos);
+            LeafDB('O', pDBWrapper.get(), pBatch.get()).Add(leaves);
+            pBatch->Commit();
+        }
+
+        interruption_point();
+    });
+
+    if (!chunks.ReadOnly(ESnapshotSection::END).empty()) {
+        ThrowDeserialization("Snapshot END chunk is not empty");
+    }
+
+    // Every unspent leaf must have a UTXO. Since the UTXOs are unique and all unspent, counting them is enough.
+    if (num_utxos != pLeafSet->GetNumUnspent()) {
+        ThrowValidation(EConsensusError::UTXO_MISMATCH);
+    }
+
+    // Spent leaves aren't part of the snapshot, so blocks before the snapshot can't be disconnected.
+    auto pBatch = pDBWrapper->CreateBatch();
+    MMRInfoDB(pDBWrapper.get(), pBatch.get()).Save(MMRInfo{
+        MMRInfo::CURRENT_VERSION,
+        0,
+        pHeader->GetHash(),
+        0,
+        pHeader->GetHash()
+    });
+    pBatch->Commit();
+
+    LOG_INFO_F("Loaded MWEB snapshot at height {} with {} UTXOs", pHeader->GetHeight(), num_utxos);
+    return SnapshotInfo{pHeader, chunks.GetHash(), num_utxos};
+}
@@ -5,21 +5,99 @@
 #include <wallet/scriptpubkeyman.h>
 #include <key_io.h>
 
+#include <atomic>
+#include <thread>
+
 MW_NAMESPACE
 
+// Number of outputs each thread checks at a time.
+static constexpr size_t SCAN_CHUNK_SIZE = 64;
+
 bool Keychain::RewindOutput(const Output& output, mw::Coin& coin) const
 {
-    if (!output.HasStandardFields()) {
+    boost::optional<PublicKey> shared_secret = CheckViewTag(output);
+    if (!shared_secret) {
         return false;
     }
 
+    return RewindOutput(output, *shared_secret, coin);
+}
+
+std::vector<mw::Coin> Keychain::RewindOutputs(const std::vector<Output>& outputs, const size_t num_threads) const
+{
+    const size_t num_chunks = (outputs.size() + SCAN_CHUNK_SIZE - 1) / SCAN_CHUNK_SIZE;
+    std::vector<std::vector<mw::Coin>> chunk_coins(num_chunks);
+    std::atomic<size_t> next_chunk{0};
+
+    auto scan_chunks = [&]() {
+        std::vector<std::pair<size_t, PublicKey>> candidates;
+        candidates.reserve(SCAN_CHUNK_SIZE);
+
+        for (size_t chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+            const size_t begin = chunk * SCAN_CHUNK_SIZE;
+            const size_t end = std::min(begin + SCAN_CHUNK_SIZE, outputs.size());
+
+            // Reject by view tag first. About 1 in 256 foreign outputs gets past this.
+            // Exceptions can't cross threads, and an output whose keys don't parse can't be ours anyway.
+            candidates.clear();
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    boost::optional<PublicKey> shared_secret = CheckViewTag(outputs[i]);
+                    if (shared_secret) {
+                        candidates.emplace_back(i, std::move(*shared_secret));
+                    }
+                } catch (const std::exception&) { }
+            }
+
+            for (const auto& candidate : candidates) {
+                try {
+                    mw::Coin coin;
+                    if (RewindOutput(outputs[candidate.first], candidate.second, coin)) {
+                        chunk_coins[chunk].push_back(std::move(coin));
+                    }
+                } catch (const std::exception&) { }
+            }
+        }
+    };
+
+    // The calling thread scans too, so no threads are started for small batches.
+    std::vector<std::thread> threads;
+    const size_t num_workers = std::min(std::max<size_t>(num_threads, 1), num_chunks);
+    for (size_t i = 1; i < num_workers; i++) {
+        threads.emplace_back(scan_chunks);
+    }
+
+    scan_chunks();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<mw::Coin> coins;
+    for (std::vector<mw::Coin>& chunk : chunk_coins) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(coins));
+    }
+
+    return coins;
+}
+
+boost::optional<PublicKey> Keychain::CheckViewTag(const Output& output) const
+{
+    if (!output.HasStandardFields()) {
+        return boost::none;
+    }
+
     assert(!GetScanSecret().IsNull());
     PublicKey shared_secret = output.Ke().Mul(GetScanSecret());
     uint8_t view_tag = Hashed(EHashTag::TAG, shared_secret)[0];
     if (view_tag != output.GetViewTag()) {
-        return false;
+        return boost::none;
     }
 
+    return boost::make_optional(std::move(shared_secret));
+}
+
+bool Keychain::RewindOutput(const Output& output, const PublicKey& shared_secret, mw::Coin& coin) const
+{
     SecretKey t = Hashed(EHashTag::DERIVE, shared_secret);
     PublicKey B_i = output.Ko().Div(Hashed(EHashTag::OUT_KEY, t));
 
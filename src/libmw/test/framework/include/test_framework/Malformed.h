@@ -0,0 +1,59 @@
+#pragma once
+
+#include <mw/common/Macros.h>
+#include <mw/models/crypto/Commitment.h>
+#include <mw/models/tx/TxBody.h>
+
+TEST_NAMESPACE
+
+//
+// Builds tx bodies whose points can't be parsed, for testing that they're rejected without crashing.
+//
+
+// A commitment must start with 0x08 or 0x09, so one of all zeros is never a valid point.
+inline Commitment MalformedCommitment()
+{
+    return Commitment(std::array<uint8_t, Commitment::SIZE>{});
+}
+
+// Returns a copy of the body whose first kernel has a malformed excess.
+inline TxBody WithMalformedKernelExcess(const TxBody& body)
+{
+    const Kernel& kernel = body.GetKernels().front();
+    const uint8_t features = kernel.GetFeatures();
+
+    std::vector<Kernel> kernels = body.GetKernels();
+    kernels.front() = Kernel(
+        features,
+        (features & Kernel::FEE_FEATURE_BIT) ? boost::make_optional(kernel.GetFee()) : boost::none,
+        kernel.HasPegIn() ? boost::make_optional(kernel.GetPegIn()) : boost::none,
+        kernel.GetPegOuts(),
+        (features & Kernel::HEIGHT_LOCK_FEATURE_BIT) ? boost::make_optional(kernel.GetLockHeight()) : boost::none,
+        kernel.HasStealthExcess() ? boost::make_optional(kernel.GetStealthExcess()) : boost::none,
+        kernel.GetExtraData(),
+        MalformedCommitment(),
+        kernel.GetSignature()
+    );
+
+    return TxBody(body.GetInputs(), body.GetOutputs(), std::move(kernels));
+}
+
+// Returns a copy of the body whose first output has a malformed commitment.
+inline TxBody WithMalformedOutputCommitment(const TxBody& body)
+{
+    const Output& output = body.GetOutputs().front();
+
+    std::vector<Output> outputs = body.GetOutputs();
+    outputs.front() = Output(
+        MalformedCommitment(),
+        output.GetSenderPubKey(),
+        output.GetReceiverPubKey(),
+        output.GetOutputMessage(),
+        output.GetRangeProof(),
+        output.GetSignature()
+    );
+
+    return TxBody(body.GetInputs(), std::move(outputs), body.GetKernels());
+}
+
+END_NAMESPACE
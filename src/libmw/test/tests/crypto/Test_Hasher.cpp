@@ -0,0 +1,33 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/crypto/Hasher.h>
+#include <random.h>
+
+#include <test_framework/TestMWEB.h>
+
+BOOST_FIXTURE_TEST_SUITE(TestHasher, MWEBTestingSetup)
+
+BOOST_AUTO_TEST_CASE(HashedManyTest)
+{
+    // Cover inputs shorter than, equal to, and spanning multiple BLAKE3 blocks,
+    // and enough inputs to fill the widest SIMD backend more than once.
+    for (const size_t input_len : {1, 32, 64, 65, 72, 128, 1000, 1024}) {
+        const size_t num_inputs = 37;
+        FastRandomContext rng;
+        std::vector<uint8_t> serialized = rng.randbytes(input_len * num_inputs);
+
+        std::vector<mw::Hash> hashes = HashedMany(serialized, input_len);
+        BOOST_REQUIRE(hashes.size() == num_inputs);
+
+        for (size_t i = 0; i < num_inputs; i++) {
+            std::vector<uint8_t> input(serialized.begin() + (i * input_len), serialized.begin() + ((i + 1) * input_len));
+            BOOST_REQUIRE(hashes[i] == Hashed(input));
+        }
+    }
+
+    BOOST_REQUIRE(HashedMany({}, 72).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,9 @@
 
 #include <test_framework/TestMWEB.h>
 
+#include <atomic>
+#include <thread>
+
 BOOST_FIXTURE_TEST_SUITE(TestRangeProofs, MWEBTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RangeProofs)
@@ -46,6 +49,48 @@ BOOST_AUTO_TEST_CASE(RangeProofs)
     std::vector<ProofData> rangeProofs;
     rangeProofs.push_back(ProofData{ commit, pRangeProof, extraData });
     BOOST_REQUIRE(Bulletproofs::BatchVerify(rangeProofs));
+
+    // The proof is now cached, but a cache hit must still require the extra data to match.
+    std::vector<uint8_t> extraData2 = secret_key_t<100>::Random().vec();
+    BOOST_REQUIRE(!Bulletproofs::BatchVerify({ ProofData{ commit, pRangeProof, extraData2 } }));
+    BOOST_REQUIRE(Bulletproofs::BatchVerify(rangeProofs));
+}
+
+BOOST_AUTO_TEST_CASE(RangeProofsParallel)
+{
+    std::vector<ProofData> proofs;
+    for (uint64_t value = 0; value < 8; value++) {
+        BlindingFactor blind = BlindingFactor::Random();
+        std::vector<uint8_t> extraData = secret_key_t<32>::Random().vec();
+        RangeProof::CPtr pRangeProof = Bulletproofs::Generate(
+            value,
+            SecretKey(blind.vec()),
+            SecretKey::Random(),
+            SecretKey::Random(),
+            ProofMessage(secret_key_t<20>::Random().GetBigInt()),
+            extraData
+        );
+        proofs.push_back(ProofData{ Commitment::Blinded(blind, value), pRangeProof, extraData });
+    }
+
+    // Each thread verifies (and caches) its own proofs using its own scratch space.
+    std::atomic<size_t> num_valid{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&proofs, &num_valid, t]() {
+            std::vector<ProofData> thread_proofs{ proofs[2 * t], proofs[2 * t + 1] };
+            if (Bulletproofs::BatchVerify(thread_proofs)) {
+                num_valid++;
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    BOOST_REQUIRE(num_valid == 4);
+    BOOST_REQUIRE(Bulletproofs::BatchVerify(proofs));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
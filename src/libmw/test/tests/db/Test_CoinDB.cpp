@@ -0,0 +1,138 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/db/CoinDB.h>
+
+#include <test_framework/TestMWEB.h>
+#include <test_framework/TxBuilder.h>
+
+BOOST_FIXTURE_TEST_SUITE(TestCoinDB, MWEBTestingSetup)
+
+BOOST_AUTO_TEST_CASE(CoinDBTest)
+{
+    auto pDatabase = GetDB();
+
+    test::Tx tx = test::TxBuilder()
+        .AddInput(20'000'000).AddOutput(5'000'000).AddOutput(10'000'000)
+        .AddPlainKernel(5'000'000)
+        .Build();
+    auto pUTXO1 = std::make_shared<UTXO>(100, mmr::LeafIndex::At(0), tx.GetOutputs()[0].GetOutput());
+    auto pUTXO2 = std::make_shared<UTXO>(101, mmr::LeafIndex::At(1), tx.GetOutputs()[1].GetOutput());
+
+    CoinDB(pDatabase.get(), nullptr).AddUTXOs({pUTXO1, pUTXO2});
+
+    // UTXOs are keyed by the raw output ID
+    std::vector<uint8_t> data;
+    const mw::Hash& output_id1 = pUTXO1->GetOutputID();
+    BOOST_REQUIRE(pDatabase->Read("U" + std::string(output_id1.data(), output_id1.data() + 32), data));
+
+    mw::Hash missing_id = mw::Hash::FromHex("0000000000000000000000000000000000000000000000000000000000000001");
+    auto utxos = CoinDB(pDatabase.get(), nullptr).GetUTXOs({pUTXO2->GetOutputID(), missing_id, pUTXO1->GetOutputID()});
+    BOOST_REQUIRE(utxos.size() == 2);
+    BOOST_REQUIRE(utxos.at(pUTXO1->GetOutputID())->Serialized() == pUTXO1->Serialized());
+    BOOST_REQUIRE(utxos.at(pUTXO2->GetOutputID())->Serialized() == pUTXO2->Serialized());
+
+    CoinDB(pDatabase.get(), nullptr).RemoveUTXOs({pUTXO1->GetOutputID()});
+    utxos = CoinDB(pDatabase.get(), nullptr).GetUTXOs({pUTXO1->GetOutputID(), pUTXO2->GetOutputID()});
+    BOOST_REQUIRE(utxos.size() == 1);
+    BOOST_REQUIRE(utxos.count(pUTXO2->GetOutputID()) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(MigrateHexKeys)
+{
+    auto pDatabase = GetDB();
+
+    test::Tx tx = test::TxBuilder()
+        .AddInput(20'000'000).AddOutput(5'000'000).AddOutput(10'000'000)
+        .AddPlainKernel(5'000'000)
+        .Build();
+    auto pUTXO1 = std::make_shared<UTXO>(100, mmr::LeafIndex::At(0), tx.GetOutputs()[0].GetOutput());
+    auto pUTXO2 = std::make_shared<UTXO>(101, mmr::LeafIndex::At(1), tx.GetOutputs()[1].GetOutput());
+
+    // Write the UTXOs using the legacy hex keys
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        pBatch->Write("U" + pUTXO1->GetOutputID().ToHex(), pUTXO1->Serialized());
+        pBatch->Write("U" + pUTXO2->GetOutputID().ToHex(), pUTXO2->Serialized());
+        pBatch->Commit();
+    }
+    BOOST_REQUIRE(CoinDB(pDatabase.get(), nullptr).GetUTXOs({pUTXO1->GetOutputID()}).empty());
+
+    // Each call migrates at most max_utxos, and its batch can be committed on its own
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        BOOST_REQUIRE(CoinDB(pDatabase.get(), pBatch.get()).MigrateHexKeys(1) == 1);
+        pBatch->Commit();
+    }
+    BOOST_REQUIRE(CoinDB(pDatabase.get(), nullptr).GetUTXOs({pUTXO1->GetOutputID(), pUTXO2->GetOutputID()}).size() == 1);
+
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        BOOST_REQUIRE(CoinDB(pDatabase.get(), pBatch.get()).MigrateHexKeys(1) == 1);
+        pBatch->Commit();
+    }
+
+    std::vector<uint8_t> data;
+    BOOST_REQUIRE(!pDatabase->Read("U" + pUTXO1->GetOutputID().ToHex(), data));
+    BOOST_REQUIRE(!pDatabase->Read("U" + pUTXO2->GetOutputID().ToHex(), data));
+
+    auto utxos = CoinDB(pDatabase.get(), nullptr).GetUTXOs({pUTXO1->GetOutputID(), pUTXO2->GetOutputID()});
+    BOOST_REQUIRE(utxos.size() == 2);
+    BOOST_REQUIRE(utxos.at(pUTXO1->GetOutputID())->Serialized() == pUTXO1->Serialized());
+    BOOST_REQUIRE(utxos.at(pUTXO2->GetOutputID())->Serialized() == pUTXO2->Serialized());
+
+    // Migrating again is a no-op
+    BOOST_REQUIRE(CoinDB(pDatabase.get(), nullptr).MigrateHexKeys(10) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(MultiRead)
+{
+    auto pDatabase = GetDB();
+
+    // Keys of different lengths and gaps, so reads mix stepping forward with seeking
+    std::vector<std::string> keys;
+    {
+        auto pBatch = pDatabase->CreateBatch();
+        for (size_t i = 0; i < 100; i++) {
+            std::string key = "Z" + std::to_string(i * 7);
+            if ((i % 3 != 0 && i < 40) || i % 25 == 0) {
+                pBatch->Write(key, std::vector<uint8_t>{(uint8_t)i});
+            }
+
+            keys.push_back(key);
+        }
+        pBatch->Commit();
+    }
+    keys.push_back(keys[1]);
+    keys.push_back("Z");
+    std::reverse(keys.begin(), keys.end());
+
+    auto values = pDatabase->MultiRead(keys);
+    BOOST_REQUIRE(values.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        std::vector<uint8_t> expected;
+        BOOST_REQUIRE(pDatabase->Read(keys[i], expected) == (bool)values[i]);
+        if (values[i]) {
+            BOOST_REQUIRE(*values[i] == expected);
+        }
+    }
+
+    // UTXOs added to a batch are returned before it's committed
+    test::Tx tx = test::TxBuilder()
+        .AddInput(20'000'000).AddOutput(5'000'000).AddOutput(10'000'000)
+        .AddPlainKernel(5'000'000)
+        .Build();
+    auto pUTXO1 = std::make_shared<UTXO>(100, mmr::LeafIndex::At(0), tx.GetOutputs()[0].GetOutput());
+    auto pUTXO2 = std::make_shared<UTXO>(101, mmr::LeafIndex::At(1), tx.GetOutputs()[1].GetOutput());
+    CoinDB(pDatabase.get(), nullptr).AddUTXOs({pUTXO1});
+
+    auto pBatch = pDatabase->CreateBatch();
+    CoinDB coinDB(pDatabase.get(), pBatch.get());
+    coinDB.AddUTXOs({pUTXO2});
+    auto utxos = coinDB.GetUTXOs({pUTXO1->GetOutputID(), pUTXO2->GetOutputID()});
+    BOOST_REQUIRE(utxos.size() == 2);
+    BOOST_REQUIRE(utxos.at(pUTXO2->GetOutputID())->Serialized() == pUTXO2->Serialized());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
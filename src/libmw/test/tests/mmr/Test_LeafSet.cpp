@@ -6,6 +6,7 @@
 #include <mw/crypto/Hasher.h>
 
 #include <test_framework/TestMWEB.h>
+#include <random.h>
 
 BOOST_FIXTURE_TEST_SUITE(TestMMRLeafSet, MWEBTestingSetup)
 
@@ -58,4 +59,158 @@ BOOST_AUTO_TEST_CASE(LeafSetTest)
     }
 }
 
+// Spans multiple containers, with a dense run, sparse leaves, and random leaves.
+static std::vector<uint8_t> BuildLeafSet(ILeafSet& leafset, const uint64_t num_leaves)
+{
+    FastRandomContext rng(true);
+
+    std::vector<uint8_t> bytes((num_leaves + 7) / 8);
+    for (uint64_t i = 0; i < num_leaves; i++) {
+        const bool unspent = (i < 70'000) || (i % 997 == 0) || (i >= 140'000 && rng.randbool());
+        if (unspent) {
+            leafset.Add(mmr::LeafIndex::At(i));
+            bytes[i / 8] |= (0x80 >> (i % 8));
+        } else {
+            leafset.Add(mmr::LeafIndex::At(i));
+            leafset.Remove(mmr::LeafIndex::At(i));
+        }
+    }
+
+    return bytes;
+}
+
+BOOST_AUTO_TEST_CASE(LargeLeafSetRoot)
+{
+    const uint64_t num_leaves = 200'000;
+    LeafSet::Ptr pLeafset = LeafSet::Open(GetDataDir(), 0);
+    std::vector<uint8_t> bytes = BuildLeafSet(*pLeafset, num_leaves);
+    BOOST_REQUIRE(pLeafset->GetNextLeafIdx().Get() == num_leaves);
+    BOOST_REQUIRE(pLeafset->GetNumContainers() == 4);
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+
+    // Only the chunks touched by a removal should need rehashing.
+    for (uint64_t i : { 5ull, 69'999ull, 150'001ull }) {
+        pLeafset->Remove(mmr::LeafIndex::At(i));
+        bytes[i / 8] &= ~(0x80 >> (i % 8));
+    }
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+
+    // Changes made through a cache produce the same root as the flat bytes.
+    LeafSetCache::Ptr pCache = std::make_shared<LeafSetCache>(pLeafset);
+    pCache->Remove(mmr::LeafIndex::At(140'000 + 8 * 1024 * 3));
+    bytes[(140'000 + 8 * 1024 * 3) / 8] &= ~(0x80 >> ((140'000 + 8 * 1024 * 3) % 8));
+    pCache->Add(mmr::LeafIndex::At(num_leaves));
+    bytes.push_back(0x80);
+    BOOST_REQUIRE(pCache->Root() == Hashed(bytes));
+
+    pCache->Flush(1);
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+
+    // Rewind into the second container, dropping the others.
+    const uint64_t rewind_to = 70'001;
+    pLeafset->Rewind(rewind_to, { mmr::LeafIndex::At(5) });
+    pLeafset->ApplyUpdates(2, pLeafset->GetNextLeafIdx(), {});
+    bytes.resize((rewind_to + 7) / 8);
+    bytes[5 / 8] |= (0x80 >> (5 % 8));
+    bytes.back() &= (uint8_t)(0xFF << (8 - (rewind_to % 8)));
+    BOOST_REQUIRE(pLeafset->GetNumContainers() == 2);
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+
+    LeafSet::Ptr pReloaded = LeafSet::Open(GetDataDir(), 2);
+    BOOST_REQUIRE(pReloaded->GetNextLeafIdx().Get() == rewind_to);
+    BOOST_REQUIRE(pReloaded->Root() == Hashed(bytes));
+}
+
+BOOST_AUTO_TEST_CASE(LegacyLeafSetMigration)
+{
+    const uint64_t num_leaves = 100'000;
+    std::vector<uint8_t> bytes;
+    {
+        LeafSet::Ptr pLeafset = LeafSet::Open(GetDataDir(), 0);
+        bytes = BuildLeafSet(*pLeafset, num_leaves);
+    }
+
+    FilePath legacy_path = FilePath(GetDataDir()).GetChild("leaf000003.dat");
+    std::vector<uint8_t> legacy_file = mmr::LeafIndex::At(num_leaves).Serialized();
+    legacy_file.insert(legacy_file.end(), bytes.begin(), bytes.end());
+    File(legacy_path).Write(legacy_file);
+
+    LeafSet::Ptr pLeafset = LeafSet::Open(GetDataDir(), 3);
+    BOOST_REQUIRE(pLeafset->GetNextLeafIdx().Get() == num_leaves);
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+    BOOST_REQUIRE(!legacy_path.Exists());
+    BOOST_REQUIRE(LeafSet::GetPath(GetDataDir(), 3).Exists());
+    BOOST_REQUIRE(File(LeafSet::GetPath(GetDataDir(), 3)).GetSize() < legacy_file.size());
+
+    // Opening again reads the migrated file.
+    pLeafset = LeafSet::Open(GetDataDir(), 3);
+    BOOST_REQUIRE(pLeafset->Root() == Hashed(bytes));
+}
+
+BOOST_AUTO_TEST_CASE(LeafSetSnapshot)
+{
+    LeafSet::Ptr pLeafset = LeafSet::Open(GetDataDir(), 0);
+    std::vector<uint8_t> bytes = BuildLeafSet(*pLeafset, 150'000);
+
+    std::vector<uint8_t> snapshot = pLeafset->ExportSnapshot();
+    BOOST_REQUIRE(snapshot.size() < bytes.size());
+
+    LeafSet::Ptr pImported = LeafSet::ImportSnapshot(GetDataDir(), 4, snapshot);
+    BOOST_REQUIRE(pImported->GetNextLeafIdx() == pLeafset->GetNextLeafIdx());
+    BOOST_REQUIRE(pImported->Root() == Hashed(bytes));
+    BOOST_REQUIRE(LeafSet::Open(GetDataDir(), 4)->Root() == Hashed(bytes));
+
+    // Unknown versions are rejected.
+    BOOST_CHECK_THROW(LeafSet::ImportSnapshot(GetDataDir(), 5, { 0x02 }), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(LeafSetContainerEncodings)
+{
+    auto round_trip = [](const mmr::LeafSetContainer& container) {
+        std::vector<uint8_t> serialized;
+        CVectorWriter writer(SER_DISK, PROTOCOL_VERSION, serialized, 0);
+        writer << container;
+
+        mmr::LeafSetContainer deserialized;
+        VectorReader reader(SER_DISK, PROTOCOL_VERSION, serialized, 0);
+        reader >> deserialized;
+        BOOST_REQUIRE(reader.empty());
+
+        for (uint32_t pos = 0; pos < mmr::LeafSetContainer::NUM_LEAVES; pos++) {
+            BOOST_REQUIRE(deserialized.Contains((uint16_t)pos) == container.Contains((uint16_t)pos));
+        }
+        return serialized;
+    };
+
+    // Long runs serialize as runs.
+    mmr::LeafSetContainer runs;
+    for (uint32_t pos = 100; pos < 60'000; pos++) {
+        runs.Set((uint16_t)pos, true);
+    }
+    BOOST_REQUIRE(runs.IsBitmap());
+    BOOST_REQUIRE(round_trip(runs).size() < 16);
+
+    // A few scattered positions serialize as an array.
+    mmr::LeafSetContainer array;
+    for (uint32_t pos = 0; pos < mmr::LeafSetContainer::NUM_LEAVES; pos += 1000) {
+        array.Set((uint16_t)pos, true);
+    }
+    BOOST_REQUIRE(!array.IsBitmap());
+    BOOST_REQUIRE(round_trip(array).size() == 2 + array.GetCardinality() * 2);
+
+    // Alternating positions serialize as a bitmap.
+    mmr::LeafSetContainer bitmap;
+    for (uint32_t pos = 0; pos < mmr::LeafSetContainer::NUM_LEAVES; pos += 2) {
+        bitmap.Set((uint16_t)pos, true);
+    }
+    BOOST_REQUIRE(bitmap.IsBitmap());
+    BOOST_REQUIRE(round_trip(bitmap).size() == 1 + mmr::LeafSetContainer::NUM_BYTES);
+
+    // Clearing most positions converts back to an array.
+    bitmap.Truncate(1000);
+    BOOST_REQUIRE(!bitmap.IsBitmap());
+    BOOST_REQUIRE(bitmap.GetCardinality() == 500);
+    round_trip(bitmap);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -52,6 +52,107 @@ BOOST_AUTO_TEST_CASE(MMRTest)
     BOOST_CHECK_EQUAL(pmmr->Root().ToHex(), "9ab6e3c4a8594b9846b39b6beefe8f704c1de720f28426ddf3898bd4f8d6e45f");
 }
 
+BOOST_AUTO_TEST_CASE(GetHashesTest)
+{
+    auto pmmr = PMMR::Open(
+        'O',
+        GetDataDir() / "mmr",
+        0,
+        GetDB(),
+        nullptr
+    );
+
+    for (uint8_t i = 0; i < 4; i++) {
+        pmmr->Add({ i, uint8_t(i + 1), uint8_t(i + 2) });
+    }
+
+    // Commit the first 4 leaves (7 nodes) to the mapped file, and leave the 5th in the pending buffer.
+    auto pBatch = GetDB()->CreateBatch();
+    pmmr->BatchWrite(1, LeafIndex::At(4), {}, pBatch);
+    pmmr->Add({ 4, 5, 6 });
+
+    // Read a range spanning both the mapped file and the pending buffer.
+    std::vector<mw::Hash> hashes = pmmr->GetHashes(Index::At(2), 6);
+    BOOST_REQUIRE(hashes.size() == 6);
+    for (uint64_t i = 0; i < hashes.size(); i++) {
+        BOOST_REQUIRE(hashes[i] == pmmr->GetHash(Index::At(2 + i)));
+    }
+
+    BOOST_REQUIRE(pmmr->GetHashes(Index::At(0), 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(NodeCacheTest)
+{
+    auto pNodeCache = std::make_shared<NodeCache>(4 * NodeCache::ENTRY_SIZE);
+    auto pmmr = PMMR::Open('O', GetDataDir() / "mmr", 0, GetDB(), nullptr);
+    auto cached_pmmr = PMMR::Open('O', GetDataDir() / "mmr_cached", 0, GetDB(), nullptr, pNodeCache);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        pmmr->Add({ i, uint8_t(i + 1), uint8_t(i + 2) });
+        cached_pmmr->Add({ i, uint8_t(i + 1), uint8_t(i + 2) });
+        BOOST_REQUIRE(cached_pmmr->Root() == pmmr->Root());
+    }
+    BOOST_CHECK_EQUAL(cached_pmmr->Root().ToHex(), "376ef1612abbb461ab78f317569c9a19d054f2c928c79410d50403564b91c5f7");
+
+    NodeCache::Stats stats = pNodeCache->GetStats();
+    BOOST_CHECK(stats.hits > 0);
+    BOOST_CHECK(stats.evictions > 0);
+    BOOST_CHECK_EQUAL(stats.max_entries, 4U);
+    BOOST_CHECK(stats.num_entries <= stats.max_entries);
+
+    // Rewinding must drop the cached nodes, so that new leaves aren't hashed with stale parents.
+    pmmr->Rewind(3);
+    cached_pmmr->Rewind(3);
+    BOOST_REQUIRE(cached_pmmr->GetNumLeaves() == 3);
+    pmmr->Add({ 9, 9, 9 });
+    cached_pmmr->Add({ 9, 9, 9 });
+    BOOST_REQUIRE(cached_pmmr->Root() == pmmr->Root());
+    for (uint64_t pos = 0; pos < pmmr->GetNumNodes(); pos++) {
+        BOOST_REQUIRE(cached_pmmr->GetHash(Index::At(pos)) == pmmr->GetHash(Index::At(pos)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AddLeavesTest)
+{
+    auto make_leaves = [](const uint64_t first, const uint64_t count) {
+        std::vector<Leaf> leaves;
+        for (uint64_t i = first; i < first + count; i++) {
+            leaves.push_back(Leaf::Create(LeafIndex::At(i), { uint8_t(i), uint8_t(i >> 8), 7 }));
+        }
+        return leaves;
+    };
+
+    // Append batches of different sizes on top of MMRs of different sizes,
+    // so batches start both on and off peak boundaries.
+    for (uint64_t existing : { 0, 1, 3, 6, 8, 13 }) {
+        for (uint64_t count : { 1, 2, 5, 16, 37 }) {
+            MemMMR expected;
+            for (const Leaf& leaf : make_leaves(0, existing + count)) {
+                expected.AddLeaf(leaf);
+            }
+
+            MemMMR mem_mmr;
+            mem_mmr.AddLeaves(make_leaves(0, existing));
+            mem_mmr.AddLeaves(make_leaves(existing, count));
+            BOOST_REQUIRE(mem_mmr.GetNumLeaves() == existing + count);
+            BOOST_REQUIRE(mem_mmr.Root() == expected.Root());
+
+            auto pmmr = PMMR::Open('O', GetDataDir() / "mmr" / std::to_string(existing) / std::to_string(count), 0, GetDB(), nullptr);
+            pmmr->AddLeaves(make_leaves(0, existing));
+            PMMRCache cache(pmmr);
+            cache.AddLeaves(make_leaves(existing, count));
+            BOOST_REQUIRE(cache.Root() == expected.Root());
+            for (uint64_t pos = 0; pos < LeafIndex::At(existing + count).GetPosition(); pos++) {
+                BOOST_REQUIRE(cache.GetHash(Index::At(pos)) == expected.GetHash(Index::At(pos)));
+            }
+
+            pmmr->AddLeaves(make_leaves(existing, count));
+            BOOST_REQUIRE(pmmr->Root() == expected.Root());
+            BOOST_REQUIRE(pmmr->GetLeaf(LeafIndex::At(existing)) == expected.GetLeaf(LeafIndex::At(existing)));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(PMMRCacheTest)
 {
     PMMR::Ptr pmmr = PMMR::Open(
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <mw/mmr/MMRUtil.h>
+#include <mw/models/crypto/SecretKey.h>
 #include <unordered_set>
 
 #include <test_framework/TestMWEB.h>
@@ -151,4 +152,21 @@ BOOST_AUTO_TEST_CASE(CalcPrunedParents)
     BOOST_REQUIRE(pruned_parent_hashes.str() == "0010100000000101000010000000100000000000000001001000000100000000000000000000000000000000000000000000");
 }
 
+BOOST_AUTO_TEST_CASE(CalcParentHashes)
+{
+    std::vector<mmr::Index> indices;
+    std::vector<mw::Hash> child_hashes;
+    for (uint64_t i = 0; i < 20; i++) {
+        indices.push_back(mmr::Index::At(i * 3 + 2));
+        child_hashes.push_back(SecretKey::Random().GetBigInt());
+        child_hashes.push_back(SecretKey::Random().GetBigInt());
+    }
+
+    std::vector<mw::Hash> parent_hashes = MMRUtil::CalcParentHashes(indices, child_hashes);
+    BOOST_REQUIRE(parent_hashes.size() == indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        BOOST_REQUIRE(parent_hashes[i] == MMRUtil::CalcParentHash(indices[i], child_hashes[i * 2], child_hashes[i * 2 + 1]));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
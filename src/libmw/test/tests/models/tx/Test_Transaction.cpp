@@ -5,6 +5,7 @@
 #include <mw/consensus/KernelSumValidator.h>
 
 #include <test_framework/Deserializer.h>
+#include <test_framework/Malformed.h>
 #include <test_framework/TestMWEB.h>
 #include <test_framework/TxBuilder.h>
 
@@ -46,4 +47,77 @@ BOOST_AUTO_TEST_CASE(TxTransaction)
     }
 }
 
+BOOST_AUTO_TEST_CASE(TxBatchVerify)
+{
+    auto build_tx = []() -> mw::Transaction::CPtr {
+        return test::TxBuilder()
+            .AddInput(20).AddInput(30)
+            .AddOutput(45)
+            .AddPlainKernel(5)
+            .Build().GetTransaction();
+    };
+
+    std::vector<mw::Transaction::CPtr> txs{ build_tx(), build_tx(), build_tx() };
+    BOOST_REQUIRE(mw::Transaction::BatchVerify(txs));
+    for (const mw::Transaction::CPtr& tx : txs) {
+        BOOST_REQUIRE_NO_THROW(tx->Validate());
+    }
+
+    // Give an output the range proof of another transaction's output.
+    mw::Transaction::CPtr valid_tx = build_tx();
+    mw::Transaction::CPtr tx = build_tx();
+    const Output& output = tx->GetOutputs().front();
+    Output bad_output(
+        output.GetCommitment(),
+        output.GetSenderPubKey(),
+        output.GetReceiverPubKey(),
+        output.GetOutputMessage(),
+        valid_tx->GetOutputs().front().GetRangeProof(),
+        output.GetSignature()
+    );
+    mw::Transaction::CPtr bad_tx = mw::Transaction::Create(
+        tx->GetKernelOffset(),
+        tx->GetStealthOffset(),
+        tx->GetInputs(),
+        std::vector<Output>{ bad_output },
+        tx->GetKernels()
+    );
+
+    // The batch fails, but each transaction can still be verified on its own.
+    BOOST_REQUIRE(!mw::Transaction::BatchVerify({ valid_tx, bad_tx }));
+    BOOST_REQUIRE_NO_THROW(valid_tx->Validate());
+    BOOST_REQUIRE_THROW(bad_tx->Validate(), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(TxBatchVerifyMalformedPoints)
+{
+    mw::Transaction::CPtr tx = test::TxBuilder()
+        .AddInput(20).AddInput(30)
+        .AddOutput(45)
+        .AddPlainKernel(5)
+        .Build().GetTransaction();
+
+    auto with_body = [&tx](const TxBody& body) -> mw::Transaction::CPtr {
+        return mw::Transaction::Create(
+            tx->GetKernelOffset(),
+            tx->GetStealthOffset(),
+            body.GetInputs(),
+            body.GetOutputs(),
+            body.GetKernels()
+        );
+    };
+
+    // Points that can't be parsed make the batch throw, rather than terminate.
+    mw::Transaction::CPtr bad_kernel_tx = with_body(test::WithMalformedKernelExcess(tx->GetBody()));
+    BOOST_CHECK_THROW(mw::Transaction::BatchVerify({ tx, bad_kernel_tx }), std::exception);
+    BOOST_CHECK_THROW(bad_kernel_tx->Validate(), std::exception);
+
+    // The output's signature commits to its commitment, so it fails before the range proofs parse it.
+    mw::Transaction::CPtr bad_output_tx = with_body(test::WithMalformedOutputCommitment(tx->GetBody()));
+    BOOST_CHECK(!mw::Transaction::BatchVerify({ tx, bad_output_tx }));
+    BOOST_CHECK_THROW(bad_output_tx->Validate(), std::exception);
+
+    BOOST_CHECK_NO_THROW(tx->Validate());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <mw/node/BlockValidator.h>
 
+#include <test_framework/Malformed.h>
 #include <test_framework/Miner.h>
 #include <test_framework/TestMWEB.h>
 #include <test_framework/TxBuilder.h>
@@ -55,6 +56,70 @@ BOOST_AUTO_TEST_CASE(BlockValidator_Test_ValidBlock)
     BOOST_CHECK(is_valid);
 }
 
+BOOST_AUTO_TEST_CASE(BlockValidator_Test_SkipCrypto)
+{
+    test::Miner miner(GetDataDir());
+
+    test::Tx pegin_tx = test::Tx::CreatePegIn(5'000'000);
+    test::Tx pegout_tx = test::Tx::CreatePegOut(pegin_tx.GetOutputs().front());
+    mw::Block::CPtr pBlock = miner.MineBlock(1, { pegin_tx, pegout_tx }).GetBlock();
+
+    // Signatures and range proofs can be verified separately from the rest of the block
+    const TxBody& body = pBlock->GetTxBody();
+    std::vector<SignedMessage> signatures = body.BuildSignedMsgs();
+    BOOST_CHECK_EQUAL(signatures.size(), body.GetKernels().size() + body.GetInputs().size() + body.GetOutputs().size());
+    BOOST_CHECK(Schnorr::BatchVerify(signatures));
+
+    std::vector<ProofData> proofs = body.BuildProofData();
+    BOOST_CHECK_EQUAL(proofs.size(), body.GetOutputs().size());
+    BOOST_CHECK(Bulletproofs::BatchVerify(proofs));
+
+    bool is_valid = BlockValidator::ValidateBlock(
+        pBlock,
+        std::vector<PegInCoin>{pegin_tx.GetPegInCoin()},
+        std::vector<PegOutCoin>{pegout_tx.GetPegOutCoin()},
+        /* verify_crypto */ false
+    );
+    BOOST_CHECK(is_valid);
+
+    // Non-crypto checks still run
+    is_valid = BlockValidator::ValidateBlock(
+        pBlock,
+        std::vector<PegInCoin>{},
+        std::vector<PegOutCoin>{pegout_tx.GetPegOutCoin()},
+        /* verify_crypto */ false
+    );
+    BOOST_CHECK(!is_valid);
+}
+
+BOOST_AUTO_TEST_CASE(BlockValidator_Test_MalformedPoints)
+{
+    test::Miner miner(GetDataDir());
+
+    test::Tx pegin_tx = test::Tx::CreatePegIn(5'000'000);
+    mw::Block::CPtr pBlock = miner.MineBlock(1, { pegin_tx }).GetBlock();
+    const std::vector<PegInCoin> pegins{pegin_tx.GetPegInCoin()};
+
+    // A kernel excess that isn't a valid point can't be turned into a signed message.
+    TxBody bad_kernel_body = test::WithMalformedKernelExcess(pBlock->GetTxBody());
+    BOOST_CHECK_THROW(bad_kernel_body.BuildSignedMsgs(), std::exception);
+
+    auto pBadKernelBlock = std::make_shared<const mw::Block>(pBlock->GetHeader(), bad_kernel_body);
+    BOOST_CHECK(!BlockValidator::ValidateBlock(pBadKernelBlock, pegins, {}));
+    BOOST_CHECK(!BlockValidator::ValidateBlock(pBadKernelBlock, pegins, {}, /* verify_crypto */ false));
+
+    // An output commitment that isn't a valid point makes range proof verification throw.
+    TxBody bad_output_body = test::WithMalformedOutputCommitment(pBlock->GetTxBody());
+    BOOST_CHECK_NO_THROW(bad_output_body.BuildSignedMsgs());
+    std::vector<ProofData> proofs = bad_output_body.BuildProofData();
+    BOOST_CHECK_THROW(Bulletproofs::BatchVerify(proofs), std::exception);
+
+    // Output commitments are only parsed by the crypto checks, which are left to the caller when verify_crypto is false.
+    auto pBadOutputBlock = std::make_shared<const mw::Block>(pBlock->GetHeader(), bad_output_body);
+    BOOST_CHECK(!BlockValidator::ValidateBlock(pBadOutputBlock, pegins, {}));
+    BOOST_CHECK(BlockValidator::ValidateBlock(pBadOutputBlock, pegins, {}, /* verify_crypto */ false));
+}
+
 BOOST_AUTO_TEST_CASE(BlockValidator_Test_PeginMismatch)
 {
     test::Miner miner(GetDataDir());
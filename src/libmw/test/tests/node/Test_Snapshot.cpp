@@ -0,0 +1,140 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <mw/exceptions/DeserializationException.h>
+#include <mw/exceptions/ValidationException.h>
+#include <mw/node/CoinsView.h>
+#include <mw/node/Snapshot.h>
+
+#include <clientversion.h>
+#include <fs.h>
+#include <streams.h>
+
+#include <test_framework/Miner.h>
+#include <test_framework/TestMWEB.h>
+
+BOOST_FIXTURE_TEST_SUITE(TestSnapshot, MWEBTestingSetup)
+
+static mw::SnapshotInfo WriteSnapshot(const fs::path& path, const FilePath& datadir, const mw::DBWrapper::Ptr& pDatabase, const mw::Header::CPtr& pHeader)
+{
+    CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+    return mw::SnapshotWriter::Capture(datadir, pDatabase, pHeader).Write(file);
+}
+
+static mw::SnapshotInfo LoadSnapshot(const fs::path& path, const FilePath& datadir, const mw::DBWrapper::Ptr& pDatabase)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    return mw::SnapshotReader::Load(file, datadir, pDatabase);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotRoundTrip)
+{
+    auto pDatabase = GetDB();
+    auto pDBView = mw::CoinsViewDB::Open(GetDataDir(), nullptr, pDatabase);
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pDBView);
+
+    test::Miner miner(GetDataDir());
+
+    test::Tx block1_tx1 = test::Tx::CreatePegIn(1000);
+    test::Tx block1_tx2 = test::Tx::CreatePegIn(500);
+    auto block1 = miner.MineBlock(150, { block1_tx1, block1_tx2 });
+    pCachedView->ApplyBlock(block1.GetBlock());
+
+    test::Tx block2_tx1 = test::Tx::CreatePegOut(block1_tx1.GetOutputs().front());
+    test::Tx block2_tx2 = test::Tx::CreatePegIn(200);
+    auto block2 = miner.MineBlock(151, { block2_tx1, block2_tx2 });
+    pCachedView->ApplyBlock(block2.GetBlock());
+
+    auto pBatch = pDatabase->CreateBatch();
+    pCachedView->Flush(pBatch);
+    pBatch->Commit();
+
+    const fs::path snapshot_path = GetDataDir() / "snapshot.dat";
+    mw::SnapshotInfo written = WriteSnapshot(snapshot_path, GetDataDir(), pDatabase, block2.GetHeader());
+
+    // Load into a separate datadir and database
+    CDBWrapper snapshot_db(GetDataDir() / "snapshot_db", 1 << 15);
+    auto pSnapshotDatabase = std::make_shared<MWEB::DBWrapper>(&snapshot_db);
+    const FilePath snapshot_dir = FilePath(GetDataDir()).GetChild("snapshot");
+
+    mw::SnapshotInfo loaded = LoadSnapshot(snapshot_path, snapshot_dir, pSnapshotDatabase);
+    BOOST_REQUIRE(loaded.hash == written.hash);
+    BOOST_REQUIRE(loaded.num_utxos == written.num_utxos);
+    BOOST_REQUIRE(*loaded.pHeader == *block2.GetHeader());
+
+    auto pSnapshotView = mw::CoinsViewDB::Open(snapshot_dir, loaded.pHeader, pSnapshotDatabase);
+    BOOST_REQUIRE(pSnapshotView->GetOutputPMMR()->Root() == block2.GetHeader()->GetOutputRoot());
+    BOOST_REQUIRE(pSnapshotView->GetLeafSet()->Root() == block2.GetHeader()->GetLeafsetRoot());
+    BOOST_REQUIRE(pSnapshotView->GetUTXO(block1_tx1.GetOutputs().front().GetOutputID()) == nullptr);
+    BOOST_REQUIRE(pSnapshotView->GetUTXO(block1_tx2.GetOutputs().front().GetOutputID()) != nullptr);
+    BOOST_REQUIRE(pSnapshotView->GetUTXO(block2_tx2.GetOutputs().front().GetOutputID()) != nullptr);
+
+    // The loaded state can be extended, just like the original
+    auto pSnapshotCache = std::make_shared<mw::CoinsViewCache>(pSnapshotView);
+    test::Tx block3_tx1 = test::Tx::CreatePegOut(block1_tx2.GetOutputs().front());
+    auto block3 = miner.MineBlock(152, { block3_tx1 });
+    pSnapshotCache->ApplyBlock(block3.GetBlock());
+
+    pBatch = pSnapshotDatabase->CreateBatch();
+    pSnapshotCache->Flush(pBatch);
+    pBatch->Commit();
+    BOOST_REQUIRE(pSnapshotView->GetUTXO(block1_tx2.GetOutputs().front().GetOutputID()) == nullptr);
+
+    // Loading requires a database without MWEB state
+    BOOST_REQUIRE_THROW(LoadSnapshot(snapshot_path, snapshot_dir, pSnapshotDatabase), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotCorruption)
+{
+    auto pDatabase = GetDB();
+    auto pDBView = mw::CoinsViewDB::Open(GetDataDir(), nullptr, pDatabase);
+    auto pCachedView = std::make_shared<mw::CoinsViewCache>(pDBView);
+
+    test::Miner miner(GetDataDir());
+
+    test::Tx block1_tx1 = test::Tx::CreatePegIn(1000);
+    auto block1 = miner.MineBlock(150, { block1_tx1 });
+    pCachedView->ApplyBlock(block1.GetBlock());
+
+    test::Tx block2_tx1 = test::Tx::CreatePegIn(500);
+    auto block2 = miner.MineBlock(151, { block2_tx1 });
+    pCachedView->ApplyBlock(block2.GetBlock());
+
+    auto pBatch = pDatabase->CreateBatch();
+    pCachedView->Flush(pBatch);
+    pBatch->Commit();
+
+    const fs::path snapshot_path = GetDataDir() / "snapshot.dat";
+    WriteSnapshot(snapshot_path, GetDataDir(), pDatabase, block2.GetHeader());
+
+    // Flip a byte in the last chunk of UTXOs, which precedes its hash and the END chunk
+    std::vector<uint8_t> bytes = File(FilePath(snapshot_path)).ReadBytes();
+    std::vector<uint8_t> corrupt = bytes;
+    corrupt[corrupt.size() - 100] ^= 1;
+
+    const fs::path corrupt_path = GetDataDir() / "corrupt.dat";
+    File(FilePath(corrupt_path)).Write(corrupt);
+    {
+        CDBWrapper snapshot_db(GetDataDir() / "corrupt_db", 1 << 15);
+        auto pSnapshotDatabase = std::make_shared<MWEB::DBWrapper>(&snapshot_db);
+        BOOST_REQUIRE_THROW(
+            LoadSnapshot(corrupt_path, FilePath(GetDataDir()).GetChild("corrupt"), pSnapshotDatabase),
+            DeserializationException
+        );
+    }
+
+    // A snapshot whose chunks are intact, but whose header doesn't match its MMRs
+    const fs::path mismatch_path = GetDataDir() / "mismatch.dat";
+    WriteSnapshot(mismatch_path, GetDataDir(), pDatabase, block1.GetHeader());
+    {
+        CDBWrapper snapshot_db(GetDataDir() / "mismatch_db", 1 << 15);
+        auto pSnapshotDatabase = std::make_shared<MWEB::DBWrapper>(&snapshot_db);
+        BOOST_REQUIRE_THROW(
+            LoadSnapshot(mismatch_path, FilePath(GetDataDir()).GetChild("mismatch"), pSnapshotDatabase),
+            ValidationException
+        );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 #include <amount.h>
 #include <chain.h>
 #include <chainparams.h>
+#include <checkqueue.h>
 #include <coins.h>
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
@@ -19,11 +20,15 @@
 #include <policy/policy.h>
 #include <pow.h>
 #include <primitives/transaction.h>
+#include <shutdown.h>
 #include <timedata.h>
 #include <util/moneystr.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <utility>
 
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev)
@@ -510,3 +515,100 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
     pblock->vtx[0] = MakeTransactionRef(std::move(txCoinbase));
     pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
 }
+
+/** Number of consecutive nonces tried by a single CNonceSearchCheck */
+static constexpr uint64_t NONCES_PER_CHECK = 8;
+/** Number of CNonceSearchChecks queued at a time by SolveBlock */
+static constexpr size_t NONCE_CHECKS_PER_ROUND = 4 * MAX_GENERATE_THREADS;
+
+/**
+ * Closure representing the search of a range of nonces for one that
+ * satisfies the block's proof of work. The lowest nonce found by any check
+ * is written to a caller-owned atomic, and the search of a range stops at
+ * that nonce, so no work is spent above a known solution.
+ */
+class CNonceSearchCheck
+{
+private:
+    CBlockHeader m_header;
+    const Consensus::Params* m_params{nullptr};
+    uint64_t m_begin{0};
+    uint64_t m_end{0};
+    std::atomic<uint64_t>* m_best_nonce{nullptr};
+    std::atomic<bool>* m_interrupted{nullptr};
+
+public:
+    CNonceSearchCheck() = default;
+    CNonceSearchCheck(const CBlockHeader& header, const Consensus::Params& params, uint64_t begin, uint64_t end, std::atomic<uint64_t>& best_nonce, std::atomic<bool>& interrupted) :
+        m_header(header), m_params(&params), m_begin(begin), m_end(end), m_best_nonce(&best_nonce), m_interrupted(&interrupted) { }
+
+    bool operator()()
+    {
+        for (uint64_t nonce = m_begin; nonce < m_end && nonce < m_best_nonce->load(); ++nonce) {
+            if (ShutdownRequested()) {
+                *m_interrupted = true;
+                break;
+            }
+
+            m_header.nNonce = nonce;
+            if (CheckProofOfWork(m_header.GetPoWHash(), m_header.nBits, *m_params)) {
+                uint64_t best = m_best_nonce->load();
+                while (nonce < best && !m_best_nonce->compare_exchange_weak(best, nonce)) {}
+                break;
+            }
+        }
+        return true;
+    }
+
+    void swap(CNonceSearchCheck& check)
+    {
+        std::swap(m_header, check.m_header);
+        std::swap(m_params, check.m_params);
+        std::swap(m_begin, check.m_begin);
+        std::swap(m_end, check.m_end);
+        std::swap(m_best_nonce, check.m_best_nonce);
+        std::swap(m_interrupted, check.m_interrupted);
+    }
+};
+
+static CCheckQueue<CNonceSearchCheck> noncesearchqueue(1);
+
+void ThreadNonceSearch(int worker_num)
+{
+    util::ThreadRename(strprintf("noncesearch.%i", worker_num));
+    noncesearchqueue.Thread();
+}
+
+bool SolveBlock(CBlockHeader& block, const Consensus::Params& consensusParams, uint64_t& max_tries)
+{
+    // The maximum nonce itself is never tried, as in the original serial search.
+    const uint64_t start = block.nNonce;
+    const uint64_t end = start + std::min<uint64_t>(max_tries, std::numeric_limits<uint32_t>::max() - start);
+
+    // Ranges of nonces are queued in increasing order, a round at a time, and
+    // every nonce below the best solution found in a round gets tried. The
+    // outcome therefore matches a single-threaded search.
+    std::atomic<uint64_t> best_nonce{end};
+    std::atomic<bool> interrupted{false};
+    uint64_t next_nonce = start;
+    while (next_nonce < best_nonce.load() && !interrupted) {
+        std::vector<CNonceSearchCheck> checks;
+        for (size_t i = 0; i < NONCE_CHECKS_PER_ROUND && next_nonce < end; ++i) {
+            const uint64_t check_end = std::min(end, next_nonce + NONCES_PER_CHECK);
+            checks.emplace_back(block, consensusParams, next_nonce, check_end, best_nonce, interrupted);
+            next_nonce = check_end;
+        }
+
+        CCheckQueueControl<CNonceSearchCheck> control(&noncesearchqueue);
+        control.Add(checks);
+        control.Wait();
+    }
+
+    if (interrupted) {
+        return false;
+    }
+
+    block.nNonce = best_nonce;
+    max_tries -= best_nonce - start;
+    return best_nonce < end;
+}
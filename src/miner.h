@@ -26,6 +26,10 @@ class CScript;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default for -genthreads, the number of threads searching for a nonce in the generate RPCs */
+static const int DEFAULT_GENERATE_THREADS = 1;
+/** Maximum number of threads searching for a nonce in the generate RPCs, including the RPC thread */
+static const int MAX_GENERATE_THREADS = 16;
 
 struct CBlockTemplate
 {
@@ -214,6 +218,24 @@ private:
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 
+/** Run an instance of the nonce search thread, which SolveBlock hands ranges of nonces to */
+void ThreadNonceSearch(int worker_num);
+
+/**
+ * Search for a nonce that satisfies the block's proof of work, starting at
+ * block.nNonce and trying at most max_tries nonces below the maximum nonce.
+ * The calling thread searches along with the nonce search threads, which
+ * are started once at init and reused by every call.
+ *
+ * On return block.nNonce holds the lowest valid nonce, or the first untried
+ * nonce if none was found, and max_tries is reduced by the number of failed
+ * attempts. The search stops early, leaving the block untouched, if a
+ * shutdown is requested.
+ *
+ * @returns whether a valid nonce was found.
+ */
+bool SolveBlock(CBlockHeader& block, const Consensus::Params& consensusParams, uint64_t& max_tries);
+
 /** Update an old GenerateCoinbaseCommitment from CreateNewBlock after the block txs have changed */
 void RegenerateCommitments(CBlock& block);
 
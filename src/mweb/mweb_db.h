@@ -3,6 +3,9 @@
 #include <dbwrapper.h>
 #include <mw/interfaces/db_interface.h>
 
+#include <algorithm>
+#include <numeric>
+
 namespace MWEB {
 
 class DBBatch : public mw::DBBatch
@@ -52,6 +55,11 @@ public:
         return m_pIterator->GetKey(key);
     }
 
+    bool GetValue(std::vector<uint8_t>& value) const final
+    {
+        return m_pIterator->GetValue(value);
+    }
+
     bool Valid() const final
     {
         return m_pIterator->Valid();
@@ -71,6 +79,59 @@ public:
         return m_pDB->Read(key, value);
     }
 
+    /**
+     * Reads the keys with a single iterator, visiting them in the order they're stored.
+     * Keys that are close together are reached by stepping the iterator forward,
+     * which is cheaper than a separate lookup, and only distant keys require a seek.
+     */
+    std::vector<boost::optional<std::vector<uint8_t>>> MultiRead(const std::vector<std::string>& keys) const final
+    {
+        std::vector<boost::optional<std::vector<uint8_t>>> values(keys.size());
+        if (keys.empty()) {
+            return values;
+        }
+
+        // Keys are serialized with a length prefix, so they're stored ordered by length, then by bytes.
+        std::vector<size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return StoredBefore(keys[a], keys[b]); });
+
+        std::unique_ptr<CDBIterator> pIterator(m_pDB->NewIterator());
+        bool positioned = false;
+        for (size_t i : order) {
+            const std::string& target = keys[i];
+
+            // Every key between the previous target and the iterator has been visited,
+            // so the first key not stored before the target is where a seek would land.
+            std::string key;
+            bool at_target = false;
+            for (size_t steps = 0; positioned && steps <= MAX_SEQUENTIAL_STEPS; steps++) {
+                if (!pIterator->Valid() || !pIterator->GetKey(key)) {
+                    break;
+                }
+
+                if (!StoredBefore(key, target)) {
+                    at_target = true;
+                    break;
+                }
+
+                pIterator->Next();
+            }
+
+            if (!at_target) {
+                pIterator->Seek(target);
+                positioned = true;
+            }
+
+            std::vector<uint8_t> value;
+            if (pIterator->Valid() && pIterator->GetKey(key) && key == target && pIterator->GetValue(value)) {
+                values[i] = std::move(value);
+            }
+        }
+
+        return values;
+    }
+
     std::unique_ptr<mw::DBIterator> NewIterator() final
     {
         return std::unique_ptr<mw::DBIterator>(new MWEB::DBIterator(m_pDB->NewIterator()));
@@ -82,6 +143,14 @@ public:
     }
 
 private:
+    // The number of entries to step over before seeking is cheaper.
+    static constexpr size_t MAX_SEQUENTIAL_STEPS = 16;
+
+    static bool StoredBefore(const std::string& a, const std::string& b)
+    {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    }
+
     CDBWrapper* m_pDB;
 };
 
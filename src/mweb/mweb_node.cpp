@@ -1,17 +1,78 @@
 #include <mweb/mweb_node.h>
 
 #include <chain.h>
+#include <checkqueue.h>
 #include <consensus/validation.h>
+#include <logging.h>
 #include <mw/node/BlockValidator.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <script/interpreter.h>
 #include <undo.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <validation.h>
 
 using namespace MWEB;
 
+// Number of signatures and range proofs batch verified by a single MWEBCryptoCheck.
+// Range proofs are far more expensive to verify, so they're split into smaller chunks.
+static constexpr size_t SIGNATURES_PER_CHECK = 128;
+static constexpr size_t PROOFS_PER_CHECK = 16;
+
+/**
+ * Closure representing the batch verification of a chunk of an MWEB block's
+ * signatures or range proofs.
+ */
+class MWEBCryptoCheck
+{
+private:
+    std::vector<SignedMessage> m_signatures;
+    std::vector<ProofData> m_proofs;
+
+public:
+    MWEBCryptoCheck() = default;
+    MWEBCryptoCheck(std::vector<SignedMessage> signatures, std::vector<ProofData> proofs)
+        : m_signatures(std::move(signatures)), m_proofs(std::move(proofs)) { }
+
+    bool operator()()
+    {
+        // Signatures and proofs with unparsable points throw, which must not escape the worker thread.
+        try {
+            return (m_signatures.empty() || Schnorr::BatchVerify(m_signatures))
+                && (m_proofs.empty() || Bulletproofs::BatchVerify(m_proofs));
+        } catch (const std::exception& e) {
+            LogPrint(BCLog::VALIDATION, "MWEB crypto check failed: %s\n", e.what());
+            return false;
+        }
+    }
+
+    void swap(MWEBCryptoCheck& check)
+    {
+        m_signatures.swap(check.m_signatures);
+        m_proofs.swap(check.m_proofs);
+    }
+};
+
+static CCheckQueue<MWEBCryptoCheck> mwebcheckqueue(1);
+
+void MWEB::ThreadCryptoCheck(int worker_num)
+{
+    util::ThreadRename(strprintf("mwebch.%i", worker_num));
+    mwebcheckqueue.Thread();
+}
+
+template <typename T>
+static std::vector<std::vector<T>> SplitIntoChunks(const std::vector<T>& items, const size_t chunk_size)
+{
+    std::vector<std::vector<T>> chunks;
+    for (size_t i = 0; i < items.size(); i += chunk_size) {
+        chunks.emplace_back(items.begin() + i, items.begin() + std::min(items.size(), i + chunk_size));
+    }
+
+    return chunks;
+}
+
 bool Node::CheckBlock(const CBlock& block, BlockValidationState& state)
 {
     // HasMWEBTx() is true only when mweb txs being shared outside of a block (for use by mempools).
@@ -155,9 +216,35 @@ bool Node::ValidateMWEBBlock(const CBlock& block)
         hogex_pegouts.push_back(PegOutCoin(out.nValue, {pubkey.begin(), pubkey.end()}));
     }
 
-    // Call into the libmw context-free block validator to validate the TxBody,
-    // and verify that the pegins and pegouts all match.
-    return BlockValidator::ValidateBlock(block.mweb_block.m_block, block_pegins, hogex_pegouts);
+    const mw::Block::CPtr& pMWEBBlock = block.mweb_block.m_block;
+    if (!g_parallel_script_checks) {
+        // Call into the libmw context-free block validator to validate the TxBody,
+        // and verify that the pegins and pegouts all match.
+        return BlockValidator::ValidateBlock(pMWEBBlock, block_pegins, hogex_pegouts);
+    }
+
+    // Queue the signatures and range proofs for batch verification by the worker threads,
+    // in chunks small enough to be spread across all of them.
+    std::vector<MWEBCryptoCheck> checks;
+    try {
+        for (auto& signatures : SplitIntoChunks(pMWEBBlock->GetTxBody().BuildSignedMsgs(), SIGNATURES_PER_CHECK)) {
+            checks.emplace_back(std::move(signatures), std::vector<ProofData>{});
+        }
+        for (auto& proofs : SplitIntoChunks(pMWEBBlock->GetTxBody().BuildProofData(), PROOFS_PER_CHECK)) {
+            checks.emplace_back(std::vector<SignedMessage>{}, std::move(proofs));
+        }
+    } catch (const std::exception& e) {
+        // Kernel excesses and input keys that aren't valid points can't be turned into signed messages.
+        LogPrint(BCLog::VALIDATION, "Failed to build MWEB crypto checks: %s\n", e.what());
+        return false;
+    }
+
+    CCheckQueueControl<MWEBCryptoCheck> control(&mwebcheckqueue);
+    control.Add(checks);
+
+    // Meanwhile, run the remaining (non-crypto) checks, such as the sum and MMR checks, on this thread.
+    const bool valid = BlockValidator::ValidateBlock(pMWEBBlock, block_pegins, hogex_pegouts, /* verify_crypto */ false);
+    return control.Wait() && valid;
 }
 
 bool Node::ConnectBlock(const CBlock& block, const Consensus::Params& consensus_params, const CBlockIndex* pindexPrev, CBlockUndo& blockundo, mw::CoinsViewCache& mweb_view, BlockValidationState& state)
@@ -258,4 +345,25 @@ bool Node::CheckTransaction(const CTransaction& tx, TxValidationState& state)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool Node::BatchVerifyTransactions(const std::vector<CTransactionRef>& txs)
+{
+    std::vector<mw::Transaction::CPtr> mweb_txs;
+    for (const CTransactionRef& tx : txs) {
+        if (tx->HasMWEBTx()) {
+            mweb_txs.push_back(tx->mweb_tx.m_transaction);
+        }
+    }
+
+    if (mweb_txs.empty()) {
+        return true;
+    }
+
+    try {
+        return mw::Transaction::BatchVerify(mweb_txs);
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::MEMPOOL, "MWEB batch verification failed: %s\n", e.what());
+        return false;
+    }
+}
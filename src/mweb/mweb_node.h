@@ -2,12 +2,12 @@
 
 #include <consensus/params.h>
 #include <mw/node/CoinsView.h>
+#include <primitives/transaction.h>
 
 // Forward Declarations
 class CBlock;
 class CBlockUndo;
 class CBlockIndex;
-class CTransaction;
 class BlockValidationState;
 class TxValidationState;
 
@@ -101,8 +101,26 @@ public:
     /// <returns>True if all validation checks succeed.</returns>
     static bool CheckTransaction(const CTransaction& tx, TxValidationState& state);
 
+    /// <summary>
+    /// Batch verifies the signatures and range proofs of the MWEB data of all of the transactions at once.
+    /// Used to verify bursts of transactions before they are accepted to the mempool one at a time.
+    /// When the batch is valid, the verified signatures and proofs are cached, so CheckTransaction
+    /// doesn't verify them again. Otherwise, nothing is cached, and CheckTransaction falls back to
+    /// verifying each transaction on its own.
+    /// </summary>
+    /// <param name="txs">The transactions to verify. Transactions without MWEB data are skipped.</param>
+    /// <returns>True if every signature and range proof is valid.</returns>
+    static bool BatchVerifyTransactions(const std::vector<CTransactionRef>& txs);
+
 private:
     static bool ValidateMWEBBlock(const CBlock& block);
 };
 
+/// <summary>
+/// Runs an instance of the MWEB signature and range proof checking thread.
+/// These threads are used to verify the signatures and range proofs of MWEB blocks in parallel.
+/// </summary>
+/// <param name="worker_num">The index of the worker, used to name the thread.</param>
+void ThreadCryptoCheck(int worker_num);
+
 }
\ No newline at end of file
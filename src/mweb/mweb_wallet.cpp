@@ -2,6 +2,7 @@
 #include <wallet/wallet.h>
 #include <wallet/coincontrol.h>
 #include <util/bip32.h>
+#include <util/system.h>
 
 using namespace MWEB;
 
@@ -39,14 +40,45 @@ bool Wallet::UpgradeCoins()
 
 std::vector<mw::Coin> Wallet::RewindOutputs(const CTransaction& tx)
 {
-    std::vector<mw::Coin> coins;
+    if (!tx.HasMWEBTx()) {
+        return {};
+    }
 
-    if (tx.HasMWEBTx()) {
-        for (const Output& output : tx.mweb_tx.m_transaction->GetOutputs()) {
-            mw::Coin mweb_coin;
-            if (RewindOutput(output, mweb_coin)) {
-                coins.push_back(mweb_coin);
-            }
+    return RewindOutputs(tx.mweb_tx.m_transaction->GetOutputs());
+}
+
+std::vector<mw::Coin> Wallet::RewindOutputs(const std::vector<Output>& outputs)
+{
+    mw::Keychain::Ptr keychain = GetKeychain();
+    const bool can_upgrade = keychain && keychain->HasSpendSecret();
+
+    // Coins that are already fully rewound don't need to be scanned again.
+    std::map<mw::Hash, mw::Coin> found;
+    std::vector<Output> to_scan;
+    for (const Output& output : outputs) {
+        mw::Coin coin;
+        if (GetCoin(output.GetOutputID(), coin) && coin.IsMine() && (coin.HasSpendKey() || !can_upgrade)) {
+            found[coin.output_id] = std::move(coin);
+        } else {
+            to_scan.push_back(output);
+        }
+    }
+
+    if (keychain && !to_scan.empty()) {
+        std::vector<mw::Coin> rewound = keychain->RewindOutputs(to_scan, std::max(GetNumCores(), 1));
+        SaveToWallet(rewound);
+
+        for (mw::Coin& coin : rewound) {
+            found[coin.output_id] = std::move(coin);
+        }
+    }
+
+    // Return the coins in the same order as their outputs.
+    std::vector<mw::Coin> coins;
+    for (const Output& output : outputs) {
+        auto iter = found.find(output.GetOutputID());
+        if (iter != found.end()) {
+            coins.push_back(iter->second);
         }
     }
 
@@ -112,11 +144,21 @@ void Wallet::LoadToWallet(const mw::Coin& coin)
 
 void Wallet::SaveToWallet(const std::vector<mw::Coin>& coins)
 {
+    if (coins.empty()) {
+        return;
+    }
+
+    // Write all of the coins in one database transaction, rather than syncing after each one.
     WalletBatch batch(m_pWallet->GetDatabase());
+    const bool txn_started = batch.TxnBegin();
     for (const mw::Coin& coin : coins) {
         m_coins[coin.output_id] = coin;
         batch.WriteMWEBCoin(coin);
     }
+
+    if (txn_started) {
+        batch.TxnCommit();
+    }
 }
 
 bool Wallet::GetCoin(const mw::Hash& output_id, mw::Coin& coin) const
@@ -38,6 +38,10 @@ public:
     std::vector<mw::Coin> RewindOutputs(const CTransaction& tx);
     bool RewindOutput(const Output& output, mw::Coin& coin);
 
+    // Rewinds many outputs at once, such as all of a block's outputs during a rescan.
+    // The keychain scans them on multiple threads, and any new coins are written in a single batch.
+    std::vector<mw::Coin> RewindOutputs(const std::vector<Output>& outputs);
+
     bool GetStealthAddress(const mw::Coin& coin, StealthAddress& address) const;
     bool GetStealthAddress(const uint32_t index, StealthAddress& address) const;
 
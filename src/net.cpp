@@ -37,6 +37,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/upnpcommands.h>
@@ -47,6 +51,7 @@ static_assert(MINIUPNPC_API_VERSION >= 10, "miniUPnPc API version >= 10 assumed"
 #endif
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <unordered_map>
 
@@ -108,6 +113,13 @@ static const uint64_t SELECT_TIMEOUT_MILLISECONDS = 50;
 
 const std::string NET_MESSAGE_COMMAND_OTHER = "*other*";
 
+#ifdef USE_EPOLL
+/** The maximum number of socket events handled per wake-up. Any others are handled on the next one. */
+static const int EPOLL_MAX_EVENTS = 1024;
+/** Set in the epoll data of listening sockets, along with their index in vhListenSocket. Nodes use their id. */
+static const uint64_t EPOLL_LISTEN_SOCKET = uint64_t{1} << 63;
+#endif
+
 static const uint64_t RANDOMIZER_ID_NETGROUP = 0x6c0edd8036ef4036ULL; // SHA256("netgroup")[0:8]
 static const uint64_t RANDOMIZER_ID_LOCALHOSTNONCE = 0xd93e69e2bbfa5735ULL; // SHA256("localhostnonce")[0:8]
 static const uint64_t RANDOMIZER_ID_ADDRCACHE = 0x1cf2e4ddd306dda9ULL; // SHA256("addrcache")[0:8]
@@ -834,6 +846,7 @@ size_t CConnman::SocketSendData(CNode *pnode) const EXCLUSIVE_LOCKS_REQUIRED(pno
                 it++;
             } else {
                 // could not send full message; stop sending more
+                pnode->m_send_ready = false;
                 break;
             }
         } else {
@@ -847,6 +860,7 @@ size_t CConnman::SocketSendData(CNode *pnode) const EXCLUSIVE_LOCKS_REQUIRED(pno
                 }
             }
             // couldn't send anything at all
+            pnode->m_send_ready = false;
             break;
         }
     }
@@ -1153,6 +1167,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
+    RegisterSocketEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
@@ -1221,6 +1236,7 @@ void CConnman::DisconnectNodes()
             {
                 // remove from vNodes
                 vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
+                UnregisterSocketEvents(*pnode);
 
                 // release outbound grant (if any)
                 pnode->grantOutbound.Release();
@@ -1304,6 +1320,51 @@ void CConnman::InactivityCheck(CNode *pnode)
     }
 }
 
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+#ifdef USE_POLL
+    if (str == "poll") {
+        mode = SocketEventsMode::POLL;
+        return true;
+    }
+#else
+    if (str == "select") {
+        mode = SocketEventsMode::SELECT;
+        return true;
+    }
+#endif
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SocketEventsMode::EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string SocketEventsModeToString(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SocketEventsMode::SELECT: return "select";
+    case SocketEventsMode::POLL: return "poll";
+    case SocketEventsMode::EPOLL: return "epoll";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+#ifdef USE_POLL
+    std::string modes = "poll";
+#else
+    std::string modes = "select";
+#endif
+#ifdef USE_EPOLL
+    modes += ", epoll";
+#endif
+    return modes;
+}
+
 bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     for (const ListenSocket& hListenSocket : vhListenSocket) {
@@ -1351,7 +1412,7 @@ bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &s
 }
 
 #ifdef USE_POLL
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+void CConnman::SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1393,7 +1454,7 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
     }
 }
 #else
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+void CConnman::SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1468,6 +1529,189 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
 }
 #endif
 
+#ifdef USE_EPOLL
+bool CConnman::StartSocketEvents()
+{
+    StopSocketEvents();
+    if (m_socket_events_mode != SocketEventsMode::EPOLL) return true;
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        LogPrintf("Failed to create epoll instance: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    m_epoll_busy = false;
+
+    // Listening sockets are level-triggered, as only one connection is accepted per wake-up.
+    for (size_t i = 0; i < vhListenSocket.size(); i++) {
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = EPOLL_LISTEN_SOCKET | i;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, vhListenSocket[i].socket, &event) != 0) {
+            LogPrintf("Failed to register listening socket for events: %s\n", NetworkErrorString(errno));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CConnman::RegisterSocketEvents(CNode* pnode)
+{
+    if (m_socket_events_mode != SocketEventsMode::EPOLL) return;
+
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET) return;
+
+    // The socket is never unregistered. Closing it removes it from the epoll instance,
+    // and events that were already reported for it are ignored once the node is gone.
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = (uint64_t)pnode->GetId();
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, pnode->hSocket, &event) != 0) {
+        LogPrint(BCLog::NET, "failed to register socket events for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(errno));
+        pnode->fDisconnect = true;
+        return;
+    }
+
+    LOCK(m_epoll_nodes_mutex);
+    m_epoll_nodes.emplace(pnode->GetId(), pnode);
+    m_epoll_ready_nodes.insert(pnode->GetId());
+}
+
+void CConnman::UnregisterSocketEvents(const CNode& node)
+{
+    if (m_socket_events_mode != SocketEventsMode::EPOLL) return;
+
+    LOCK(m_epoll_nodes_mutex);
+    m_epoll_nodes.erase(node.GetId());
+    m_epoll_ready_nodes.erase(node.GetId());
+}
+
+void CConnman::MarkNodeReady(const CNode& node)
+{
+    if (m_socket_events_mode != SocketEventsMode::EPOLL) return;
+
+    LOCK(m_epoll_nodes_mutex);
+    if (m_epoll_nodes.count(node.GetId())) m_epoll_ready_nodes.insert(node.GetId());
+}
+
+void CConnman::StopSocketEvents()
+{
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+    LOCK(m_epoll_nodes_mutex);
+    m_epoll_nodes.clear();
+    m_epoll_ready_nodes.clear();
+}
+
+void CConnman::SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    std::array<struct epoll_event, EPOLL_MAX_EVENTS> events;
+    const int nEvents = epoll_wait(m_epoll_fd, events.data(), events.size(), m_epoll_busy ? 0 : SELECT_TIMEOUT_MILLISECONDS);
+
+    if (interruptNet) return;
+
+    if (nEvents < 0) {
+        if (errno != EINTR) {
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(errno));
+            interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
+        }
+        return;
+    }
+
+    std::unordered_map<NodeId, uint32_t> node_events;
+    for (int i = 0; i < nEvents; i++) {
+        const uint64_t data = events[i].data.u64;
+        if (data & EPOLL_LISTEN_SOCKET) {
+            const size_t listen_idx = data & ~EPOLL_LISTEN_SOCKET;
+            if (listen_idx < vhListenSocket.size()) {
+                recv_set.insert(vhListenSocket[listen_idx].socket);
+            }
+        } else {
+            node_events[(NodeId)data] |= events[i].events;
+        }
+    }
+
+    // Only nodes with socket events or readiness changes since the last wake-up, and the ones
+    // serviced in it, can have become able to send or receive. Readiness persists between
+    // wake-ups, so nodes that weren't drained last time are serviced without waiting for
+    // another edge. Nodes are only removed from vNodes and deleted on this thread.
+    std::vector<CNode*> candidates;
+    {
+        LOCK(m_epoll_nodes_mutex);
+        for (const auto& node_event : node_events) {
+            m_epoll_ready_nodes.insert(node_event.first);
+        }
+        candidates.reserve(m_epoll_ready_nodes.size());
+        for (const NodeId id : m_epoll_ready_nodes) {
+            auto it = m_epoll_nodes.find(id);
+            if (it != m_epoll_nodes.end()) candidates.push_back(it->second);
+        }
+        m_epoll_ready_nodes.clear();
+    }
+
+    // This follows the same rules as GenerateSelectSet.
+    std::vector<NodeId> serviced;
+    for (CNode* pnode : candidates) {
+        uint32_t events = 0;
+        auto it = node_events.find(pnode->GetId());
+        if (it != node_events.end()) events = it->second;
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) pnode->m_recv_ready = true;
+        const bool socket_error = events & (EPOLLERR | EPOLLHUP);
+
+        bool has_send_data;
+        {
+            // SocketSendData clears m_send_ready while holding cs_vSend, so an edge can't be lost in between.
+            LOCK(pnode->cs_vSend);
+            if (events & EPOLLOUT) pnode->m_send_ready = true;
+            has_send_data = !pnode->vSendMsg.empty();
+        }
+
+        const bool select_send = has_send_data && pnode->m_send_ready;
+        const bool select_recv = !has_send_data && !pnode->fPauseRecv && pnode->m_recv_ready;
+        if (!select_send && !select_recv && !socket_error) continue;
+
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET) continue;
+
+        if (select_send) send_set.insert(pnode->hSocket);
+        if (select_recv) recv_set.insert(pnode->hSocket);
+        if (socket_error) error_set.insert(pnode->hSocket);
+        serviced.push_back(pnode->GetId());
+    }
+
+    m_epoll_busy = nEvents == EPOLL_MAX_EVENTS || !serviced.empty();
+    if (!serviced.empty()) {
+        LOCK(m_epoll_nodes_mutex);
+        m_epoll_ready_nodes.insert(serviced.begin(), serviced.end());
+    }
+}
+#else
+bool CConnman::StartSocketEvents() { return true; }
+void CConnman::RegisterSocketEvents(CNode* pnode) {}
+void CConnman::UnregisterSocketEvents(const CNode& node) {}
+void CConnman::MarkNodeReady(const CNode& node) {}
+void CConnman::StopSocketEvents() {}
+#endif
+
+void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+#ifdef USE_EPOLL
+    if (m_socket_events_mode == SocketEventsMode::EPOLL) {
+        SocketEventsEpoll(recv_set, send_set, error_set);
+        return;
+    }
+#endif
+#ifdef USE_POLL
+    SocketEventsPoll(recv_set, send_set, error_set);
+#else
+    SocketEventsSelect(recv_set, send_set, error_set);
+#endif
+}
+
 void CConnman::SocketHandler()
 {
     std::set<SOCKET> recv_set, send_set, error_set;
@@ -1526,6 +1770,10 @@ void CConnman::SocketHandler()
                     continue;
                 nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
             }
+            if (nBytes < (int)sizeof(pchBuf)) {
+                // The socket was drained, so wait for the next edge before reading again
+                pnode->m_recv_ready = false;
+            }
             if (nBytes > 0)
             {
                 bool notify = false;
@@ -2243,6 +2491,7 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
         grantOutbound->MoveTo(pnode->grantOutbound);
 
     m_msgproc->InitializeNode(pnode);
+    RegisterSocketEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
@@ -2298,6 +2547,36 @@ void CConnman::ThreadMessageHandler()
     }
 }
 
+void CConnman::QueueMessageWork(CNode* pnode, std::function<void()> work)
+{
+    pnode->AddRef();
+    {
+        LOCK(m_msg_work_mutex);
+        m_msg_work_queue.emplace_back(pnode, std::move(work));
+    }
+    m_msg_work_cond.notify_one();
+}
+
+void CConnman::ThreadMessageWorker()
+{
+    while (true) {
+        std::pair<CNode*, std::function<void()>> item;
+        {
+            WAIT_LOCK(m_msg_work_mutex, lock);
+            m_msg_work_cond.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_msg_work_mutex) { return flagInterruptMsgProc || !m_msg_work_queue.empty(); });
+            if (flagInterruptMsgProc) return;
+            item = std::move(m_msg_work_queue.front());
+            m_msg_work_queue.pop_front();
+        }
+
+        item.second();
+        item.first->Release();
+
+        // The node's remaining messages were held back while the work ran
+        WakeMessageHandler();
+    }
+}
+
 bool CConnman::BindListenPort(const CService& addrBind, bilingual_str& strError, NetPermissionFlags permissions)
 {
     int nOne = 1;
@@ -2540,6 +2819,15 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         LogPrintf("%i block-relay-only anchors will be tried for connections.\n", m_anchors.size());
     }
 
+    if (!StartSocketEvents()) {
+        if (clientInterface) {
+            clientInterface->ThreadSafeMessageBox(
+                _("Failed to set up socket events. Use -socketevents to select another mode."),
+                "", CClientUIInterface::MSG_ERROR);
+        }
+        return false;
+    }
+
     uiInterface.InitMessage(_("Starting network threads...").translated);
 
     fAddressesInitialized = true;
@@ -2590,6 +2878,12 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     // Process messages
     threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (int i = 0; i < m_num_msg_workers; i++) {
+        m_msg_worker_threads.emplace_back(&TraceThread<std::function<void()> >, "msgwork", std::function<void()>(std::bind(&CConnman::ThreadMessageWorker, this)));
+    }
+    if (m_num_msg_workers > 0) {
+        LogPrintf("Serving read-only messages on %d worker threads\n", m_num_msg_workers);
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery([this] { DumpAddresses(); }, DUMP_PEERS_INTERVAL);
@@ -2619,6 +2913,11 @@ void CConnman::Interrupt()
         flagInterruptMsgProc = true;
     }
     condMsgProc.notify_all();
+    {
+        // Synchronize with workers checking the flag before they wait
+        LOCK(m_msg_work_mutex);
+    }
+    m_msg_work_cond.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2640,6 +2939,18 @@ void CConnman::StopThreads()
 {
     if (threadMessageHandler.joinable())
         threadMessageHandler.join();
+    for (std::thread& thread : m_msg_worker_threads) {
+        thread.join();
+    }
+    m_msg_worker_threads.clear();
+    {
+        // Drop the references held by work that never ran
+        LOCK(m_msg_work_mutex);
+        for (auto& item : m_msg_work_queue) {
+            item.first->Release();
+        }
+        m_msg_work_queue.clear();
+    }
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -2685,6 +2996,7 @@ void CConnman::StopNodes()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+    StopSocketEvents();
     semOutbound.reset();
     semAddnode.reset();
 }
@@ -86,6 +86,33 @@ static const bool DEFAULT_BLOCKSONLY = false;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 
+/** How the socket handler thread waits for socket events. */
+enum class SocketEventsMode {
+    SELECT, //!< select() on every socket, rebuilding the socket sets on each wake-up
+    POLL,   //!< poll() on every socket, rebuilding the pollfd array on each wake-up
+    EPOLL,  //!< Edge-triggered epoll, with each socket registered once and its readiness tracked per node
+};
+
+/** -socketevents default */
+#if defined(USE_EPOLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::EPOLL;
+#elif defined(USE_POLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::POLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::SELECT;
+#endif
+
+/** Parse a -socketevents value. Returns false if it isn't supported on this platform. */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** The -socketevents values supported on this platform, for the help text. */
+std::string GetSupportedSocketEventsModes();
+
+/** -msgworkerthreads default. 0 serves every message on the message handler thread. */
+static const int DEFAULT_MSG_WORKER_THREADS = 0;
+/** Maximum number of threads serving read-only messages */
+static const int MAX_MSG_WORKER_THREADS = 16;
+
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
@@ -222,6 +249,8 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         std::vector<bool> m_asmap;
+        SocketEventsMode m_socket_events_mode = DEFAULT_SOCKETEVENTS;
+        int m_msg_worker_threads = DEFAULT_MSG_WORKER_THREADS;
     };
 
     void Init(const Options& connOptions) {
@@ -240,6 +269,8 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = connOptions.m_peer_connect_timeout;
+        m_socket_events_mode = connOptions.m_socket_events_mode;
+        m_num_msg_workers = connOptions.m_msg_worker_threads;
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -410,6 +441,23 @@ public:
 
     void WakeMessageHandler();
 
+    /**
+     * Have the socket handler check on its next wake-up whether it can send to or receive from
+     * a node, after a change it doesn't get a socket event for, such as fPauseRecv being cleared.
+     */
+    void MarkNodeReady(const CNode& node);
+
+    /** Whether read-only messages are served by a pool of worker threads. */
+    bool HasMessageWorkers() const { return m_num_msg_workers > 0; }
+
+    /**
+     * Run work for a node on one of the message worker threads. The node is
+     * referenced until the work has run, and the message handler is woken
+     * afterwards. The caller is responsible for not queueing more work for
+     * the node until this work is done, so that its messages stay in order.
+     */
+    void QueueMessageWork(CNode* pnode, std::function<void()> work);
+
     /** Attempts to obfuscate tx time through exponentially distributed emitting.
         Works assuming that a single interval is used.
         Variable intervals will result in privacy decrease.
@@ -440,12 +488,28 @@ private:
     void ProcessAddrFetch();
     void ThreadOpenConnections(std::vector<std::string> connect);
     void ThreadMessageHandler();
+    void ThreadMessageWorker();
     void AcceptConnection(const ListenSocket& hListenSocket);
     void DisconnectNodes();
     void NotifyNumConnectionsChanged();
     void InactivityCheck(CNode *pnode);
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#ifdef USE_POLL
+    void SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#else
+    void SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+#ifdef USE_EPOLL
+    void SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+    /** Set up the epoll instance and register the listening sockets, when using SocketEventsMode::EPOLL. */
+    bool StartSocketEvents();
+    /** Register a node's socket for edge-triggered events, when using SocketEventsMode::EPOLL. */
+    void RegisterSocketEvents(CNode* pnode);
+    /** Stop tracking a node's readiness, once it's removed from vNodes. */
+    void UnregisterSocketEvents(const CNode& node);
+    void StopSocketEvents();
     void SocketHandler();
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
@@ -509,6 +573,16 @@ private:
     unsigned int nReceiveFloodSize{0};
 
     std::vector<ListenSocket> vhListenSocket;
+    SocketEventsMode m_socket_events_mode{DEFAULT_SOCKETEVENTS};
+    //! The epoll instance, when using SocketEventsMode::EPOLL. Only the socket handler thread waits on it.
+    int m_epoll_fd{-1};
+    //! Whether a node was left with work after the last wake-up, so the next wait shouldn't block.
+    bool m_epoll_busy{false};
+    Mutex m_epoll_nodes_mutex;
+    //! The nodes registered with the epoll instance, until they're removed from vNodes.
+    std::map<NodeId, CNode*> m_epoll_nodes GUARDED_BY(m_epoll_nodes_mutex);
+    //! Nodes to check on the next wake-up: those with socket events or readiness changes, and those serviced last time.
+    std::set<NodeId> m_epoll_ready_nodes GUARDED_BY(m_epoll_nodes_mutex);
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     CAddrMan addrman;
@@ -608,6 +682,13 @@ private:
     std::thread threadOpenConnections;
     std::thread threadMessageHandler;
 
+    /** Number of threads serving read-only messages, or 0 to serve them on the message handler */
+    int m_num_msg_workers{0};
+    std::vector<std::thread> m_msg_worker_threads;
+    Mutex m_msg_work_mutex;
+    std::condition_variable m_msg_work_cond;
+    std::deque<std::pair<CNode*, std::function<void()>>> m_msg_work_queue GUARDED_BY(m_msg_work_mutex);
+
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of m_max_outbound_full_relay
      *  This takes the place of a feeler connection */
@@ -919,6 +1000,10 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    // Socket readiness, when using edge-triggered socket events. Each edge is only reported once,
+    // so readiness is kept until a recv or send on the socket would block.
+    std::atomic_bool m_recv_ready{true};
+    std::atomic_bool m_send_ready{true};
 
     bool IsOutboundOrBlockRelayConn() const {
         switch (m_conn_type) {
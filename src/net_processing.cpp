@@ -11,19 +11,23 @@
 #include <blockencodings.h>
 #include <blockfilter.h>
 #include <chainparams.h>
+#include <consensus/tx_check.h>
 #include <consensus/validation.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <merkleblock.h>
+#include <mweb/mweb_node.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <policy/settings.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <reverse_iterator.h>
 #include <scheduler.h>
+#include <serializedblockcache.h>
 #include <streams.h>
 #include <tinyformat.h>
 #include <txmempool.h>
@@ -32,6 +36,8 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <deque>
+#include <list>
 #include <memory>
 #include <typeinfo>
 
@@ -154,6 +160,10 @@ static constexpr double MAX_ADDR_RATE_PER_SECOND{0.1};
  *  based increments won't go above this, but the MAX_ADDR_TO_SEND increment following GETADDR
  *  is exempt from this limit). */
 static constexpr size_t MAX_ADDR_PROCESSING_TOKEN_BUCKET{MAX_ADDR_TO_SEND};
+/** Maximum number of a peer's queued "tx" messages whose MWEB signatures and range proofs are batch verified together */
+static constexpr size_t MAX_MWEB_TX_BATCH_SIZE = 32;
+/** Maximum memory used by blocks kept serialized for peers that don't want their witness or MWEB data */
+static constexpr size_t MAX_SERIALIZED_BLOCK_CACHE_BYTES = 32 << 20;
 
 struct COrphanTx {
     // When modifying, adapt the copy of this definition in tests/DoS_tests.
@@ -450,6 +460,17 @@ static CNodeState *State(NodeId pnode) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
     return &it->second;
 }
 
+/**
+ * Serialization flags for the MWEB data in cmpctblock, getblocktxn and blocktxn messages
+ * exchanged with a peer. MWEB data is left out for peers that don't want it, and sent as
+ * short IDs to peers that support MWEB_SHORT_IDS_VERSION.
+ */
+static int GetCmpctMWEBFlags(const CNode& node, const CNodeState& state)
+{
+    if (!state.fWantsCmpctMWEB) return SERIALIZE_NO_MWEB;
+    return node.GetCommonVersion() >= MWEB_SHORT_IDS_VERSION ? SERIALIZE_MWEB_SHORT_IDS : 0;
+}
+
 /**
  * Data structure for an individual peer. This struct is not protected by
  * cs_main since it does not contain validation-critical data.
@@ -479,6 +500,9 @@ struct Peer {
     /** Work queue of items requested by this peer **/
     std::deque<CInv> m_getdata_requests GUARDED_BY(m_getdata_requests_mutex);
 
+    /** Whether a message worker is serving this peer. Its messages aren't processed until it's done. */
+    std::atomic<bool> m_worker_busy{false};
+
     /** Number of addresses that can be processed from this peer. Start at 1 to
      *  permit self-announcement. */
     double m_addr_token_bucket{1.0};
@@ -489,6 +513,11 @@ struct Peer {
     /** Total number of addresses that were processed (excludes rate-limited ones). */
     std::atomic<uint64_t> m_addr_processed{0};
 
+    /** Transactions of this peer's queued "tx" messages that were deserialized to batch verify
+     *  their MWEB data, keyed by the message's stream and in the order the messages were received.
+     *  Malformed messages have a null transaction. Only accessed by the message processing thread. */
+    std::deque<std::pair<const CDataStream*, CTransactionRef>> m_mweb_batched_txs;
+
     Peer(NodeId id) : m_id(id) {}
 };
 
@@ -1317,6 +1346,13 @@ static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
 static bool fMWEBPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
 
+static SerializedBlockCache g_serialized_block_cache{MAX_SERIALIZED_BLOCK_CACHE_BYTES};
+
+uint64_t GetSerializedBlockCacheHits()
+{
+    return g_serialized_block_cache.GetHits();
+}
+
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
  * to compatible peers.
@@ -1360,9 +1396,8 @@ void PeerManager::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_
                 !PeerHasHeader(&state, pindex) && PeerHasHeader(&state, pindex->pprev)) {
 
             bool fPeerWantsWitness = State(pnode->GetId())->fWantsCmpctWitness;
-            bool fPeerWantsMWEB = State(pnode->GetId())->fWantsCmpctMWEB;
             int nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
-            nSendFlags |= fPeerWantsMWEB ? 0 : SERIALIZE_NO_MWEB;
+            nSendFlags |= GetCmpctMWEBFlags(*pnode, state);
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
@@ -1478,6 +1513,61 @@ bool static AlreadyHaveTx(const GenTxid& gtxid, const CTxMemPool& mempool) EXCLU
     return recentRejects->contains(hash) || mempool.exists(gtxid);
 }
 
+/**
+ * MWEB transactions are often relayed in bursts, but each "tx" message is accepted to the
+ * mempool on its own. Before accepting an MWEB transaction that wasn't part of an earlier batch,
+ * deserialize the peer's other queued "tx" messages, and batch verify the MWEB signatures and
+ * range proofs of the transactions that pass the cheap checks AcceptToMemoryPool starts with.
+ * If the batch is valid, the results are cached, so accepting each of these transactions skips
+ * the crypto checks. Otherwise, each is verified on its own. The queued transactions are kept in
+ * the Peer, so their messages aren't deserialized again when they are processed.
+ */
+static void BatchVerifyQueuedMWEBTxs(CNode& node, Peer& peer, const CTransactionRef& tx, const CTxMemPool& mempool, const Consensus::Params& consensus) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (!IsMWEBEnabled(::ChainActive().Tip(), consensus)) return;
+
+    auto passes_cheap_checks = [&mempool](const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        TxValidationState state;
+        std::string reason;
+        return tx.HasMWEBTx() &&
+               CheckTransaction(tx, state) &&
+               !tx.IsCoinBase() && !tx.IsHogEx() &&
+               (!fRequireStandard || IsStandardTx(tx, reason)) &&
+               !AlreadyHaveTx(GenTxid(/* is_wtxid=*/true, tx.GetWitnessHash()), mempool);
+    };
+    if (!passes_cheap_checks(*tx)) return;
+
+    std::vector<CTransactionRef> txs{tx};
+    {
+        LOCK(node.cs_vProcessMsg);
+        for (CNetMessage& queued : node.vProcessMsg) {
+            if (peer.m_mweb_batched_txs.size() + 1 >= MAX_MWEB_TX_BATCH_SIZE) break;
+            if (queued.m_command != NetMsgType::TX) continue;
+
+            CTransactionRef queued_tx;
+            try {
+                queued.SetVersion(node.GetCommonVersion());
+                queued.m_recv >> queued_tx;
+            } catch (const std::exception&) {
+                // Rejected as malformed when the message is processed.
+                queued_tx = nullptr;
+            }
+
+            peer.m_mweb_batched_txs.emplace_back(&queued.m_recv, queued_tx);
+            if (queued_tx != nullptr && passes_cheap_checks(*queued_tx)) {
+                txs.push_back(std::move(queued_tx));
+            }
+        }
+    }
+
+    // A lone transaction gains nothing from batching.
+    if (txs.size() < 2) return;
+
+    if (!MWEB::Node::BatchVerifyTransactions(txs)) {
+        LogPrint(BCLog::MEMPOOL, "MWEB batch of %u transactions from peer=%d failed, verifying each on its own\n", txs.size(), node.GetId());
+    }
+}
+
 bool static AlreadyHaveBlock(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     return LookupBlockIndex(block_hash) != nullptr;
@@ -1537,9 +1627,49 @@ static void RelayAddress(const CAddress& addr, bool fReachable, const CConnman&
     connman.ForEachNodeThen(std::move(sortfunc), std::move(pushfunc));
 }
 
-void static ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, const CInv& inv, CConnman& connman)
+/**
+ * Send a block serialized with the given flags. A block sent with all of its data is
+ * read from disk as is, since the network format matches the format on disk. Blocks
+ * stripped of their witness or MWEB data are cached, if they're near the tip.
+ * Returns false if the block couldn't be read from disk.
+ */
+static bool PushSerializedBlock(CNode& pfrom, CConnman& connman, const uint256& block_hash, const FlatFilePos& block_pos, bool cache_eligible, int flags, const std::shared_ptr<const CBlock>& pblock, const CChainParams& chainparams) LOCKS_EXCLUDED(cs_main)
+{
+    if (flags == 0 && !pblock) {
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        if (!ReadRawBlockFromDisk(msg.data, block_pos, chainparams.MessageStart())) {
+            return false;
+        }
+        connman.PushMessage(&pfrom, std::move(msg));
+        return true;
+    }
+
+    const bool cache = flags != 0 && cache_eligible;
+    SerializedBlockCache::Data data = cache ? g_serialized_block_cache.Get(block_hash, flags) : nullptr;
+    if (!data) {
+        std::shared_ptr<const CBlock> block = pblock;
+        if (!block) {
+            std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockRead, block_pos, block_hash, chainparams.GetConsensus())) {
+                return false;
+            }
+            block = pblockRead;
+        }
+
+        auto serialized = std::make_shared<std::vector<uint8_t>>();
+        CVectorWriter{SER_NETWORK, PROTOCOL_VERSION | flags, *serialized, 0, *block};
+        data = serialized;
+        if (cache) g_serialized_block_cache.Put(block_hash, flags, data);
+    }
+
+    const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
+    connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, MakeSpan(*data)));
+    return true;
+}
+
+void static ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, const CInv& inv, CConnman& connman) LOCKS_EXCLUDED(cs_main)
 {
-    bool send = false;
     std::shared_ptr<const CBlock> a_recent_block;
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
     bool fWitnessesPresentInARecentCompactBlock;
@@ -1576,125 +1706,147 @@ void static ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, c
         }
     }
 
-    LOCK(cs_main);
-    const CBlockIndex* pindex = LookupBlockIndex(inv.hash);
-    if (pindex) {
-        send = BlockRequestAllowed(pindex, consensusParams);
-        if (!send) {
+    // Everything needed from the block index and the peer's state is looked up under
+    // cs_main, which is released before the block is read from disk and serialized.
+    FlatFilePos block_pos;
+    bool cache_eligible;
+    bool can_send_cmpct = false;
+    bool fPeerWantsWitness = false;
+    bool fPeerWantsMWEB = false;
+    int nSendFlags = 0;
+    int nCmpctSendFlags = 0;
+    uint256 continue_hash;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pindex = LookupBlockIndex(inv.hash);
+        if (!pindex) {
+            return;
+        }
+        if (!BlockRequestAllowed(pindex, consensusParams)) {
             LogPrint(BCLog::NET, "%s: ignoring request from peer=%i for old block that isn't in the main chain\n", __func__, pfrom.GetId());
+            return;
+        }
+        // disconnect node in case we have reached the outbound limit for serving historical blocks
+        if (connman.OutboundTargetReached(true) &&
+            (((pindexBestHeader != nullptr) && (pindexBestHeader->GetBlockTime() - pindex->GetBlockTime() > HISTORICAL_BLOCK_AGE)) || inv.IsMsgFilteredBlk()) &&
+            !pfrom.HasPermission(PF_DOWNLOAD) // nodes with the download permission may exceed target
+        ) {
+            LogPrint(BCLog::NET, "historical block serving limit reached, disconnect peer=%d\n", pfrom.GetId());
+
+            //disconnect node
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Avoid leaking prune-height by never sending blocks below the NODE_NETWORK_LIMITED threshold
+        if (!pfrom.HasPermission(PF_NOBAN) && (
+                (((pfrom.GetLocalServices() & NODE_NETWORK_LIMITED) == NODE_NETWORK_LIMITED) && ((pfrom.GetLocalServices() & NODE_NETWORK) != NODE_NETWORK) && (::ChainActive().Tip()->nHeight - pindex->nHeight > (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2 /* add two blocks buffer extension for possible races */) )
+           )) {
+            LogPrint(BCLog::NET, "Ignore block request below NODE_NETWORK_LIMITED threshold from peer=%d\n", pfrom.GetId());
+
+            //disconnect node and prevent it from stalling (would otherwise wait for the missing block)
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Pruned nodes may have deleted the block, so check whether
+        // it's available before trying to send.
+        if (!(pindex->nStatus & BLOCK_HAVE_DATA)) {
+            return;
+        }
+        block_pos = pindex->GetBlockPos();
+        cache_eligible = pindex->nHeight + (int)NODE_NETWORK_LIMITED_MIN_BLOCKS >= ::ChainActive().Height();
+        if (inv.IsMsgCmpctBlk()) {
+            const CNodeState& state = *State(pfrom.GetId());
+            fPeerWantsWitness = state.fWantsCmpctWitness;
+            fPeerWantsMWEB = state.fWantsCmpctMWEB;
+            nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
+            nSendFlags |= fPeerWantsMWEB ? 0 : SERIALIZE_NO_MWEB;
+            nCmpctSendFlags = nSendFlags | GetCmpctMWEBFlags(pfrom, state);
+            can_send_cmpct = CanDirectFetch(consensusParams) && pindex->nHeight >= ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH;
+        }
+        // Trigger the peer node to send a getblocks request for the next batch of inventory
+        if (inv.hash == pfrom.hashContinue) {
+            continue_hash = ::ChainActive().Tip()->GetBlockHash();
+            pfrom.hashContinue.SetNull();
         }
     }
+
     const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
-    // disconnect node in case we have reached the outbound limit for serving historical blocks
-    if (send &&
-        connman.OutboundTargetReached(true) &&
-        (((pindexBestHeader != nullptr) && (pindexBestHeader->GetBlockTime() - pindex->GetBlockTime() > HISTORICAL_BLOCK_AGE)) || inv.IsMsgFilteredBlk()) &&
-        !pfrom.HasPermission(PF_DOWNLOAD) // nodes with the download permission may exceed target
-    ) {
-        LogPrint(BCLog::NET, "historical block serving limit reached, disconnect peer=%d\n", pfrom.GetId());
-
-        //disconnect node
-        pfrom.fDisconnect = true;
-        send = false;
+    const std::shared_ptr<const CBlock> recent_block = a_recent_block && a_recent_block->GetHash() == inv.hash ? a_recent_block : nullptr;
+
+    bool read_ok = true;
+    std::shared_ptr<const CBlock> pblock;
+    if (inv.IsMsgBlk()) {
+        read_ok = PushSerializedBlock(pfrom, connman, inv.hash, block_pos, cache_eligible, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB, recent_block, chainparams);
+    } else if (inv.IsMsgWitnessBlk()) {
+        read_ok = PushSerializedBlock(pfrom, connman, inv.hash, block_pos, cache_eligible, SERIALIZE_NO_MWEB, recent_block, chainparams);
+    } else if (inv.IsMsgMWEBBlk()) {
+        read_ok = PushSerializedBlock(pfrom, connman, inv.hash, block_pos, cache_eligible, 0, recent_block, chainparams);
+    } else if (inv.IsMsgCmpctBlk() && !can_send_cmpct) {
+        // If a peer is asking for old blocks, we're almost guaranteed
+        // they won't have a useful mempool to match against a compact block,
+        // and we don't feel like constructing the object for them, so
+        // instead we respond with the full, non-compact block. It's sent
+        // before the block is read, so the raw path or the cache can serve it.
+        read_ok = PushSerializedBlock(pfrom, connman, inv.hash, block_pos, cache_eligible, nSendFlags, recent_block, chainparams);
+    } else if (recent_block) {
+        pblock = recent_block;
+    } else {
+        // Send block from disk
+        std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+        read_ok = ReadBlockFromDisk(*pblockRead, block_pos, inv.hash, consensusParams);
+        if (read_ok) pblock = pblockRead;
+    }
+    if (pblock) {
+        if (inv.IsMsgFilteredBlk()) {
+            bool sendMerkleBlock = false;
+            CMerkleBlock merkleBlock;
+            if (pfrom.m_tx_relay != nullptr) {
+                LOCK(pfrom.m_tx_relay->cs_filter);
+                if (pfrom.m_tx_relay->pfilter) {
+                    sendMerkleBlock = true;
+                    merkleBlock = CMerkleBlock(*pblock, *pfrom.m_tx_relay->pfilter);
+                }
+            }
+            if (sendMerkleBlock) {
+                connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::MERKLEBLOCK, merkleBlock));
+                // CMerkleBlock just contains hashes, so also push any transactions in the block the client did not see
+                // This avoids hurting performance by pointlessly requiring a round-trip
+                // Note that there is currently no way for a node to request any single transactions we didn't send here -
+                // they must either disconnect and retry or request the full block.
+                // Thus, the protocol spec specified allows for us to provide duplicate txn here,
+                // however we MUST always provide at least what the remote peer needs
+                typedef std::pair<unsigned int, uint256> PairType;
+                for (PairType& pair : merkleBlock.vMatchedTxn)
+                    connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB, NetMsgType::TX, *pblock->vtx[pair.first]));
+            }
+            // else
+                // no response
+        } else if (inv.IsMsgCmpctBlk()) {
+            if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && (fPeerWantsMWEB || !fMWEBPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == inv.hash) {
+                connman.PushMessage(&pfrom, msgMaker.Make(nCmpctSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
+            } else {
+                CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
+                connman.PushMessage(&pfrom, msgMaker.Make(nCmpctSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+            }
+        }
     }
-    // Avoid leaking prune-height by never sending blocks below the NODE_NETWORK_LIMITED threshold
-    if (send && !pfrom.HasPermission(PF_NOBAN) && (
-            (((pfrom.GetLocalServices() & NODE_NETWORK_LIMITED) == NODE_NETWORK_LIMITED) && ((pfrom.GetLocalServices() & NODE_NETWORK) != NODE_NETWORK) && (::ChainActive().Tip()->nHeight - pindex->nHeight > (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2 /* add two blocks buffer extension for possible races */) )
-       )) {
-        LogPrint(BCLog::NET, "Ignore block request below NODE_NETWORK_LIMITED threshold from peer=%d\n", pfrom.GetId());
 
-        //disconnect node and prevent it from stalling (would otherwise wait for the missing block)
+    // The block may have been pruned since cs_main was released, so a failed
+    // read disconnects the peer rather than being treated as fatal.
+    if (!read_ok) {
+        LogPrint(BCLog::NET, "Cannot load block %s from disk, disconnect peer=%d\n", inv.hash.ToString(), pfrom.GetId());
         pfrom.fDisconnect = true;
-        send = false;
+        return;
     }
-    // Pruned nodes may have deleted the block, so check whether
-    // it's available before trying to send.
-    if (send && (pindex->nStatus & BLOCK_HAVE_DATA))
-    {
-        std::shared_ptr<const CBlock> pblock;
-        if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
-            pblock = a_recent_block;
-        } else if (inv.IsMsgMWEBBlk()) {
-            // Fast-path: in this case it is possible to serve the block directly from disk,
-            // as the network format matches the format on disk
-            std::vector<uint8_t> block_data;
-            if (!ReadRawBlockFromDisk(block_data, pindex, chainparams.MessageStart())) {
-                assert(!"cannot load block from disk");
-            }
-            connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, MakeSpan(block_data)));
-            // Don't set pblock as we've sent the block
-        } else {
-            // Send block from disk
-            std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
-            if (!ReadBlockFromDisk(*pblockRead, pindex, consensusParams))
-                assert(!"cannot load block from disk");
-            pblock = pblockRead;
-        }
-        if (pblock) {
-            if (inv.IsMsgBlk()) {
-                connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB, NetMsgType::BLOCK, *pblock));
-            } else if (inv.IsMsgWitnessBlk()) {
-                connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_NO_MWEB, NetMsgType::BLOCK, *pblock));
-            } else if (inv.IsMsgMWEBBlk()) {
-                connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
-            } else if (inv.IsMsgFilteredBlk()) {
-                bool sendMerkleBlock = false;
-                CMerkleBlock merkleBlock;
-                if (pfrom.m_tx_relay != nullptr) {
-                    LOCK(pfrom.m_tx_relay->cs_filter);
-                    if (pfrom.m_tx_relay->pfilter) {
-                        sendMerkleBlock = true;
-                        merkleBlock = CMerkleBlock(*pblock, *pfrom.m_tx_relay->pfilter);
-                    }
-                }
-                if (sendMerkleBlock) {
-                    connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::MERKLEBLOCK, merkleBlock));
-                    // CMerkleBlock just contains hashes, so also push any transactions in the block the client did not see
-                    // This avoids hurting performance by pointlessly requiring a round-trip
-                    // Note that there is currently no way for a node to request any single transactions we didn't send here -
-                    // they must either disconnect and retry or request the full block.
-                    // Thus, the protocol spec specified allows for us to provide duplicate txn here,
-                    // however we MUST always provide at least what the remote peer needs
-                    typedef std::pair<unsigned int, uint256> PairType;
-                    for (PairType& pair : merkleBlock.vMatchedTxn)
-                        connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB, NetMsgType::TX, *pblock->vtx[pair.first]));
-                }
-                // else
-                    // no response
-            } else if (inv.IsMsgCmpctBlk()) {
-                // If a peer is asking for old blocks, we're almost guaranteed
-                // they won't have a useful mempool to match against a compact block,
-                // and we don't feel like constructing the object for them, so
-                // instead we respond with the full, non-compact block.
-                bool fPeerWantsWitness = State(pfrom.GetId())->fWantsCmpctWitness;
-                bool fPeerWantsMWEB = State(pfrom.GetId())->fWantsCmpctMWEB;
-                int nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
-                nSendFlags |= fPeerWantsMWEB ? 0 : SERIALIZE_NO_MWEB;
-
-                if (CanDirectFetch(consensusParams) && pindex->nHeight >= ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH) {
-                    if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && (fPeerWantsMWEB || !fMWEBPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
-                        connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
-                    } else {
-                        CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
-                        connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
-                    }
-                } else {
-                    connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCK, *pblock));
-                }
-            }
-        }
 
-        // Trigger the peer node to send a getblocks request for the next batch of inventory
-        if (inv.hash == pfrom.hashContinue)
-        {
-            // Send immediately. This must send even if redundant,
-            // and we want it right after the last block so they don't
-            // wait for other stuff first.
-            std::vector<CInv> vInv;
-            vInv.push_back(CInv(MSG_BLOCK, ::ChainActive().Tip()->GetBlockHash()));
-            connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::INV, vInv));
-            pfrom.hashContinue.SetNull();
-        }
+    if (!continue_hash.IsNull())
+    {
+        // Send immediately. This must send even if redundant,
+        // and we want it right after the last block so they don't
+        // wait for other stuff first.
+        std::vector<CInv> vInv;
+        vInv.push_back(CInv(MSG_BLOCK, continue_hash));
+        connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::INV, vInv));
     }
 }
 
@@ -1841,10 +1993,20 @@ void PeerManager::SendBlockTransactions(CNode& pfrom, const CBlock& block, const
         }
         resp.txn[i] = block.vtx[req.indexes[i]];
     }
+    if (!req.mweb_req.IsNull()) {
+        if (block.mweb_block.IsNull()) {
+            Misbehaving(pfrom.GetId(), 100, "getblocktxn with MWEB indices for a block without MWEB");
+            return;
+        }
+        if (!FillMWEBTransactions(resp.mweb_txn, *block.mweb_block.m_block, req.mweb_req)) {
+            Misbehaving(pfrom.GetId(), 100, "getblocktxn with out-of-bounds MWEB indices");
+            return;
+        }
+    }
     LOCK(cs_main);
     const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
     int nSendFlags = State(pfrom.GetId())->fWantsCmpctWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
-    nSendFlags |= State(pfrom.GetId())->fWantsCmpctMWEB ? 0 : SERIALIZE_NO_MWEB;
+    nSendFlags |= GetCmpctMWEBFlags(pfrom, *State(pfrom.GetId()));
 
     m_connman.PushMessage(&pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCKTXN, resp));
 }
@@ -2129,7 +2291,7 @@ void PeerManager::ProcessOrphanTx(std::set<uint256>& orphan_work_set)
  *
  * @param[in]   peer            The peer that we received the request from
  * @param[in]   chain_params    Chain parameters
- * @param[in]   filter_type     The filter type the request is for. Must be basic filters.
+ * @param[in]   filter_type     The filter type the request is for. Must be basic or MWEB filters.
  * @param[in]   start_height    The start height for the request
  * @param[in]   stop_hash       The stop_hash for the request
  * @param[in]   max_height_diff The maximum number of items permitted to request, as specified in BIP 157
@@ -2144,7 +2306,7 @@ static bool PrepareBlockFilterRequest(CNode& peer, const CChainParams& chain_par
                                       BlockFilterIndex*& filter_index)
 {
     const bool supported_filter_type =
-        (filter_type == BlockFilterType::BASIC &&
+        ((filter_type == BlockFilterType::BASIC || filter_type == BlockFilterType::MWEB) &&
          (peer.GetLocalServices() & NODE_COMPACT_FILTERS));
     if (!supported_filter_type) {
         LogPrint(BCLog::NET, "peer %d requested unsupported block filter type: %d\n",
@@ -2858,7 +3020,10 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
         {
             LOCK(peer->m_getdata_requests_mutex);
             peer->m_getdata_requests.insert(peer->m_getdata_requests.end(), vInv.begin(), vInv.end());
-            ProcessGetData(pfrom, *peer, m_chainparams, m_connman, m_mempool, interruptMsgProc);
+            // With message workers, ProcessMessages queues the requests on a worker instead
+            if (!m_connman.HasMessageWorkers()) {
+                ProcessGetData(pfrom, *peer, m_chainparams, m_connman, m_mempool, interruptMsgProc);
+            }
         }
 
         return;
@@ -2933,6 +3098,7 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
     }
 
     if (msg_type == NetMsgType::GETBLOCKTXN) {
+        WITH_LOCK(cs_main, vRecv.SetVersion(vRecv.GetVersion() | GetCmpctMWEBFlags(pfrom, *State(pfrom.GetId()))));
         BlockTransactionsRequest req;
         vRecv >> req;
 
@@ -2995,58 +3161,61 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             return;
         }
 
-        LOCK(cs_main);
-        if (::ChainstateActive().IsInitialBlockDownload() && !pfrom.HasPermission(PF_DOWNLOAD)) {
-            LogPrint(BCLog::NET, "Ignoring getheaders from peer=%d because node is in initial block download\n", pfrom.GetId());
-            return;
-        }
-
-        CNodeState *nodestate = State(pfrom.GetId());
-        const CBlockIndex* pindex = nullptr;
-        if (locator.IsNull())
+        // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
+        std::vector<CBlock> vHeaders;
         {
-            // If locator is null, return the hashStop block
-            pindex = LookupBlockIndex(hashStop);
-            if (!pindex) {
+            LOCK(cs_main);
+            if (::ChainstateActive().IsInitialBlockDownload() && !pfrom.HasPermission(PF_DOWNLOAD)) {
+                LogPrint(BCLog::NET, "Ignoring getheaders from peer=%d because node is in initial block download\n", pfrom.GetId());
                 return;
             }
 
-            if (!BlockRequestAllowed(pindex, m_chainparams.GetConsensus())) {
-                LogPrint(BCLog::NET, "%s: ignoring request from peer=%i for old block header that isn't in the main chain\n", __func__, pfrom.GetId());
-                return;
+            CNodeState *nodestate = State(pfrom.GetId());
+            const CBlockIndex* pindex = nullptr;
+            if (locator.IsNull())
+            {
+                // If locator is null, return the hashStop block
+                pindex = LookupBlockIndex(hashStop);
+                if (!pindex) {
+                    return;
+                }
+
+                if (!BlockRequestAllowed(pindex, m_chainparams.GetConsensus())) {
+                    LogPrint(BCLog::NET, "%s: ignoring request from peer=%i for old block header that isn't in the main chain\n", __func__, pfrom.GetId());
+                    return;
+                }
+            }
+            else
+            {
+                // Find the last block the caller has in the main chain
+                pindex = FindForkInGlobalIndex(::ChainActive(), locator);
+                if (pindex)
+                    pindex = ::ChainActive().Next(pindex);
             }
-        }
-        else
-        {
-            // Find the last block the caller has in the main chain
-            pindex = FindForkInGlobalIndex(::ChainActive(), locator);
-            if (pindex)
-                pindex = ::ChainActive().Next(pindex);
-        }
 
-        // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
-        std::vector<CBlock> vHeaders;
-        int nLimit = MAX_HEADERS_RESULTS;
-        LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom.GetId());
-        for (; pindex; pindex = ::ChainActive().Next(pindex))
-        {
-            vHeaders.push_back(pindex->GetBlockHeader());
-            if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
-                break;
-        }
-        // pindex can be nullptr either if we sent ::ChainActive().Tip() OR
-        // if our peer has ::ChainActive().Tip() (and thus we are sending an empty
-        // headers message). In both cases it's safe to update
-        // pindexBestHeaderSent to be our tip.
-        //
-        // It is important that we simply reset the BestHeaderSent value here,
-        // and not max(BestHeaderSent, newHeaderSent). We might have announced
-        // the currently-being-connected tip using a compact block, which
-        // resulted in the peer sending a headers request, which we respond to
-        // without the new block. By resetting the BestHeaderSent, we ensure we
-        // will re-announce the new block via headers (or compact blocks again)
-        // in the SendMessages logic.
-        nodestate->pindexBestHeaderSent = pindex ? pindex : ::ChainActive().Tip();
+            int nLimit = MAX_HEADERS_RESULTS;
+            LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom.GetId());
+            for (; pindex; pindex = ::ChainActive().Next(pindex))
+            {
+                vHeaders.push_back(pindex->GetBlockHeader());
+                if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
+                    break;
+            }
+            // pindex can be nullptr either if we sent ::ChainActive().Tip() OR
+            // if our peer has ::ChainActive().Tip() (and thus we are sending an empty
+            // headers message). In both cases it's safe to update
+            // pindexBestHeaderSent to be our tip.
+            //
+            // It is important that we simply reset the BestHeaderSent value here,
+            // and not max(BestHeaderSent, newHeaderSent). We might have announced
+            // the currently-being-connected tip using a compact block, which
+            // resulted in the peer sending a headers request, which we respond to
+            // without the new block. By resetting the BestHeaderSent, we ensure we
+            // will re-announce the new block via headers (or compact blocks again)
+            // in the SendMessages logic.
+            nodestate->pindexBestHeaderSent = pindex ? pindex : ::ChainActive().Tip();
+        }
+        // Serializing and queueing up to MAX_HEADERS_RESULTS headers doesn't need cs_main.
         m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::HEADERS, vHeaders));
         return;
     }
@@ -3063,7 +3232,16 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
         }
 
         CTransactionRef ptx;
-        vRecv >> ptx;
+        if (!peer->m_mweb_batched_txs.empty() && peer->m_mweb_batched_txs.front().first == &vRecv) {
+            // Deserialized when its MWEB data was batch verified
+            ptx = std::move(peer->m_mweb_batched_txs.front().second);
+            peer->m_mweb_batched_txs.pop_front();
+            if (ptx == nullptr) {
+                throw std::ios_base::failure("Malformed tx message");
+            }
+        } else {
+            vRecv >> ptx;
+        }
         const CTransaction& tx = *ptx;
 
         const uint256& txid = ptx->GetHash();
@@ -3114,6 +3292,10 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             return;
         }
 
+        if (peer->m_mweb_batched_txs.empty()) {
+            BatchVerifyQueuedMWEBTxs(pfrom, *peer, ptx, m_mempool, m_chainparams.GetConsensus());
+        }
+
         TxValidationState state;
         std::list<CTransactionRef> lRemovedTxn;
 
@@ -3279,9 +3461,7 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             LOCK(cs_main);
             CBlockIndex* pTip = ::ChainActive().Tip();
             assert(pTip);
-            if (!State(pfrom.GetId())->fWantsCmpctMWEB) {
-                vRecv.SetVersion(vRecv.GetVersion() | SERIALIZE_NO_MWEB);
-            }
+            vRecv.SetVersion(vRecv.GetVersion() | GetCmpctMWEBFlags(pfrom, *State(pfrom.GetId())));
         }
 
         CBlockHeaderAndShortTxIDs cmpctblock;
@@ -3412,15 +3592,18 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
                     if (!partialBlock.IsTxAvailable(i))
                         req.indexes.push_back(i);
                 }
-                if (req.indexes.empty()) {
+                req.mweb_req = partialBlock.GetMissingMWEB();
+                const int nCmpctMWEBFlags = GetCmpctMWEBFlags(pfrom, *nodestate);
+                if (req.indexes.empty() && req.mweb_req.IsNull()) {
                     // Dirty hack to jump to BLOCKTXN code (TODO: move message handling into their own functions)
                     BlockTransactions txn;
                     txn.blockhash = cmpctblock.header.GetHash();
+                    blockTxnMsg.SetVersion(blockTxnMsg.GetVersion() | nCmpctMWEBFlags);
                     blockTxnMsg << txn;
                     fProcessBLOCKTXN = true;
                 } else {
                     req.blockhash = pindex->GetBlockHash();
-                    m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::GETBLOCKTXN, req));
+                    m_connman.PushMessage(&pfrom, msgMaker.Make(nCmpctMWEBFlags, NetMsgType::GETBLOCKTXN, req));
                 }
             } else {
                 // This block is either already in flight from a different
@@ -3512,6 +3695,7 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             return;
         }
 
+        WITH_LOCK(cs_main, vRecv.SetVersion(vRecv.GetVersion() | GetCmpctMWEBFlags(pfrom, *State(pfrom.GetId()))));
         BlockTransactions resp;
         vRecv >> resp;
 
@@ -3528,7 +3712,7 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             }
 
             PartiallyDownloadedBlock& partialBlock = *it->second.second->partialBlock;
-            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn);
+            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn, resp.mweb_txn);
             if (status == READ_STATUS_INVALID) {
                 MarkBlockAsReceived(resp.blockhash); // Reset in-flight state in case Misbehaving does not result in a disconnect
                 Misbehaving(pfrom.GetId(), 100, "invalid compact block/non-matching block transactions");
@@ -3938,6 +4122,36 @@ bool PeerManager::MaybeDiscourageAndDisconnect(CNode& pnode)
     return true;
 }
 
+/** Messages that only read chain and mempool state, which may be served on a message worker thread */
+static bool IsReadOnlyMessage(const std::string& msg_type)
+{
+    return msg_type == NetMsgType::GETHEADERS ||
+           msg_type == NetMsgType::GETCFILTERS ||
+           msg_type == NetMsgType::GETCFHEADERS ||
+           msg_type == NetMsgType::GETCFCHECKPT;
+}
+
+/** Run work for a peer on a message worker thread, holding back its other messages until it's done */
+static void QueueMessageWork(CConnman& connman, CNode& node, const PeerRef& peer, std::function<void()> work)
+{
+    peer->m_worker_busy = true;
+    connman.QueueMessageWork(&node, [peer, work]() {
+        work();
+        peer->m_worker_busy = false;
+    });
+}
+
+void PeerManager::TryProcessMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc)
+{
+    try {
+        ProcessMessage(pfrom, msg.m_command, msg.m_recv, msg.m_time, interruptMsgProc);
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::NET, "ProcessMessages(%s, %u bytes): Exception '%s' (%s) caught\n", SanitizeString(msg.m_command), msg.m_message_size, e.what(), typeid(e).name());
+    } catch (...) {
+        LogPrint(BCLog::NET, "ProcessMessages(%s, %u bytes): Unknown exception caught\n", SanitizeString(msg.m_command), msg.m_message_size);
+    }
+}
+
 bool PeerManager::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
 {
     bool fMoreWork = false;
@@ -3945,9 +4159,21 @@ bool PeerManager::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgP
     PeerRef peer = GetPeerRef(pfrom->GetId());
     if (peer == nullptr) return false;
 
+    // A message worker is serving this peer. Its other messages wait until
+    // it's done, so they're still processed in the order they were received.
+    if (peer->m_worker_busy) return false;
+
     {
         LOCK(peer->m_getdata_requests_mutex);
         if (!peer->m_getdata_requests.empty()) {
+            if (m_connman.HasMessageWorkers()) {
+                CNode* node = pfrom;
+                QueueMessageWork(m_connman, *pfrom, peer, [this, node, peer, &interruptMsgProc]() {
+                    LOCK(peer->m_getdata_requests_mutex);
+                    ProcessGetData(*node, *peer, m_chainparams, m_connman, m_mempool, interruptMsgProc);
+                });
+                return false;
+            }
             ProcessGetData(*pfrom, *peer, m_chainparams, m_connman, m_mempool, interruptMsgProc);
         }
     }
@@ -3979,6 +4205,7 @@ bool PeerManager::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgP
         return false;
 
     std::list<CNetMessage> msgs;
+    bool resume_recv;
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty())
@@ -3986,28 +4213,31 @@ bool PeerManager::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgP
         // Just take one message
         msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
         pfrom->nProcessQueueSize -= msgs.front().m_raw_message_size;
-        pfrom->fPauseRecv = pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
+        const bool pause_recv = pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
+        resume_recv = pfrom->fPauseRecv && !pause_recv;
+        pfrom->fPauseRecv = pause_recv;
         fMoreWork = !pfrom->vProcessMsg.empty();
     }
+    if (resume_recv) m_connman.MarkNodeReady(*pfrom);
     CNetMessage& msg(msgs.front());
 
     msg.SetVersion(pfrom->GetCommonVersion());
     const std::string& msg_type = msg.m_command;
 
-    // Message size
-    unsigned int nMessageSize = msg.m_message_size;
+    if (m_connman.HasMessageWorkers() && IsReadOnlyMessage(msg_type)) {
+        CNode* node = pfrom;
+        auto pmsg = std::make_shared<CNetMessage>(std::move(msg));
+        QueueMessageWork(m_connman, *pfrom, peer, [this, node, pmsg, &interruptMsgProc]() {
+            TryProcessMessage(*node, *pmsg, interruptMsgProc);
+        });
+        return false;
+    }
 
-    try {
-        ProcessMessage(*pfrom, msg_type, msg.m_recv, msg.m_time, interruptMsgProc);
-        if (interruptMsgProc) return false;
-        {
-            LOCK(peer->m_getdata_requests_mutex);
-            if (!peer->m_getdata_requests.empty()) fMoreWork = true;
-        }
-    } catch (const std::exception& e) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg_type), nMessageSize, e.what(), typeid(e).name());
-    } catch (...) {
-        LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg_type), nMessageSize);
+    TryProcessMessage(*pfrom, msg, interruptMsgProc);
+    if (interruptMsgProc) return false;
+    {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty()) fMoreWork = true;
     }
 
     return fMoreWork;
@@ -4364,7 +4594,7 @@ bool PeerManager::SendMessages(CNode* pto)
                             vHeaders.front().GetHash().ToString(), pto->GetId());
 
                     int nSendFlags = state.fWantsCmpctWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
-                    nSendFlags |= state.fWantsCmpctMWEB ? 0 : SERIALIZE_NO_MWEB;
+                    nSendFlags |= GetCmpctMWEBFlags(*pto, state);
 
                     bool fGotBlockFromCache = false;
                     {
@@ -123,6 +123,9 @@ private:
      */
     bool MaybeDiscourageAndDisconnect(CNode& pnode);
 
+    /** Process a single message from a peer, logging any exception it throws. */
+    void TryProcessMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc);
+
     void ProcessOrphanTx(std::set<uint256>& orphan_work_set) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_cs_orphans);
     /** Process a single headers message from a peer. */
     void ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlockHeader>& headers, bool via_compact_block);
@@ -158,6 +161,9 @@ struct CNodeStateStats {
 /** Get statistics from node state */
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
 
+/** Get the number of block requests served from the cache of serialized blocks */
+uint64_t GetSerializedBlockCacheHits();
+
 /** Relay transaction to every node */
 void RelayTransaction(const uint256& txid, const uint256& wtxid, const CConnman& connman) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
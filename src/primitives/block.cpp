@@ -18,8 +18,11 @@ uint256 CBlockHeader::GetHash() const
 
 uint256 CBlockHeader::GetPoWHash() const
 {
+    // Allocating and faulting in the 2 MiB scratchpad costs about as much as
+    // the hash itself, so every thread keeps one context alive and reuses it.
+    static thread_local cn_pow_hash_v3 ctx;
+
     uint256 thash;
-    cn_pow_hash_v3 ctx;
     ctx.hash(BEGIN(nVersion), 80, BEGIN(thash));
     return thash;
 }
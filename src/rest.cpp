@@ -7,11 +7,13 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/mwebindex.h>
 #include <index/txindex.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <streams.h>
@@ -150,6 +152,18 @@ static bool CheckWarmup(HTTPRequest* req)
     return true;
 }
 
+/** Send a JSON reply in chunks, as write_json writes it */
+static void StreamJSONReply(HTTPRequest* req, const std::function<void(JSONStreamWriter&)>& write_json)
+{
+    req->WriteHeader("Content-Type", "application/json");
+    req->StartChunkedReply(HTTP_OK);
+    JSONStreamWriter stream([req](std::string&& chunk) { req->WriteReplyChunk(std::move(chunk)); });
+    write_json(stream);
+    stream.Flush();
+    req->WriteReplyChunk("\n");
+    req->EndChunkedReply();
+}
+
 static bool rest_headers(const util::Ref& context,
                          HTTPRequest* req,
                          const std::string& strURIPart)
@@ -279,10 +293,9 @@ static bool rest_block(HTTPRequest* req,
     }
 
     case RetFormat::JSON: {
-        UniValue objBlock = blockToJSON(block, tip, pblockindex, showTxDetails);
-        std::string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        StreamJSONReply(req, [&](JSONStreamWriter& stream) {
+            blockToJSON(block, tip, pblockindex, showTxDetails, stream);
+        });
         return true;
     }
 
@@ -362,11 +375,9 @@ static bool rest_mempool_contents(const util::Ref& context, HTTPRequest* req, co
 
     switch (rf) {
     case RetFormat::JSON: {
-        UniValue mempoolObject = MempoolToJSON(*mempool, true);
-
-        std::string strJSON = mempoolObject.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        StreamJSONReply(req, [&](JSONStreamWriter& stream) {
+            MempoolToJSON(*mempool, stream);
+        });
         return true;
     }
     default: {
@@ -434,6 +445,64 @@ static bool rest_tx(const util::Ref& context, HTTPRequest* req, const std::strin
     }
 }
 
+static bool rest_mweboutput(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    if (hashStr.size() != 64 || !IsHex(hashStr))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid output id: " + hashStr);
+    const mw::Hash output_id = mw::Hash::FromHex(hashStr);
+
+    if (!g_mwebindex) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Requires -mwebindex");
+    }
+    g_mwebindex->BlockUntilSyncedToCurrentChain();
+
+    uint256 block_hash;
+    MWEBOutputPos pos;
+    Output output;
+    if (!g_mwebindex->FindOutput(output_id, block_hash, pos, output)) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        CDataStream ssOutput(SER_NETWORK, PROTOCOL_VERSION);
+        ssOutput << output;
+
+        std::string binaryOutput = ssOutput.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryOutput);
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        CDataStream ssOutput(SER_NETWORK, PROTOCOL_VERSION);
+        ssOutput << output;
+
+        std::string strHex = HexStr(ssOutput) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue objOutput = mwebIndexedOutputToJSON(output, block_hash, pos);
+        std::string strJSON = objOutput.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static bool rest_getutxos(const util::Ref& context, HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -669,23 +738,26 @@ static bool rest_blockhash_by_height(const util::Ref& context, HTTPRequest* req,
 static const struct {
     const char* prefix;
     bool (*handler)(const util::Ref& context, HTTPRequest* req, const std::string& strReq);
+    HTTPWorkClass work_class;
 } uri_prefixes[] = {
-      {"/rest/tx/", rest_tx},
-      {"/rest/block/notxdetails/", rest_block_notxdetails},
-      {"/rest/block/", rest_block_extended},
-      {"/rest/chaininfo", rest_chaininfo},
-      {"/rest/mempool/info", rest_mempool_info},
-      {"/rest/mempool/contents", rest_mempool_contents},
-      {"/rest/headers/", rest_headers},
-      {"/rest/getutxos", rest_getutxos},
-      {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/tx/", rest_tx, HTTPWorkClass::HEAVY},
+      {"/rest/mweboutput/", rest_mweboutput, HTTPWorkClass::DEFAULT},
+      {"/rest/block/notxdetails/", rest_block_notxdetails, HTTPWorkClass::HEAVY},
+      {"/rest/block/", rest_block_extended, HTTPWorkClass::HEAVY},
+      {"/rest/chaininfo", rest_chaininfo, HTTPWorkClass::LIGHT},
+      {"/rest/mempool/info", rest_mempool_info, HTTPWorkClass::LIGHT},
+      {"/rest/mempool/contents", rest_mempool_contents, HTTPWorkClass::HEAVY},
+      {"/rest/headers/", rest_headers, HTTPWorkClass::DEFAULT},
+      {"/rest/getutxos", rest_getutxos, HTTPWorkClass::HEAVY},
+      {"/rest/blockhashbyheight/", rest_blockhash_by_height, HTTPWorkClass::LIGHT},
 };
 
 void StartREST(const util::Ref& context)
 {
     for (const auto& up : uri_prefixes) {
         auto handler = [&context, up](HTTPRequest* req, const std::string& prefix) { return up.handler(context, req, prefix); };
-        RegisterHTTPHandler(up.prefix, false, handler);
+        auto classifier = [up](HTTPRequest*, const std::string&) { return up.work_class; };
+        RegisterHTTPHandler(up.prefix, false, handler, classifier);
     }
 }
 
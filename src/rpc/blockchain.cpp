@@ -15,13 +15,17 @@
 #include <core_io.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
+#include <index/mwebindex.h>
+#include <mw/node/Snapshot.h>
 #include <node/coinstats.h>
 #include <node/context.h>
 #include <node/utxo_snapshot.h>
+#include <optional.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
@@ -173,11 +177,97 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
     return result;
 }
 
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails)
+UniValue mweboutputToJSON(const Output& output)
 {
-    // Serialize passed information without accessing chain state of the active chain!
-    AssertLockNotHeld(cs_main); // For performance reasons
+    UniValue objOutput(UniValue::VOBJ);
+    objOutput.pushKV("output_id", output.GetOutputID().ToHex());
+    objOutput.pushKV("commit", output.GetCommitment().ToHex());
+    objOutput.pushKV("sender_pubkey", output.GetSenderPubKey().ToHex());
+    objOutput.pushKV("receiver_pubkey", output.GetReceiverPubKey().ToHex());
+    objOutput.pushKV("range_proof", HexStr(output.GetRangeProof()->Serialized()));
+    objOutput.pushKV("message", HexStr(output.GetOutputMessage().Serialized()));
+    return objOutput;
+}
+
+UniValue mwebIndexedOutputToJSON(const Output& output, const uint256& block_hash, const MWEBOutputPos& pos)
+{
+    UniValue result = mweboutputToJSON(output);
+    result.pushKV("blockhash", block_hash.GetHex());
+    result.pushKV("height", pos.height);
+    result.pushKV("position", (uint64_t)pos.position);
+    result.pushKV("leaf_index", pos.leaf_index);
+
+    LOCK(cs_main);
+    const CBlockIndex* blockindex = LookupBlockIndex(block_hash);
+    const bool in_active_chain = blockindex && ::ChainActive().Contains(blockindex);
+    result.pushKV("confirmations", in_active_chain ? ::ChainActive().Height() - blockindex->nHeight + 1 : 0);
+
+    Output utxo;
+    result.pushKV("spent", !::ChainstateActive().CoinsTip().GetMWEBCoin(output.GetOutputID(), utxo));
+    return result;
+}
+
+static UniValue blockTxToJSON(const CTransaction& tx, bool txDetails)
+{
+    if (!txDetails) return tx.GetHash().GetHex();
+
+    UniValue objTx(UniValue::VOBJ);
+    TxToUniv(tx, uint256(), objTx, true, RPCSerializationFlags());
+    return objTx;
+}
+
+static UniValue mwebInputToJSON(const Input& input, bool txDetails)
+{
+    if (!txDetails) return input.GetOutputID().ToHex();
+
+    UniValue objInput(UniValue::VOBJ);
+    objInput.pushKV("output_id", input.GetOutputID().ToHex());
+    objInput.pushKV("commit", input.GetCommitment().ToHex());
+    objInput.pushKV("output_pubkey", input.GetOutputPubKey().ToHex());
+
+    if (!!input.GetInputPubKey()) {
+        objInput.pushKV("input_pubkey", input.GetInputPubKey()->ToHex());
+    }
+
+    if (!input.GetExtraData().empty()) {
+        objInput.pushKV("extra_data", HexStr(input.GetExtraData()));
+    }
+
+    objInput.pushKV("sig", input.GetSignature().ToHex());
+    return objInput;
+}
+
+static UniValue mwebOutputToJSON(const Output& output, bool txDetails)
+{
+    if (!txDetails) return output.GetOutputID().ToHex();
+    return mweboutputToJSON(output);
+}
+
+static UniValue mwebKernelToJSON(const Kernel& kernel, bool txDetails)
+{
+    if (!txDetails) return kernel.GetCommitment().ToHex();
+
+    UniValue objKernel(UniValue::VOBJ);
+    objKernel.pushKV("kernel_id", kernel.GetKernelID().ToHex());
+    objKernel.pushKV("features", kernel.GetFeatures());
+    objKernel.pushKV("commit", kernel.GetCommitment().ToHex());
+    objKernel.pushKV("fee", kernel.GetFee());
+    objKernel.pushKV("lock_height", kernel.GetLockHeight());
+    objKernel.pushKV("excess", kernel.GetExcess().ToHex());
+    objKernel.pushKV("signature", kernel.GetSignature().ToHex());
+    if (!kernel.GetExtraData().empty()) {
+        objKernel.pushKV("extra_data", HexStr(kernel.GetExtraData()));
+    }
+    return objKernel;
+}
 
+/**
+ * Block description to JSON. Unless include_body is set, the "tx" array and the
+ * MWEB "inputs", "outputs" and "kernels" arrays are left empty, so they can be
+ * streamed in place.
+ */
+static UniValue blockFieldsToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails, bool include_body)
+{
     UniValue result(UniValue::VOBJ);
     result.pushKV("hash", blockindex->GetBlockHash().GetHex());
     const CBlockIndex* pnext;
@@ -191,16 +281,10 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
     result.pushKV("versionHex", strprintf("%08x", block.nVersion));
     result.pushKV("merkleroot", block.hashMerkleRoot.GetHex());
     UniValue txs(UniValue::VARR);
-    for(const auto& tx : block.vtx)
-    {
-        if(txDetails)
-        {
-            UniValue objTx(UniValue::VOBJ);
-            TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags());
-            txs.push_back(objTx);
+    if (include_body) {
+        for (const auto& tx : block.vtx) {
+            txs.push_back(blockTxToJSON(*tx, txDetails));
         }
-        else
-            txs.push_back(tx->GetHash().GetHex());
     }
     result.pushKV("tx", txs);
     result.pushKV("time", block.GetBlockTime());
@@ -227,65 +311,27 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
 
         // MWEB Inputs
         UniValue inputs(UniValue::VARR);
-        for (const auto& input : block.mweb_block.m_block->GetInputs()) {
-            if (txDetails) {
-                UniValue objInput(UniValue::VOBJ);
-                objInput.pushKV("output_id", input.GetOutputID().ToHex());
-                objInput.pushKV("commit", input.GetCommitment().ToHex());
-                objInput.pushKV("output_pubkey", input.GetOutputPubKey().ToHex());
-
-                if (!!input.GetInputPubKey()) {
-                    objInput.pushKV("input_pubkey", input.GetInputPubKey()->ToHex());
-                }
-
-                if (!input.GetExtraData().empty()) {
-                    objInput.pushKV("extra_data", HexStr(input.GetExtraData()));
-                }
-
-                objInput.pushKV("sig", input.GetSignature().ToHex());
-                inputs.push_back(objInput);
-            } else {
-                inputs.push_back(input.GetOutputID().ToHex());
+        if (include_body) {
+            for (const auto& input : block.mweb_block.m_block->GetInputs()) {
+                inputs.push_back(mwebInputToJSON(input, txDetails));
             }
         }
         mweb_block.pushKV("inputs", inputs);
 
         // MWEB Outputs
         UniValue outputs(UniValue::VARR);
-        for (const auto& output : block.mweb_block.m_block->GetOutputs()) {
-            if (txDetails) {
-                UniValue objOutput(UniValue::VOBJ);
-                objOutput.pushKV("output_id", output.GetOutputID().ToHex());
-                objOutput.pushKV("commit", output.GetCommitment().ToHex());
-                objOutput.pushKV("sender_pubkey", output.GetSenderPubKey().ToHex());
-                objOutput.pushKV("receiver_pubkey", output.GetReceiverPubKey().ToHex());
-                objOutput.pushKV("range_proof", HexStr(output.GetRangeProof()->Serialized()));
-                objOutput.pushKV("message", HexStr(output.GetOutputMessage().Serialized()));
-                outputs.push_back(objOutput);
-            } else {
-                outputs.push_back(output.GetOutputID().ToHex());
+        if (include_body) {
+            for (const auto& output : block.mweb_block.m_block->GetOutputs()) {
+                outputs.push_back(mwebOutputToJSON(output, txDetails));
             }
         }
         mweb_block.pushKV("outputs", outputs);
 
         // MWEB Kernels
         UniValue kernels(UniValue::VARR);
-        for (const auto& kernel : block.mweb_block.m_block->GetKernels()) {
-            if (txDetails) {
-                UniValue objKernel(UniValue::VOBJ);
-                objKernel.pushKV("kernel_id", kernel.GetKernelID().ToHex());
-                objKernel.pushKV("features", kernel.GetFeatures());
-                objKernel.pushKV("commit", kernel.GetCommitment().ToHex());
-                objKernel.pushKV("fee", kernel.GetFee());
-                objKernel.pushKV("lock_height", kernel.GetLockHeight());
-                objKernel.pushKV("excess", kernel.GetExcess().ToHex());
-                objKernel.pushKV("signature", kernel.GetSignature().ToHex());
-                if (!kernel.GetExtraData().empty()) {
-                    objKernel.pushKV("extra_data", HexStr(kernel.GetExtraData()));
-                }
-                kernels.push_back(objKernel);
-            } else {
-                kernels.push_back(kernel.GetCommitment().ToHex());
+        if (include_body) {
+            for (const auto& kernel : block.mweb_block.m_block->GetKernels()) {
+                kernels.push_back(mwebKernelToJSON(kernel, txDetails));
             }
         }
         mweb_block.pushKV("kernels", kernels);
@@ -300,6 +346,62 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
     return result;
 }
 
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails)
+{
+    // Serialize passed information without accessing chain state of the active chain!
+    AssertLockNotHeld(cs_main); // For performance reasons
+
+    return blockFieldsToJSON(block, tip, blockindex, txDetails, true);
+}
+
+/** Write an array to stream one item at a time */
+template <typename Items, typename ToJSON>
+static void StreamArray(JSONStreamWriter& stream, const std::string& key, const Items& items, ToJSON to_json)
+{
+    stream.Key(key);
+    stream.BeginArray();
+    for (const auto& item : items) {
+        stream.Value(to_json(item));
+    }
+    stream.EndArray();
+}
+
+void blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails, JSONStreamWriter& stream)
+{
+    AssertLockNotHeld(cs_main); // For performance reasons
+
+    // Build everything but the transactions and MWEB items, then stream those
+    // in place, keeping the order of the keys.
+    const UniValue fields = blockFieldsToJSON(block, tip, blockindex, txDetails, false);
+    stream.BeginObject();
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const std::string& key = fields.getKeys()[i];
+        const UniValue& value = fields.getValues()[i];
+        if (key == "tx") {
+            StreamArray(stream, key, block.vtx, [txDetails](const CTransactionRef& tx) { return blockTxToJSON(*tx, txDetails); });
+        } else if (key == "mweb") {
+            stream.Key(key);
+            stream.BeginObject();
+            for (size_t j = 0; j < value.size(); ++j) {
+                const std::string& mweb_key = value.getKeys()[j];
+                if (mweb_key == "inputs") {
+                    StreamArray(stream, mweb_key, block.mweb_block.m_block->GetInputs(), [txDetails](const Input& input) { return mwebInputToJSON(input, txDetails); });
+                } else if (mweb_key == "outputs") {
+                    StreamArray(stream, mweb_key, block.mweb_block.m_block->GetOutputs(), [txDetails](const Output& output) { return mwebOutputToJSON(output, txDetails); });
+                } else if (mweb_key == "kernels") {
+                    StreamArray(stream, mweb_key, block.mweb_block.m_block->GetKernels(), [txDetails](const Kernel& kernel) { return mwebKernelToJSON(kernel, txDetails); });
+                } else {
+                    stream.KeyValue(mweb_key, value.getValues()[j]);
+                }
+            }
+            stream.EndObject();
+        } else {
+            stream.KeyValue(key, value);
+        }
+    }
+    stream.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{"getblockcount",
@@ -718,6 +820,18 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+void MempoolToJSON(const CTxMemPool& pool, JSONStreamWriter& stream)
+{
+    LOCK(pool.cs);
+    stream.BeginObject();
+    for (const CTxMemPoolEntry& e : pool.mapTx) {
+        UniValue info(UniValue::VOBJ);
+        entryToJSON(pool, info, e);
+        stream.KeyValue(e.GetTx().GetHash().ToString(), info);
+    }
+    stream.EndObject();
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{"getrawmempool",
@@ -763,7 +877,13 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
-    return MempoolToJSON(EnsureMemPool(request.context), fVerbose, include_mempool_sequence);
+    const CTxMemPool& mempool = EnsureMemPool(request.context);
+    if (fVerbose && !include_mempool_sequence && request.start_result_stream) {
+        MempoolToJSON(mempool, request.start_result_stream());
+        return NullUniValue;
+    }
+
+    return MempoolToJSON(mempool, fVerbose, include_mempool_sequence);
 },
     };
 }
@@ -1146,6 +1266,11 @@ static RPCHelpMan getblock()
         return strHex;
     }
 
+    if (request.start_result_stream) {
+        blockToJSON(block, tip, pblockindex, verbosity >= 2, request.start_result_stream());
+        return NullUniValue;
+    }
+
     return blockToJSON(block, tip, pblockindex, verbosity >= 2);
 },
     };
@@ -1343,6 +1468,59 @@ static RPCHelpMan gettxout()
     };
 }
 
+static RPCHelpMan getmweboutput()
+{
+    return RPCHelpMan{"getmweboutput",
+                "\nReturns details about an MWEB output, whether or not it has been spent.\n"
+                "Requires -mwebindex.\n",
+                {
+                    {"output_id", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The MWEB output id"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "output_id", "The output id"},
+                        {RPCResult::Type::STR_HEX, "commit", "The output's pedersen commitment"},
+                        {RPCResult::Type::STR_HEX, "sender_pubkey", "The sender's public key"},
+                        {RPCResult::Type::STR_HEX, "receiver_pubkey", "The receiver's public key"},
+                        {RPCResult::Type::STR_HEX, "range_proof", "The serialized range proof"},
+                        {RPCResult::Type::STR_HEX, "message", "The serialized output message"},
+                        {RPCResult::Type::STR_HEX, "blockhash", "The hash of the block that created the output"},
+                        {RPCResult::Type::NUM, "height", "The height of the block that created the output"},
+                        {RPCResult::Type::NUM, "position", "The position of the output in the block's MWEB outputs"},
+                        {RPCResult::Type::NUM, "leaf_index", "The leaf index of the output in the output MMR"},
+                        {RPCResult::Type::NUM, "confirmations", "The number of confirmations, or 0 if the block is not in the active chain"},
+                        {RPCResult::Type::BOOL, "spent", "Whether the output is no longer in the MWEB UTXO set"},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getmweboutput", "\"output_id\"")
+            + HelpExampleRpc("getmweboutput", "\"output_id\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const std::string output_id_hex = request.params[0].get_str();
+    if (output_id_hex.size() != 64 || !IsHex(output_id_hex)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "output_id must be of length 64 (not " + ToString(output_id_hex.size()) + ", for '" + output_id_hex + "')");
+    }
+    const mw::Hash output_id = mw::Hash::FromHex(output_id_hex);
+
+    if (!g_mwebindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -mwebindex");
+    }
+    g_mwebindex->BlockUntilSyncedToCurrentChain();
+
+    uint256 block_hash;
+    MWEBOutputPos pos;
+    Output output;
+    if (!g_mwebindex->FindOutput(output_id, block_hash, pos, output)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No such MWEB output");
+    }
+
+    return mwebIndexedOutputToJSON(output, block_hash, pos);
+},
+    };
+}
+
 static RPCHelpMan verifychain()
 {
     return RPCHelpMan{"verifychain",
@@ -2546,7 +2724,8 @@ static RPCHelpMan dumptxoutset()
 {
     return RPCHelpMan{
         "dumptxoutset",
-        "\nWrite the serialized UTXO set to disk.\n",
+        "\nWrite the serialized UTXO set to disk.\n"
+        "If MWEB is active at the tip, the MWEB UTXOs, leafset, and output MMR are written after the coins.\n",
         {
             {"path",
                 RPCArg::Type::STR,
@@ -2561,6 +2740,8 @@ static RPCHelpMan dumptxoutset()
                     {RPCResult::Type::STR_HEX, "base_hash", "the hash of the base of the snapshot"},
                     {RPCResult::Type::NUM, "base_height", "the height of the base of the snapshot"},
                     {RPCResult::Type::STR, "path", "the absolute path that the snapshot was written to"},
+                    {RPCResult::Type::NUM, "mweb_utxos_written", /* optional */ true, "the number of MWEB UTXOs written in the snapshot (only present if MWEB is active)"},
+                    {RPCResult::Type::STR_HEX, "mweb_hash", /* optional */ true, "the hash committing to the MWEB state in the snapshot (only present if MWEB is active)"},
                 }
         },
         RPCExamples{
@@ -2583,6 +2764,7 @@ static RPCHelpMan dumptxoutset()
     FILE* file{fsbridge::fopen(temppath, "wb")};
     CAutoFile afile{file, SER_DISK, CLIENT_VERSION};
     std::unique_ptr<CCoinsViewCursor> pcursor;
+    Optional<mw::SnapshotWriter> mweb_writer;
     CCoinsStats stats;
     CBlockIndex* tip;
     NodeContext& node = EnsureNodeContext(request.context);
@@ -2611,6 +2793,15 @@ static RPCHelpMan dumptxoutset()
         pcursor = std::unique_ptr<CCoinsViewCursor>(::ChainstateActive().CoinsDB().Cursor());
         tip = LookupBlockIndex(stats.hashBlock);
         CHECK_NONFATAL(tip);
+
+        // Like the coins cursor, the MWEB writer reads from a snapshot of the
+        // database and the MMR files it opens here, so it's safe to use below.
+        mw::ICoinsView::Ptr mweb_view = ::ChainstateActive().CoinsDB().GetMWEBView();
+        mw::Header::CPtr mweb_header = mweb_view->GetBestHeader();
+        if (mweb_header) {
+            CHECK_NONFATAL(mweb_header->GetHeight() == tip->nHeight);
+            mweb_writer.emplace(mw::SnapshotWriter::Capture(FilePath{GetDataDir()}, mweb_view->GetDatabase(), mweb_header));
+        }
     }
 
     SnapshotMetadata metadata{tip->GetBlockHash(), stats.coins_count, tip->nChainTx};
@@ -2632,6 +2823,11 @@ static RPCHelpMan dumptxoutset()
         pcursor->Next();
     }
 
+    Optional<mw::SnapshotInfo> mweb_info;
+    if (mweb_writer) {
+        mweb_info = mweb_writer->Write(afile, node.rpc_interruption_point);
+    }
+
     afile.fclose();
     fs::rename(temppath, path);
 
@@ -2640,6 +2836,10 @@ static RPCHelpMan dumptxoutset()
     result.pushKV("base_hash", tip->GetBlockHash().ToString());
     result.pushKV("base_height", tip->nHeight);
     result.pushKV("path", path.string());
+    if (mweb_info) {
+        result.pushKV("mweb_utxos_written", mweb_info->num_utxos);
+        result.pushKV("mweb_hash", mweb_info->hash.ToHex());
+    }
     return result;
 },
     };
@@ -2666,6 +2866,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        {"txid"} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose", "mempool_sequence"} },
+    { "blockchain",         "getmweboutput",          &getmweboutput,          {"output_id"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
@@ -17,8 +17,12 @@ class CBlock;
 class CBlockIndex;
 class CConnman;
 class CTxMemPool;
+class JSONStreamWriter;
 class ChainstateManager;
+class Output;
 class UniValue;
+class uint256;
+struct MWEBOutputPos;
 struct NodeContext;
 namespace util {
 class Ref;
@@ -40,15 +44,27 @@ void RPCNotifyBlockChange(const CBlockIndex*);
 /** Block description to JSON */
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails = false) LOCKS_EXCLUDED(cs_main);
 
+/** Block description to JSON, written to stream item by item */
+void blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails, JSONStreamWriter& stream) LOCKS_EXCLUDED(cs_main);
+
 /** Mempool information to JSON */
 UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 
 /** Mempool to JSON */
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool include_mempool_sequence = false);
 
+/** Verbose mempool contents to JSON, written to stream entry by entry */
+void MempoolToJSON(const CTxMemPool& pool, JSONStreamWriter& stream);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main);
 
+/** MWEB output description to JSON */
+UniValue mweboutputToJSON(const Output& output);
+
+/** MWEB output found by the MWEB index to JSON, including where it was created and whether it is spent */
+UniValue mwebIndexedOutputToJSON(const Output& output, const uint256& block_hash, const MWEBOutputPos& pos) LOCKS_EXCLUDED(cs_main);
+
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
 
@@ -0,0 +1,85 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <cassert>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t chunk_size)
+    : m_sink(std::move(sink)), m_chunk_size(chunk_size)
+{
+    m_buffer.reserve(chunk_size);
+}
+
+void JSONStreamWriter::BeginValue()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (!m_open.empty()) {
+        if (m_open.back()) m_buffer += ',';
+        m_open.back() = true;
+    }
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    if (m_buffer.size() >= m_chunk_size) Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    BeginValue();
+    m_buffer += '{';
+    m_open.push_back(false);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!m_open.empty() && !m_after_key);
+    m_open.pop_back();
+    m_buffer += '}';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    BeginValue();
+    m_buffer += '[';
+    m_open.push_back(false);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!m_open.empty() && !m_after_key);
+    m_open.pop_back();
+    m_buffer += ']';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!m_open.empty() && !m_after_key);
+    BeginValue();
+    m_buffer += UniValue(key).write();
+    m_buffer += ':';
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    BeginValue();
+    m_buffer += value.write();
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buffer.empty()) return;
+    std::string chunk;
+    chunk.reserve(m_chunk_size);
+    std::swap(chunk, m_buffer);
+    m_sink(std::move(chunk));
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <univalue.h>
+
+/** Default number of bytes a JSONStreamWriter buffers before handing them to its sink */
+static const size_t DEFAULT_JSON_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Writes a JSON document piece by piece, so a large document can be sent before
+ * all of it has been built. Objects and arrays are opened and closed explicitly,
+ * while their members may be written as UniValues. The output matches what
+ * UniValue::write() would produce for the same document.
+ *
+ * Output is buffered and handed to the sink in chunks of about chunk_size bytes.
+ * Call Flush() once the document is complete to hand over the rest.
+ */
+class JSONStreamWriter
+{
+public:
+    using Sink = std::function<void(std::string&& chunk)>;
+
+    explicit JSONStreamWriter(Sink sink, size_t chunk_size = DEFAULT_JSON_STREAM_CHUNK_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Write the key of the next member of the current object. */
+    void Key(const std::string& key);
+    /** Write a value, as an element of the current array or the value of the last key. */
+    void Value(const UniValue& value);
+    void KeyValue(const std::string& key, const UniValue& value)
+    {
+        Key(key);
+        Value(value);
+    }
+
+    /** Hand everything written so far to the sink. */
+    void Flush();
+
+private:
+    void BeginValue();
+    void MaybeFlush();
+
+    Sink m_sink;
+    const size_t m_chunk_size;
+    std::string m_buffer;
+    /** For each open object or array, whether anything has been written to it yet */
+    std::vector<bool> m_open;
+    /** Whether a key was written, whose value hasn't been */
+    bool m_after_key{false};
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
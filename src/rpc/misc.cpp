@@ -6,6 +6,7 @@
 
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/mwebindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <key_io.h>
@@ -687,6 +688,10 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_txindex->GetSummary(), index_name));
     }
 
+    if (g_mwebindex) {
+        result.pushKVs(SummaryToJSON(g_mwebindex->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
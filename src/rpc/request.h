@@ -6,10 +6,13 @@
 #ifndef BITCOIN_RPC_REQUEST_H
 #define BITCOIN_RPC_REQUEST_H
 
+#include <functional>
 #include <string>
 
 #include <univalue.h>
 
+class JSONStreamWriter;
+
 namespace util {
 class Ref;
 } // namespace util
@@ -39,6 +42,12 @@ public:
     std::string authUser;
     std::string peerAddr;
     const util::Ref& context;
+    /**
+     * Set if the result may be streamed. A method with a large result may call
+     * it once it can no longer fail, write its result to the returned writer,
+     * and return NullUniValue.
+     */
+    std::function<JSONStreamWriter&()> start_result_stream;
 
     JSONRPCRequest(const util::Ref& context) : id(NullUniValue), params(NullUniValue), fHelp(false), context(context) {}
 
@@ -47,7 +56,8 @@ public:
     //! added or removed above.
     JSONRPCRequest(const JSONRPCRequest& other, const util::Ref& context)
         : id(other.id), strMethod(other.strMethod), params(other.params), fHelp(other.fHelp), URI(other.URI),
-          authUser(other.authUser), peerAddr(other.peerAddr), context(context)
+          authUser(other.authUser), peerAddr(other.peerAddr), context(context),
+          start_result_stream(other.start_result_stream)
     {
     }
 
@@ -6,6 +6,7 @@
 
 #include <rpc/server.h>
 
+#include <httpserver.h>
 #include <rpc/util.h>
 #include <shutdown.h>
 #include <sync.h>
@@ -215,6 +216,20 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::ARR, "work_queues", "The HTTP work queues, which serve requests by how expensive they are",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                 {RPCResult::Type::STR, "class", "The requests served by the queue (light, default or heavy)"},
+                                 {RPCResult::Type::NUM, "threads", "The number of threads serving the queue"},
+                                 {RPCResult::Type::NUM, "depth", "The number of requests waiting for a thread"},
+                                 {RPCResult::Type::NUM, "max_depth", "The number of requests that may wait before new ones are rejected"},
+                                 {RPCResult::Type::NUM, "served", "The number of requests taken off the queue"},
+                                 {RPCResult::Type::NUM, "rejected", "The number of requests rejected because the queue was full"},
+                                 {RPCResult::Type::NUM, "avg_wait", "The average time served requests waited for a thread, in microseconds"},
+                                 {RPCResult::Type::NUM, "max_wait", "The longest time a served request waited for a thread, in microseconds"},
+                            }},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -238,6 +253,21 @@ static RPCHelpMan getrpcinfo()
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
 
+    UniValue work_queues(UniValue::VARR);
+    for (const HTTPWorkQueueStats& stats : GetHTTPWorkQueueStats()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("class", HTTPWorkClassString(stats.work_class));
+        entry.pushKV("threads", stats.threads);
+        entry.pushKV("depth", (uint64_t)stats.depth);
+        entry.pushKV("max_depth", (uint64_t)stats.max_depth);
+        entry.pushKV("served", stats.served);
+        entry.pushKV("rejected", stats.rejected);
+        entry.pushKV("avg_wait", stats.served == 0 ? 0 : stats.total_wait / (int64_t)stats.served);
+        entry.pushKV("max_wait", stats.max_wait);
+        work_queues.push_back(entry);
+    }
+    result.pushKV("work_queues", work_queues);
+
     return result;
 }
     };
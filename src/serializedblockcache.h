@@ -0,0 +1,72 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SERIALIZEDBLOCKCACHE_H
+#define BITCOIN_SERIALIZEDBLOCKCACHE_H
+
+#include <sync.h>
+#include <uint256.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Least-recently-used cache of blocks serialized with the flags a peer asked for,
+ * keyed by block hash and serialization flags. Blocks near the tip are requested
+ * by many peers, so this saves reading and reserializing them for each one.
+ */
+class SerializedBlockCache
+{
+public:
+    using Data = std::shared_ptr<const std::vector<uint8_t>>;
+
+    explicit SerializedBlockCache(size_t max_bytes) : m_max_bytes(max_bytes) {}
+
+    Data Get(const uint256& hash, int flags)
+    {
+        LOCK(m_mutex);
+        auto it = m_entries.find(Key{hash, flags});
+        if (it == m_entries.end()) return nullptr;
+
+        ++m_hits;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+
+    void Put(const uint256& hash, int flags, Data data)
+    {
+        LOCK(m_mutex);
+        const Key key{hash, flags};
+        if (m_entries.count(key) || data->size() > m_max_bytes) return;
+
+        m_lru.emplace_front(key, data);
+        m_entries.emplace(key, m_lru.begin());
+        m_bytes += data->size();
+        while (m_bytes > m_max_bytes) {
+            m_bytes -= m_lru.back().second->size();
+            m_entries.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+    }
+
+    //! The number of lookups that found their entry.
+    uint64_t GetHits() const { return m_hits; }
+
+private:
+    using Key = std::pair<uint256, int>;
+    using LRUList = std::list<std::pair<Key, Data>>;
+
+    const size_t m_max_bytes;
+    Mutex m_mutex;
+    LRUList m_lru GUARDED_BY(m_mutex);
+    std::map<Key, LRUList::iterator> m_entries GUARDED_BY(m_mutex);
+    size_t m_bytes GUARDED_BY(m_mutex){0};
+    std::atomic<uint64_t> m_hits{0};
+};
+
+#endif // BITCOIN_SERIALIZEDBLOCKCACHE_H
@@ -6,9 +6,11 @@
 #include <chainparams.h>
 #include <consensus/merkle.h>
 #include <pow.h>
+#include <script/script.h>
 #include <streams.h>
 
 #include <test/util/setup_common.h>
+#include <test_framework/TxBuilder.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -28,7 +30,7 @@ static CBlock BuildBlockTestCase() {
     block.vtx[0] = MakeTransactionRef(tx);
     block.nVersion = 1;
     block.hashPrevBlock = InsecureRand256();
-    block.nBits = 0x1e0ffff0;
+    block.nBits = 0x207fffff;
 
     tx.vin[0].prevout.hash = InsecureRand256();
     tx.vin[0].prevout.n = 0;
@@ -72,7 +74,7 @@ BOOST_AUTO_TEST_CASE(SimpleRoundTripTest)
         CBlockHeaderAndShortTxIDs shortIDs2;
         stream >> shortIDs2;
 
-        PartiallyDownloadedBlock partialBlock(&pool);
+        PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
         BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
         BOOST_CHECK( partialBlock.IsTxAvailable(0));
         BOOST_CHECK(!partialBlock.IsTxAvailable(1));
@@ -115,6 +117,7 @@ public:
     uint64_t nonce;
     std::vector<uint64_t> shorttxids;
     std::vector<PrefilledTransaction> prefilledtxn;
+    MWEB::Block mweb_block;
 
     explicit TestHeaderAndShortIDs(const CBlockHeaderAndShortTxIDs& orig) {
         CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
@@ -132,7 +135,7 @@ public:
         return base.GetShortID(txhash);
     }
 
-    SERIALIZE_METHODS(TestHeaderAndShortIDs, obj) { READWRITE(obj.header, obj.nonce, Using<VectorFormatter<CustomUintFormatter<CBlockHeaderAndShortTxIDs::SHORTTXIDS_LENGTH>>>(obj.shorttxids), obj.prefilledtxn); }
+    SERIALIZE_METHODS(TestHeaderAndShortIDs, obj) { READWRITE(obj.header, obj.nonce, Using<VectorFormatter<CustomUintFormatter<CBlockHeaderAndShortTxIDs::SHORTTXIDS_LENGTH>>>(obj.shorttxids), obj.prefilledtxn, obj.mweb_block); }
 };
 
 BOOST_AUTO_TEST_CASE(NonCoinbasePreforwardRTTest)
@@ -162,7 +165,7 @@ BOOST_AUTO_TEST_CASE(NonCoinbasePreforwardRTTest)
         CBlockHeaderAndShortTxIDs shortIDs2;
         stream >> shortIDs2;
 
-        PartiallyDownloadedBlock partialBlock(&pool);
+        PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
         BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
         BOOST_CHECK(!partialBlock.IsTxAvailable(0));
         BOOST_CHECK( partialBlock.IsTxAvailable(1));
@@ -232,7 +235,7 @@ BOOST_AUTO_TEST_CASE(SufficientPreforwardRTTest)
         CBlockHeaderAndShortTxIDs shortIDs2;
         stream >> shortIDs2;
 
-        PartiallyDownloadedBlock partialBlock(&pool);
+        PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
         BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
         BOOST_CHECK( partialBlock.IsTxAvailable(0));
         BOOST_CHECK( partialBlock.IsTxAvailable(1));
@@ -270,7 +273,7 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     block.vtx[0] = MakeTransactionRef(std::move(coinbase));
     block.nVersion = 1;
     block.hashPrevBlock = InsecureRand256();
-    block.nBits = 0x1e0ffff0;
+    block.nBits = 0x207fffff;
 
     bool mutated;
     block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
@@ -287,7 +290,7 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
         CBlockHeaderAndShortTxIDs shortIDs2;
         stream >> shortIDs2;
 
-        PartiallyDownloadedBlock partialBlock(&pool);
+        PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
         BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
         BOOST_CHECK(partialBlock.IsTxAvailable(0));
 
@@ -300,6 +303,284 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+static mw::Transaction::CPtr BuildMWEBTx()
+{
+    return test::TxBuilder().AddInput(5'000'000).AddOutput(4'000'000).AddPlainKernel(1'000'000).Build().GetTransaction();
+}
+
+/** Wraps an MWEB transaction in a transaction without canonical inputs or outputs, as relayed to mempools. */
+static CTransactionRef MakeMWEBOnlyTx(const mw::Transaction::CPtr& mweb_tx)
+{
+    CMutableTransaction tx;
+    tx.mweb_tx = MWEB::Tx(mweb_tx);
+    return MakeTransactionRef(std::move(tx));
+}
+
+/** Builds a block with a coinbase, a canonical transaction, and an extension block holding the MWEB transactions. */
+static CBlock BuildMWEBBlockTestCase(const std::vector<mw::Transaction::CPtr>& mweb_txs) {
+    CBlock block;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig.resize(10);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 42;
+
+    block.vtx.resize(3);
+    block.vtx[0] = MakeTransactionRef(tx);
+    block.nVersion = 1;
+    block.hashPrevBlock = InsecureRand256();
+    block.nBits = 0x207fffff;
+
+    tx.vin[0].prevout.hash = InsecureRand256();
+    tx.vin[0].prevout.n = 0;
+    block.vtx[1] = MakeTransactionRef(tx);
+
+    std::vector<Input> inputs;
+    std::vector<Output> outputs;
+    std::vector<Kernel> kernels;
+    for (const mw::Transaction::CPtr& mweb_tx : mweb_txs) {
+        inputs.insert(inputs.end(), mweb_tx->GetInputs().begin(), mweb_tx->GetInputs().end());
+        outputs.insert(outputs.end(), mweb_tx->GetOutputs().begin(), mweb_tx->GetOutputs().end());
+        kernels.insert(kernels.end(), mweb_tx->GetKernels().begin(), mweb_tx->GetKernels().end());
+    }
+    auto mweb_header = std::make_shared<mw::Header>(1, mw::Hash(), mw::Hash(), mw::Hash(), BlindingFactor(), BlindingFactor(), outputs.size(), kernels.size());
+    block.mweb_block = MWEB::Block(std::make_shared<mw::Block>(mweb_header, TxBody{inputs, outputs, kernels}));
+
+    CMutableTransaction hogex;
+    hogex.m_hogEx = true;
+    hogex.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    hogex.vout.emplace_back(42, CScript() << OP_8 << block.mweb_block.GetHash().vec());
+    block.vtx[2] = MakeTransactionRef(std::move(hogex));
+
+    bool mutated;
+    block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
+    assert(!mutated);
+    while (!CheckProofOfWork(block.GetPoWHash(), block.nBits, Params().GetConsensus())) ++block.nNonce;
+    return block;
+}
+
+template <typename T>
+static void CheckSameHashes(const std::vector<T>& expected, const std::vector<T>& actual)
+{
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        BOOST_CHECK(expected[i].GetHash() == actual[i].GetHash());
+    }
+}
+
+static void CheckSameMWEBBlock(const CBlock& expected, const CBlock& actual)
+{
+    BOOST_REQUIRE(!actual.mweb_block.IsNull());
+    BOOST_CHECK(expected.mweb_block.GetHash() == actual.mweb_block.GetHash());
+    CheckSameHashes(expected.mweb_block.m_block->GetInputs(), actual.mweb_block.m_block->GetInputs());
+    CheckSameHashes(expected.mweb_block.m_block->GetOutputs(), actual.mweb_block.m_block->GetOutputs());
+    CheckSameHashes(expected.mweb_block.m_block->GetKernels(), actual.mweb_block.m_block->GetKernels());
+}
+
+/** Exposes the MWEB short IDs of a compact block, to encode custom ones. */
+class TestMWEBHeaderAndShortIDs : public CBlockHeaderAndShortTxIDs {
+public:
+    using CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs;
+    using CBlockHeaderAndShortTxIDs::mweb_input_shortids;
+    using CBlockHeaderAndShortTxIDs::mweb_output_shortids;
+    using CBlockHeaderAndShortTxIDs::mweb_kernel_shortids;
+};
+
+BOOST_AUTO_TEST_CASE(MWEBShortIDsMempoolRoundTripTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    const std::vector<mw::Transaction::CPtr> mweb_txs{BuildMWEBTx(), BuildMWEBTx()};
+    CBlock block(BuildMWEBBlockTestCase(mweb_txs));
+
+    LOCK2(cs_main, pool.cs);
+    pool.addUnchecked(entry.FromTx(block.vtx[1]));
+    for (const mw::Transaction::CPtr& mweb_tx : mweb_txs) {
+        pool.addUnchecked(entry.FromTx(MakeMWEBOnlyTx(mweb_tx)));
+    }
+
+    CBlockHeaderAndShortTxIDs shortIDs(block, true);
+
+    // Without the flag, the extension block is sent in full.
+    {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << shortIDs;
+        const size_t full_size = stream.size();
+
+        CDataStream short_stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+        short_stream << shortIDs;
+        BOOST_CHECK_LT(short_stream.size(), full_size);
+    }
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+    stream << shortIDs;
+
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+    BOOST_CHECK(shortIDs2.mweb_block.IsNull());
+
+    PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(partialBlock.IsTxAvailable(1));
+    BOOST_CHECK(partialBlock.IsTxAvailable(2));
+    BOOST_CHECK(partialBlock.GetMissingMWEB().IsNull());
+
+    CBlock block2;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {}) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    bool mutated;
+    BOOST_CHECK_EQUAL(block.hashMerkleRoot.ToString(), BlockMerkleRoot(block2, &mutated).ToString());
+    BOOST_CHECK(!mutated);
+    for (const CTransactionRef& tx : block2.vtx) {
+        BOOST_CHECK(!tx->HasMWEBTx());
+    }
+    CheckSameMWEBBlock(block, block2);
+}
+
+BOOST_AUTO_TEST_CASE(MWEBShortIDsGetBlockTxnTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    const std::vector<mw::Transaction::CPtr> mweb_txs{BuildMWEBTx(), BuildMWEBTx()};
+    CBlock block(BuildMWEBBlockTestCase(mweb_txs));
+
+    // Only the first MWEB transaction is known.
+    LOCK2(cs_main, pool.cs);
+    pool.addUnchecked(entry.FromTx(MakeMWEBOnlyTx(mweb_txs[0])));
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+    stream << CBlockHeaderAndShortTxIDs(block, true);
+
+    CBlockHeaderAndShortTxIDs shortIDs;
+    stream >> shortIDs;
+
+    PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
+    BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+    BOOST_CHECK(!partialBlock.IsTxAvailable(1));
+
+    // The components of the second MWEB transaction are requested alongside the missing transaction.
+    BlockTransactionsRequest req;
+    req.blockhash = block.GetHash();
+    req.indexes = {1};
+    req.mweb_req = partialBlock.GetMissingMWEB();
+    BOOST_CHECK(req.mweb_req.input_indexes == std::vector<uint32_t>{1});
+    BOOST_CHECK(req.mweb_req.output_indexes == std::vector<uint32_t>{1});
+    BOOST_CHECK(req.mweb_req.kernel_indexes == std::vector<uint32_t>{1});
+
+    CDataStream req_stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+    req_stream << req;
+    BlockTransactionsRequest req2;
+    req_stream >> req2;
+    BOOST_CHECK(req2.mweb_req.input_indexes == req.mweb_req.input_indexes);
+    BOOST_CHECK(req2.mweb_req.output_indexes == req.mweb_req.output_indexes);
+    BOOST_CHECK(req2.mweb_req.kernel_indexes == req.mweb_req.kernel_indexes);
+
+    // The sending side answers from its copy of the block.
+    BlockTransactions resp(req2);
+    resp.txn[0] = block.vtx[1];
+    BOOST_CHECK(FillMWEBTransactions(resp.mweb_txn, *block.mweb_block.m_block, req2.mweb_req));
+
+    CDataStream resp_stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+    resp_stream << resp;
+    BlockTransactions resp2;
+    resp_stream >> resp2;
+    BOOST_CHECK_EQUAL(resp2.mweb_txn.inputs.size(), 1U);
+    BOOST_CHECK_EQUAL(resp2.mweb_txn.outputs.size(), 1U);
+    BOOST_CHECK_EQUAL(resp2.mweb_txn.kernels.size(), 1U);
+
+    CBlock block2;
+    {
+        PartiallyDownloadedBlock tmp = partialBlock;
+        BOOST_CHECK(partialBlock.FillBlock(block2, resp2.txn) == READ_STATUS_INVALID); // No MWEB components
+        partialBlock = tmp;
+    }
+    {
+        PartiallyDownloadedBlock tmp = partialBlock;
+        MWEBTransactions too_many = resp2.mweb_txn;
+        too_many.kernels.push_back(too_many.kernels.front());
+        BOOST_CHECK(partialBlock.FillBlock(block2, resp2.txn, too_many) == READ_STATUS_INVALID);
+        partialBlock = tmp;
+    }
+
+    BOOST_CHECK(partialBlock.FillBlock(block2, resp2.txn, resp2.mweb_txn) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    CheckSameMWEBBlock(block, block2);
+}
+
+BOOST_AUTO_TEST_CASE(MWEBShortIDCollisionTest)
+{
+    CTxMemPool pool;
+    const std::vector<mw::Transaction::CPtr> mweb_txs{BuildMWEBTx(), BuildMWEBTx()};
+    CBlock block(BuildMWEBBlockTestCase(mweb_txs));
+
+    // Colliding short IDs within the compact block fall back to requesting the full block.
+    {
+        TestMWEBHeaderAndShortIDs shortIDs(block, true);
+        shortIDs.mweb_output_shortids[1] = shortIDs.mweb_output_shortids[0];
+
+        PartiallyDownloadedBlock partialBlock(&pool, MWEB::Block());
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_FAILED);
+    }
+
+    const Kernel& kernel1 = mweb_txs[0]->GetKernels().front();
+    const Kernel& kernel2 = mweb_txs[1]->GetKernels().front();
+
+    // Two different components matching the same short ID are requested.
+    {
+        PartialMWEBComponents<Kernel> kernels;
+        BOOST_CHECK(kernels.Init({1, 2}) == READ_STATUS_OK);
+        kernels.Offer(1, kernel1);
+        kernels.Offer(1, kernel2);
+        kernels.Offer(1, kernel1);
+        kernels.Offer(2, kernel2);
+        BOOST_CHECK_EQUAL(kernels.found_count, 1U);
+        BOOST_CHECK(!kernels.IsComplete());
+        BOOST_CHECK(kernels.GetMissing() == std::vector<uint32_t>{0});
+
+        std::vector<Kernel> filled;
+        BOOST_CHECK(!PartialMWEBComponents<Kernel>(kernels).Fill(filled, {}));
+        BOOST_CHECK(!PartialMWEBComponents<Kernel>(kernels).Fill(filled, {kernel1, kernel1}));
+        BOOST_CHECK(kernels.Fill(filled, {kernel1}));
+        CheckSameHashes(std::vector<Kernel>{kernel1, kernel2}, filled);
+    }
+
+    // The same component offered twice, e.g. from the mempool and the extra pool, isn't a collision.
+    {
+        PartialMWEBComponents<Kernel> kernels;
+        BOOST_CHECK(kernels.Init({1}) == READ_STATUS_OK);
+        kernels.Offer(1, kernel1);
+        kernels.Offer(1, kernel1);
+        kernels.Offer(3, kernel2);
+        BOOST_CHECK(kernels.IsComplete());
+        BOOST_CHECK(kernels.GetMissing().empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MWEBTransactionsOutOfRangeTest)
+{
+    const std::vector<mw::Transaction::CPtr> mweb_txs{BuildMWEBTx(), BuildMWEBTx()};
+    const CBlock block(BuildMWEBBlockTestCase(mweb_txs));
+    const mw::Block& mweb_block = *block.mweb_block.m_block;
+
+    MWEBTransactionsRequest req;
+    req.input_indexes = {0, 1};
+    req.output_indexes = {1};
+    req.kernel_indexes = {0};
+    MWEBTransactions mweb_txn;
+    BOOST_CHECK(FillMWEBTransactions(mweb_txn, mweb_block, req));
+    CheckSameHashes(mweb_block.GetInputs(), mweb_txn.inputs);
+    CheckSameHashes(std::vector<Output>{mweb_block.GetOutputs()[1]}, mweb_txn.outputs);
+    CheckSameHashes(std::vector<Kernel>{mweb_block.GetKernels()[0]}, mweb_txn.kernels);
+
+    for (auto indexes : {&MWEBTransactionsRequest::input_indexes, &MWEBTransactionsRequest::output_indexes, &MWEBTransactionsRequest::kernel_indexes}) {
+        MWEBTransactionsRequest bad_req = req;
+        (bad_req.*indexes).push_back(2);
+        MWEBTransactions bad_txn;
+        BOOST_CHECK(!FillMWEBTransactions(bad_txn, mweb_block, bad_req));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
@@ -369,4 +650,19 @@ BOOST_AUTO_TEST_CASE(TransactionsRequestDeserializationOverflowTest) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(MWEBTransactionsRequestDeserializationOverflowTest) {
+    // MWEB indexes are 32 bits, so a delta past the highest index must not wrap around.
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_MWEB_SHORT_IDS);
+    stream << InsecureRand256();
+    WriteCompactSize(stream, 0); // indexes
+    WriteCompactSize(stream, 2); // mweb input indexes
+    WriteCompactSize(stream, 0xffffffff);
+    WriteCompactSize(stream, 0);
+    WriteCompactSize(stream, 0); // mweb output indexes
+    WriteCompactSize(stream, 0); // mweb kernel indexes
+
+    BlockTransactionsRequest req;
+    BOOST_CHECK_THROW(stream >> req, std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
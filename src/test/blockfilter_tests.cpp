@@ -12,6 +12,8 @@
 #include <univalue.h>
 #include <util/strencodings.h>
 
+#include <test_framework/Miner.h>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(blockfilter_tests)
@@ -125,6 +127,35 @@ BOOST_AUTO_TEST_CASE(blockfilter_basic_test)
     BOOST_CHECK(default_ctor_block_filter_1.GetEncodedFilter() == default_ctor_block_filter_2.GetEncodedFilter());
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_mweb_test, BasicTestingSetup)
+{
+    test::Miner miner(GetDataDir());
+
+    // Peg in a coin, then peg it out again in the next block.
+    test::Tx pegin_tx = test::Tx::CreatePegIn(1'000'000);
+    test::MinedBlock block1 = miner.MineBlock(1, {pegin_tx});
+    test::Tx pegout_tx = test::Tx::CreatePegOut(pegin_tx.GetOutputs().front(), 1'000);
+    test::MinedBlock block2 = miner.MineBlock(2, {pegout_tx});
+
+    CBlock block;
+    block.mweb_block = MWEB::Block(block2.GetBlock());
+
+    const mw::Hash spent_id = pegin_tx.GetOutputs().front().GetOutputID();
+    const CScript pegout_script = pegout_tx.GetPegOutCoin().GetScriptPubKey();
+
+    BlockFilter block_filter(BlockFilterType::MWEB, block, CBlockUndo());
+    const GCSFilter& filter = block_filter.GetFilter();
+    BOOST_CHECK_EQUAL(filter.GetN(), 2U);
+    BOOST_CHECK(filter.Match(spent_id.vec()));
+    BOOST_CHECK(filter.Match(GCSFilter::Element(pegout_script.begin(), pegout_script.end())));
+    BOOST_CHECK(!filter.Match(SecretKey::Random().vec()));
+
+    // Blocks without MWEB data produce an empty filter.
+    CBlock canonical_block;
+    BlockFilter empty_filter(BlockFilterType::MWEB, canonical_block, CBlockUndo());
+    BOOST_CHECK_EQUAL(empty_filter.GetFilter().GetN(), 0U);
+}
+
 BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 {
     UniValue json;
@@ -188,6 +219,10 @@ BOOST_AUTO_TEST_CASE(blockfilter_type_names)
     BOOST_CHECK(BlockFilterTypeByName("basic", filter_type));
     BOOST_CHECK_EQUAL(filter_type, BlockFilterType::BASIC);
 
+    BOOST_CHECK_EQUAL(BlockFilterTypeName(BlockFilterType::MWEB), "mweb");
+    BOOST_CHECK(BlockFilterTypeByName("mweb", filter_type));
+    BOOST_CHECK_EQUAL(filter_type, BlockFilterType::MWEB);
+
     BOOST_CHECK(!BlockFilterTypeByName("unknown", filter_type));
 }
 
@@ -913,4 +913,30 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_db_version)
+{
+    CCoinsViewDB db{"test", /*nCacheSize*/ 1 << 20, /*fMemory*/ true, /*fWipe*/ false};
+    BOOST_CHECK(db.WriteVersion());
+
+    // Releases before the version find it where they look for per-tx coins records to upgrade,
+    // and fail to parse its one-byte value as one.
+    const std::pair<unsigned char, uint256> version_key{'c', uint256S("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff")};
+    std::unique_ptr<CDBIterator> cursor(db.GetDB()->NewIterator());
+    cursor->Seek(std::make_pair('c', uint256()));
+    std::pair<unsigned char, uint256> key;
+    BOOST_REQUIRE(cursor->Valid() && cursor->GetKey(key));
+    BOOST_CHECK(key == version_key);
+    BOOST_CHECK_EQUAL(cursor->GetValueSize(), 1U);
+
+    // Releases with the version skip it when upgrading.
+    BOOST_CHECK(db.Upgrade());
+    uint8_t version = 0;
+    BOOST_CHECK(db.GetDB()->Read(version_key, version));
+    BOOST_CHECK_EQUAL(version, CHAINSTATE_VERSION);
+
+    // A database written by a newer version is refused.
+    BOOST_REQUIRE(db.GetDB()->Write(version_key, uint8_t(CHAINSTATE_VERSION + 1)));
+    BOOST_CHECK(!db.WriteVersion());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
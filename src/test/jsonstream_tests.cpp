@@ -0,0 +1,77 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+BOOST_FIXTURE_TEST_SUITE(jsonstream_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(jsonstream_matches_univalue)
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("str", "a \"quoted\"\nstring");
+    inner.pushKV("num", 42);
+    inner.pushKV("empty", UniValue(UniValue::VARR));
+
+    UniValue arr(UniValue::VARR);
+    arr.push_back(inner);
+    arr.push_back(NullUniValue);
+    arr.push_back(UniValue(UniValue::VOBJ));
+
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKV("hash", "00ff");
+    expected.pushKV("items", arr);
+    expected.pushKV("flag", true);
+
+    std::string out;
+    JSONStreamWriter writer([&out](std::string&& chunk) { out += chunk; });
+    writer.BeginObject();
+    writer.KeyValue("hash", "00ff");
+    writer.Key("items");
+    writer.BeginArray();
+    writer.Value(inner);
+    writer.Value(NullUniValue);
+    writer.BeginObject();
+    writer.EndObject();
+    writer.EndArray();
+    writer.KeyValue("flag", true);
+    writer.EndObject();
+    BOOST_CHECK(out.empty());
+    writer.Flush();
+
+    BOOST_CHECK_EQUAL(out, expected.write());
+}
+
+BOOST_AUTO_TEST_CASE(jsonstream_chunks)
+{
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer([&chunks](std::string&& chunk) { chunks.push_back(std::move(chunk)); }, 16);
+    UniValue expected(UniValue::VARR);
+    writer.BeginArray();
+    for (int i = 0; i < 100; ++i) {
+        expected.push_back(i);
+        writer.Value(i);
+    }
+    writer.EndArray();
+    writer.Flush();
+
+    BOOST_CHECK(chunks.size() > 1);
+    std::string out;
+    for (const std::string& chunk : chunks) {
+        BOOST_CHECK(!chunk.empty());
+        out += chunk;
+    }
+    BOOST_CHECK_EQUAL(out, expected.write());
+
+    // Flushing again hands nothing to the sink
+    const size_t num_chunks = chunks.size();
+    writer.Flush();
+    BOOST_CHECK_EQUAL(chunks.size(), num_chunks);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 #include <consensus/tx_verify.h>
 #include <miner.h>
 #include <policy/policy.h>
+#include <pow.h>
 #include <script/standard.h>
 #include <txmempool.h>
 #include <uint256.h>
@@ -19,6 +20,7 @@
 
 #include <test/util/setup_common.h>
 
+#include <limits>
 #include <memory>
 
 #include <boost/test/unit_test.hpp>
@@ -515,4 +517,44 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     fCheckpointsEnabled = true;
 }
 
+BOOST_AUTO_TEST_CASE(SolveBlock_threads)
+{
+    const auto regtest = CreateChainParams(*m_node.args, CBaseChainParams::REGTEST);
+    const Consensus::Params& consensus = regtest->GetConsensus();
+
+    CBlockHeader header = regtest->GenesisBlock().GetBlockHeader();
+    header.nNonce = 0;
+
+    // A serial search is the reference for the search on the nonce search threads
+    CBlockHeader expected = header;
+    while (!CheckProofOfWork(expected.GetPoWHash(), expected.nBits, consensus)) {
+        ++expected.nNonce;
+    }
+    BOOST_REQUIRE_LT(expected.nNonce, 1000U);
+
+    // Solving repeatedly reuses the same threads
+    for (int i = 0; i < 3; ++i) {
+        CBlockHeader solved = header;
+        uint64_t max_tries = 1000;
+        BOOST_CHECK(SolveBlock(solved, consensus, max_tries));
+        BOOST_CHECK_EQUAL(solved.nNonce, expected.nNonce);
+        BOOST_CHECK_EQUAL(max_tries, 1000U - expected.nNonce);
+    }
+
+    // Running out of tries leaves the block at the first untried nonce
+    CBlockHeader unsolved = header;
+    unsolved.nBits = 0x1d00ffff;
+    uint64_t max_tries = 3;
+    BOOST_CHECK(!SolveBlock(unsolved, consensus, max_tries));
+    BOOST_CHECK_EQUAL(unsolved.nNonce, 3U);
+    BOOST_CHECK_EQUAL(max_tries, 0U);
+
+    // The range is clamped to the nonces below the maximum, without overflowing
+    unsolved.nNonce = std::numeric_limits<uint32_t>::max() - 2;
+    max_tries = std::numeric_limits<uint64_t>::max();
+    BOOST_CHECK(!SolveBlock(unsolved, consensus, max_tries));
+    BOOST_CHECK_EQUAL(unsolved.nNonce, std::numeric_limits<uint32_t>::max());
+    BOOST_CHECK_EQUAL(max_tries, std::numeric_limits<uint64_t>::max() - 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/params.h>
+#include <consensus/validation.h>
+#include <mweb/mweb_node.h>
+#include <net.h>
+#include <net_processing.h>
+#include <netmessagemaker.h>
+#include <primitives/block.h>
+#include <script/standard.h>
+#include <validation.h>
+
+#include <test/util/logging.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+#include <test_framework/Malformed.h>
+#include <test_framework/Miner.h>
+#include <test_framework/TxBuilder.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+/** Regtest chain on which MWEB is active from the genesis block. */
+struct MWEBActiveTestingSetup : public TestingSetup {
+    MWEBActiveTestingSetup()
+        : TestingSetup(CBaseChainParams::REGTEST, {strprintf("-vbparams=mweb:%d:%d", int64_t{Consensus::BIP9Deployment::ALWAYS_ACTIVE}, int64_t{Consensus::BIP9Deployment::NO_TIMEOUT}).c_str()}) {}
+};
+} // namespace
+
+/** Builds a block on top of the genesis block that pegs in the coin of the MWEB block's only kernel. */
+static CBlock BuildPegInBlock(const mw::Block::CPtr& mweb_block, const PegInCoin& pegin)
+{
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+
+    CMutableTransaction pegin_tx;
+    pegin_tx.vin.emplace_back(COutPoint(uint256::ONE, 1));
+    pegin_tx.vout.emplace_back(pegin.GetAmount(), GetScriptForPegin(pegin.GetKernelID()));
+
+    CMutableTransaction hogex;
+    hogex.m_hogEx = true;
+    hogex.vin.emplace_back(COutPoint(uint256::ONE, 0));
+    hogex.vin.emplace_back(COutPoint(pegin_tx.GetHash(), 0));
+    hogex.vout.emplace_back(pegin.GetAmount(), CScript() << OP_8 << mweb_block->GetHash().vec());
+
+    CBlock block;
+    block.vtx = {MakeTransactionRef(std::move(coinbase)), MakeTransactionRef(std::move(pegin_tx)), MakeTransactionRef(std::move(hogex))};
+    block.mweb_block = MWEB::Block(mweb_block);
+    return block;
+}
+
+/** Wraps an MWEB transaction in a transaction without canonical inputs or outputs. */
+static CTransactionRef MakeMWEBOnlyTx(const mw::Transaction::CPtr& mweb_tx)
+{
+    CMutableTransaction tx;
+    tx.mweb_tx = MWEB::Tx(mweb_tx);
+    return MakeTransactionRef(std::move(tx));
+}
+
+static mw::Transaction::CPtr BuildMWEBTx()
+{
+    return test::TxBuilder().AddInput(5'000'000).AddOutput(4'000'000).AddPlainKernel(1'000'000).Build().GetTransaction();
+}
+
+BOOST_FIXTURE_TEST_SUITE(mweb_tests, MWEBActiveTestingSetup)
+
+BOOST_AUTO_TEST_CASE(block_crypto_checks_malformed_points)
+{
+    // The test setup verifies MWEB signatures and range proofs on the check queue's worker threads.
+    BOOST_REQUIRE(g_parallel_script_checks);
+
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const CBlockIndex* pindex_prev = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+
+    test::Miner miner(GetDataDir());
+    test::Tx pegin_tx = test::Tx::CreatePegIn(5'000'000);
+    mw::Block::CPtr mweb_block = miner.MineBlock(1, {pegin_tx}).GetBlock();
+
+    BlockValidationState state;
+    BOOST_CHECK(MWEB::Node::ContextualCheckBlock(BuildPegInBlock(mweb_block, pegin_tx.GetPegInCoin()), consensus, pindex_prev, state));
+
+    // A malformed kernel excess throws while the checks are built on the validating thread.
+    auto bad_kernel_block = std::make_shared<const mw::Block>(mweb_block->GetHeader(), test::WithMalformedKernelExcess(mweb_block->GetTxBody()));
+    state = BlockValidationState{};
+    BOOST_CHECK(!MWEB::Node::ContextualCheckBlock(BuildPegInBlock(bad_kernel_block, pegin_tx.GetPegInCoin()), consensus, pindex_prev, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-blk-mweb");
+
+    // A malformed output commitment throws while a worker thread verifies the range proofs.
+    auto bad_output_block = std::make_shared<const mw::Block>(mweb_block->GetHeader(), test::WithMalformedOutputCommitment(mweb_block->GetTxBody()));
+    state = BlockValidationState{};
+    BOOST_CHECK(!MWEB::Node::ContextualCheckBlock(BuildPegInBlock(bad_output_block, pegin_tx.GetPegInCoin()), consensus, pindex_prev, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-blk-mweb");
+}
+
+BOOST_AUTO_TEST_CASE(batch_verify_queued_txs)
+{
+    ConnmanTestMsg connman{0x1337, 0x1337};
+    PeerManager peerman{Params(), connman, nullptr, *m_node.scheduler, *m_node.chainman, *m_node.mempool};
+    std::atomic<bool> interrupt{false};
+
+    CNode node{0, NODE_NETWORK, 0, INVALID_SOCKET, CAddress{CService{in_addr{0x0100007f}, 7777}, NODE_NETWORK}, 0, 0, CAddress{}, std::string{}, ConnectionType::INBOUND};
+    node.fSuccessfullyConnected = true;
+    node.nVersion = PROTOCOL_VERSION;
+    node.SetCommonVersion(PROTOCOL_VERSION);
+    peerman.InitializeNode(&node);
+
+    const CNetMsgMaker msg_maker(PROTOCOL_VERSION);
+    auto receive = [&](CSerializedNetMsg msg) { BOOST_REQUIRE(connman.ReceiveMsgFrom(node, msg)); };
+    auto num_queued = [&]() { return WITH_LOCK(node.cs_vProcessMsg, return node.vProcessMsg.size()); };
+
+    // Queued transactions are deserialized in place when the first of a burst is processed.
+    receive(msg_maker.Make(NetMsgType::TX, *MakeMWEBOnlyTx(BuildMWEBTx())));
+    receive(msg_maker.Make(NetMsgType::TX, *MakeMWEBOnlyTx(BuildMWEBTx())));
+    peerman.ProcessMessages(&node, interrupt);
+    BOOST_REQUIRE_EQUAL(num_queued(), 1U);
+    BOOST_CHECK(WITH_LOCK(node.cs_vProcessMsg, return node.vProcessMsg.front().m_recv.empty()));
+    peerman.ProcessMessages(&node, interrupt);
+    BOOST_CHECK_EQUAL(num_queued(), 0U);
+
+    // A malformed point fails the batch rather than terminating, and each transaction is then verified on its own.
+    // A malformed message is skipped by the batch, and rejected when it is processed.
+    const mw::Transaction::CPtr valid_tx = BuildMWEBTx();
+    auto bad_tx = std::make_shared<const mw::Transaction>(valid_tx->GetKernelOffset(), valid_tx->GetStealthOffset(), test::WithMalformedKernelExcess(valid_tx->GetBody()));
+    receive(msg_maker.Make(NetMsgType::TX, *MakeMWEBOnlyTx(BuildMWEBTx())));
+    receive(msg_maker.Make(NetMsgType::TX, *MakeMWEBOnlyTx(bad_tx)));
+    receive(msg_maker.Make(NetMsgType::TX, uint8_t{0}));
+    {
+        ASSERT_DEBUG_LOG("MWEB batch of 2 transactions from peer=0 failed");
+        peerman.ProcessMessages(&node, interrupt);
+    }
+    peerman.ProcessMessages(&node, interrupt);
+    {
+        ASSERT_DEBUG_LOG("Malformed tx message");
+        peerman.ProcessMessages(&node, interrupt);
+    }
+    BOOST_CHECK_EQUAL(num_queued(), 0U);
+    BOOST_CHECK(!node.fDisconnect);
+
+    bool dummy;
+    peerman.FinalizeNode(node, dummy);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,10 +8,13 @@
 #include <clientversion.h>
 #include <cstdint>
 #include <net.h>
+#include <net_processing.h>
 #include <netbase.h>
+#include <netmessagemaker.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/net.h>
 #include <test/util/setup_common.h>
 #include <util/memory.h>
 #include <util/strencodings.h>
@@ -83,6 +86,36 @@ static CDataStream AddrmanToStream(CAddrManSerializationMock& _addrman)
     return CDataStream(vchData, SER_DISK, CLIENT_VERSION);
 }
 
+#ifdef USE_EPOLL
+/** The bytes a peer sends for a message. */
+static std::vector<unsigned char> WireBytes(CSerializedNetMsg msg)
+{
+    std::vector<unsigned char> bytes;
+    V1TransportSerializer{}.prepareForTransport(msg, bytes);
+    bytes.insert(bytes.end(), msg.data.begin(), msg.data.end());
+    return bytes;
+}
+
+static void SendAll(SOCKET socket, const unsigned char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+        BOOST_REQUIRE(sent > 0);
+        data += sent;
+        size -= sent;
+    }
+}
+
+static void ReadAvailable(SOCKET socket, std::vector<unsigned char>& received)
+{
+    unsigned char buf[0x10000];
+    ssize_t nBytes;
+    while ((nBytes = recv(socket, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        received.insert(received.end(), buf, buf + nBytes);
+    }
+}
+#endif
+
 BOOST_FIXTURE_TEST_SUITE(net_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(cnode_listen_port)
@@ -241,6 +274,101 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK_EQUAL(pnode4->ConnectedThroughNetwork(), Network::NET_ONION);
 }
 
+#ifdef USE_EPOLL
+BOOST_FIXTURE_TEST_CASE(epoll_socket_events, TestingSetup)
+{
+    ConnmanTestMsg connman{0x1337, 0x1337};
+    CConnman::Options options;
+    options.nReceiveFloodSize = 0x1000;
+    options.nSendBufferMaxSize = 0x1000;
+    options.m_socket_events_mode = SocketEventsMode::EPOLL;
+    connman.Init(options);
+    BOOST_REQUIRE(connman.StartSocketEvents());
+    PeerManager peerman{Params(), connman, nullptr, *m_node.scheduler, *m_node.chainman, *m_node.mempool};
+    std::atomic<bool> interrupt{false};
+
+    // A connected pair of local sockets, the first for the node and the second for its peer.
+    int sockets[2];
+    BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    SOCKET node_socket = sockets[0];
+    SOCKET peer_socket = sockets[1];
+    CNode* node = new CNode{0, NODE_NETWORK, 0, node_socket, CAddress{CService{in_addr{0x0100007f}, 7777}, NODE_NETWORK}, 0, 0, CAddress{}, std::string{}, ConnectionType::INBOUND};
+    peerman.InitializeNode(node);
+    connman.RegisterSocketEvents(node);
+    connman.AddTestNode(*node);
+
+    auto recv_bytes = [&] { return WITH_LOCK(node->cs_vRecv, return node->nRecvBytes); };
+    auto send_bytes = [&] { return WITH_LOCK(node->cs_vSend, return node->nSendBytes); };
+    auto num_received = [&] { return WITH_LOCK(node->cs_vProcessMsg, return node->vProcessMsg.size()); };
+
+    // Take the events of the newly registered socket.
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), 0U);
+    BOOST_CHECK(!node->m_recv_ready);
+
+    // A message is read as it arrives, up to 64 KiB at a time. The node is only read
+    // from again without a new edge when the last read didn't drain the socket.
+    const CNetMsgMaker msg_maker(INIT_PROTO_VERSION);
+    const std::vector<unsigned char> big_msg = WireBytes(msg_maker.Make(NetMsgType::PING, std::vector<unsigned char>(100000)));
+    SendAll(peer_socket, big_msg.data(), 30);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), 30U);
+    BOOST_CHECK(!node->m_recv_ready);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), 30U);
+
+    SendAll(peer_socket, big_msg.data() + 30, big_msg.size() - 30);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), 30U + 0x10000);
+    BOOST_CHECK(node->m_recv_ready);
+    BOOST_CHECK_EQUAL(num_received(), 0U);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), big_msg.size());
+    BOOST_CHECK_EQUAL(num_received(), 1U);
+
+    // The node isn't read from while its process queue is over the flood size, and
+    // processing the queue resumes reading without waiting for another edge.
+    BOOST_CHECK(node->fPauseRecv);
+    const std::vector<unsigned char> small_msg = WireBytes(msg_maker.Make(NetMsgType::PING, uint64_t{1}));
+    SendAll(peer_socket, small_msg.data(), small_msg.size());
+    connman.SocketHandler();
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), big_msg.size());
+    peerman.ProcessMessages(node, interrupt);
+    BOOST_CHECK(!node->fPauseRecv);
+    BOOST_CHECK_EQUAL(num_received(), 0U);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(recv_bytes(), big_msg.size() + small_msg.size());
+    BOOST_CHECK_EQUAL(num_received(), 1U);
+
+    // When sending would block, the node waits for an EPOLLOUT edge, which the peer
+    // reading from its end of the connection triggers.
+    CSerializedNetMsg send_msg = msg_maker.Make(NetMsgType::PING, std::vector<unsigned char>(1000000));
+    const uint64_t send_size = CMessageHeader::HEADER_SIZE + send_msg.data.size();
+    connman.PushMessage(node, std::move(send_msg));
+    BOOST_CHECK(!node->m_send_ready);
+    const uint64_t sent_optimistically = send_bytes();
+    BOOST_CHECK_LT(sent_optimistically, send_size);
+    connman.SocketHandler();
+    BOOST_CHECK_EQUAL(send_bytes(), sent_optimistically);
+
+    std::vector<unsigned char> received;
+    for (int i = 0; i < 1000 && send_bytes() < send_size; i++) {
+        ReadAvailable(peer_socket, received);
+        connman.SocketHandler();
+    }
+    ReadAvailable(peer_socket, received);
+    BOOST_CHECK_EQUAL(send_bytes(), send_size);
+    BOOST_CHECK_EQUAL(received.size(), send_size);
+    BOOST_CHECK(WITH_LOCK(node->cs_vSend, return node->vSendMsg.empty()));
+
+    bool dummy;
+    peerman.FinalizeNode(*node, dummy);
+    connman.ClearTestNodes();
+    CloseSocket(peer_socket);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(cnetaddr_basic)
 {
     CNetAddr addr;
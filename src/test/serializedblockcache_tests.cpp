@@ -0,0 +1,131 @@
+// Copyright (c) 2023 The OpayK Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <net.h>
+#include <net_processing.h>
+#include <netmessagemaker.h>
+#include <primitives/block.h>
+#include <protocol.h>
+#include <serializedblockcache.h>
+#include <streams.h>
+#include <validation.h>
+
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+static SerializedBlockCache::Data MakeData(size_t size, uint8_t fill)
+{
+    return std::make_shared<const std::vector<uint8_t>>(size, fill);
+}
+
+BOOST_FIXTURE_TEST_SUITE(serializedblockcache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used)
+{
+    SerializedBlockCache cache{100};
+    const uint256 hash1{uint256S("01")}, hash2{uint256S("02")}, hash3{uint256S("03")};
+
+    cache.Put(hash1, 0, MakeData(40, 1));
+    cache.Put(hash2, 0, MakeData(40, 2));
+    BOOST_CHECK(cache.Get(hash1, 0));
+
+    // Going over the byte budget evicts the least recently used entry, which
+    // is hash2 since hash1 was just looked up.
+    cache.Put(hash3, 0, MakeData(40, 3));
+    BOOST_CHECK(cache.Get(hash1, 0));
+    BOOST_CHECK(!cache.Get(hash2, 0));
+    BOOST_CHECK(cache.Get(hash3, 0));
+
+    BOOST_CHECK_EQUAL(cache.GetHits(), 3U);
+
+    // Adding an entry that needs all of the budget evicts everything else.
+    cache.Put(hash2, 0, MakeData(100, 2));
+    BOOST_CHECK(!cache.Get(hash1, 0));
+    BOOST_CHECK(!cache.Get(hash3, 0));
+    BOOST_CHECK_EQUAL(cache.Get(hash2, 0)->size(), 100U);
+
+    // An entry larger than the budget isn't cached, and evicts nothing.
+    cache.Put(hash1, 0, MakeData(101, 1));
+    BOOST_CHECK(!cache.Get(hash1, 0));
+    BOOST_CHECK(cache.Get(hash2, 0));
+}
+
+BOOST_AUTO_TEST_CASE(keyed_by_hash_and_flags)
+{
+    SerializedBlockCache cache{100};
+    const uint256 hash1{uint256S("01")}, hash2{uint256S("02")};
+
+    cache.Put(hash1, SERIALIZE_NO_MWEB, MakeData(10, 1));
+    cache.Put(hash1, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB, MakeData(10, 2));
+    cache.Put(hash2, SERIALIZE_NO_MWEB, MakeData(10, 3));
+
+    BOOST_CHECK(!cache.Get(hash1, 0));
+    BOOST_CHECK(!cache.Get(hash2, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB));
+    BOOST_CHECK_EQUAL(cache.Get(hash1, SERIALIZE_NO_MWEB)->front(), 1);
+    BOOST_CHECK_EQUAL(cache.Get(hash1, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB)->front(), 2);
+    BOOST_CHECK_EQUAL(cache.Get(hash2, SERIALIZE_NO_MWEB)->front(), 3);
+
+    // An existing entry isn't replaced.
+    cache.Put(hash1, SERIALIZE_NO_MWEB, MakeData(10, 4));
+    BOOST_CHECK_EQUAL(cache.Get(hash1, SERIALIZE_NO_MWEB)->front(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(served_blocks_match_reserialized_blocks, TestChain100Setup)
+{
+    ConnmanTestMsg connman{0x1337, 0x1337};
+    PeerManager peerman{Params(), connman, nullptr, *m_node.scheduler, *m_node.chainman, *m_node.mempool};
+    std::atomic<bool> interrupt{false};
+
+    CNode node{0, NODE_NETWORK, 0, INVALID_SOCKET, CAddress{CService{in_addr{0x0100007f}, 7777}, NODE_NETWORK}, 0, 0, CAddress{}, std::string{}, ConnectionType::INBOUND};
+    node.fSuccessfullyConnected = true;
+    node.nVersion = PROTOCOL_VERSION;
+    node.SetCommonVersion(PROTOCOL_VERSION);
+    peerman.InitializeNode(&node);
+
+    // Deeper than MAX_CMPCTBLOCK_DEPTH, so a compact block request is answered with the full block.
+    const CBlockIndex* pindex = WITH_LOCK(cs_main, return ::ChainActive()[::ChainActive().Height() - 10]);
+    CBlock block;
+    BOOST_REQUIRE(ReadBlockFromDisk(block, pindex, Params().GetConsensus()));
+
+    const CNetMsgMaker msg_maker(PROTOCOL_VERSION);
+    const std::vector<std::pair<GetDataMsg, int>> requests{
+        {MSG_BLOCK, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB},
+        {MSG_WITNESS_BLOCK, SERIALIZE_NO_MWEB},
+        {MSG_MWEB_BLOCK, 0},
+        {MSG_CMPCT_BLOCK, SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_NO_MWEB},
+    };
+    std::set<int> cached_flags;
+    for (const auto& request : requests) {
+        std::vector<uint8_t> expected;
+        CVectorWriter{SER_NETWORK, PROTOCOL_VERSION | request.second, expected, 0, block};
+
+        // Once a block is served with some flags, it's served from the cache, except for the
+        // block read from disk as is. The fallback for the compact block uses the cache of MSG_BLOCK.
+        for (int i = 0; i < 2; i++) {
+            const uint64_t hits = GetSerializedBlockCacheHits();
+            const bool cached = cached_flags.count(request.second) > 0;
+            CSerializedNetMsg getdata = msg_maker.Make(NetMsgType::GETDATA, std::vector<CInv>{CInv(request.first, block.GetHash())});
+            BOOST_REQUIRE(connman.ReceiveMsgFrom(node, getdata));
+            peerman.ProcessMessages(&node, interrupt);
+            BOOST_CHECK_EQUAL(GetSerializedBlockCacheHits(), hits + (cached ? 1 : 0));
+            if (request.second != 0) cached_flags.insert(request.second);
+
+            std::vector<CSerializedNetMsg> sent = connman.TakeSentMsgs(node);
+            BOOST_REQUIRE_EQUAL(sent.size(), 1U);
+            BOOST_CHECK_EQUAL(sent[0].m_type, NetMsgType::BLOCK);
+            BOOST_CHECK(sent[0].data == expected);
+        }
+    }
+    BOOST_CHECK(!node.fDisconnect);
+
+    bool dummy;
+    peerman.FinalizeNode(node, dummy);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,8 @@
 
 #include <chainparams.h>
 #include <net.h>
+#include <protocol.h>
+#include <streams.h>
 
 void ConnmanTestMsg::NodeReceiveMsgBytes(CNode& node, const char* pch, unsigned int nBytes, bool& complete) const
 {
@@ -37,3 +39,32 @@ bool ConnmanTestMsg::ReceiveMsgFrom(CNode& node, CSerializedNetMsg& ser_msg) con
     NodeReceiveMsgBytes(node, (const char*)ser_msg.data.data(), ser_msg.data.size(), complete);
     return complete;
 }
+
+size_t ConnmanTestMsg::ClearProcessMsg(CNode& node) const
+{
+    LOCK(node.cs_vProcessMsg);
+    const size_t num_msgs = node.vProcessMsg.size();
+    node.vProcessMsg.clear();
+    node.nProcessQueueSize = 0;
+    node.fPauseRecv = false;
+    return num_msgs;
+}
+
+std::vector<CSerializedNetMsg> ConnmanTestMsg::TakeSentMsgs(CNode& node) const
+{
+    std::vector<CSerializedNetMsg> msgs;
+    LOCK(node.cs_vSend);
+    for (auto it = node.vSendMsg.begin(); it != node.vSendMsg.end(); ++it) {
+        CMessageHeader hdr;
+        CDataStream{*it, SER_NETWORK, PROTOCOL_VERSION} >> hdr;
+        CSerializedNetMsg msg;
+        msg.m_type = hdr.GetCommand();
+        if (hdr.nMessageSize > 0) msg.data = std::move(*++it);
+        msgs.push_back(std::move(msg));
+    }
+    node.vSendMsg.clear();
+    node.nSendSize = 0;
+    node.nSendOffset = 0;
+    node.fPauseSend = false;
+    return msgs;
+}
@@ -18,6 +18,7 @@ struct ConnmanTestMsg : public CConnman {
     {
         LOCK(cs_vNodes);
         for (CNode* node : vNodes) {
+            UnregisterSocketEvents(*node);
             delete node;
         }
         vNodes.clear();
@@ -25,9 +26,19 @@ struct ConnmanTestMsg : public CConnman {
 
     void ProcessMessagesOnce(CNode& node) { m_msgproc->ProcessMessages(&node, flagInterruptMsgProc); }
 
+    using CConnman::StartSocketEvents;
+    using CConnman::RegisterSocketEvents;
+    using CConnman::SocketHandler;
+
+    /** Drop the messages received from the node, returning how many there were. */
+    size_t ClearProcessMsg(CNode& node) const;
+
     void NodeReceiveMsgBytes(CNode& node, const char* pch, unsigned int nBytes, bool& complete) const;
 
     bool ReceiveMsgFrom(CNode& node, CSerializedNetMsg& ser_msg) const;
+
+    /** Take the messages queued for sending to a node without a socket. */
+    std::vector<CSerializedNetMsg> TakeSentMsgs(CNode& node) const;
 };
 
 #endif // BITCOIN_TEST_UTIL_NET_H
@@ -13,6 +13,7 @@
 #include <init.h>
 #include <interfaces/chain.h>
 #include <miner.h>
+#include <mweb/mweb_node.h>
 #include <net.h>
 #include <net_processing.h>
 #include <noui.h>
@@ -164,6 +165,9 @@ TestingSetup::TestingSetup(const std::string& chainName, const std::vector<const
     constexpr int script_check_threads = 2;
     for (int i = 0; i < script_check_threads; ++i) {
         threadGroup.create_thread([i]() { return ThreadScriptCheck(i); });
+        threadGroup.create_thread([i]() { return ThreadHeaderPoWCheck(i); });
+        threadGroup.create_thread([i]() { return MWEB::ThreadCryptoCheck(i); });
+        threadGroup.create_thread([i]() { return ThreadNonceSearch(i); });
     }
     g_parallel_script_checks = true;
 
@@ -212,6 +212,33 @@ BOOST_AUTO_TEST_CASE(processnewblock_signals_ordering)
     BOOST_CHECK_EQUAL(sub->m_expected_tip, ::ChainActive().Tip()->GetBlockHash());
 }
 
+BOOST_AUTO_TEST_CASE(processnewblockheaders_parallel_pow)
+{
+    std::vector<CBlockHeader> headers;
+    uint256 prev_hash = Params().GenesisBlock().GetHash();
+    for (int i = 0; i < 10; ++i) {
+        auto block = GoodBlock(prev_hash);
+        headers.push_back(block->GetBlockHeader());
+        prev_hash = block->GetHash();
+    }
+
+    // Break the proof of work of a header in the middle of the batch
+    CBlockHeader& bad_header = headers[6];
+    while (CheckProofOfWork(bad_header.GetPoWHash(), bad_header.nBits, Params().GetConsensus())) {
+        ++bad_header.nNonce;
+    }
+
+    BlockValidationState state;
+    BOOST_CHECK(!Assert(m_node.chainman)->ProcessNewBlockHeaders(headers, state, Params()));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "high-hash");
+
+    // Headers before the invalid one are accepted, the rest are not
+    LOCK(cs_main);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        BOOST_CHECK_EQUAL(LookupBlockIndex(headers[i].GetHash()) != nullptr, i < 6);
+    }
+}
+
 /**
  * Test that mempool updates happen atomically with reorgs.
  *
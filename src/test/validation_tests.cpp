@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chainparams.h>
+#include <clientversion.h>
 #include <net.h>
+#include <pow.h>
 #include <signet.h>
 #include <validation.h>
 
@@ -58,4 +60,49 @@ BOOST_AUTO_TEST_CASE(subsidy_limit_test)
     BOOST_CHECK_EQUAL(nSum, CAmount{8399999990760000});
 }
 
+BOOST_AUTO_TEST_CASE(read_block_check_pow_test)
+{
+    const CChainParams& chainparams = Params();
+
+    // A block whose target is far below anything its hash can meet.
+    CBlock bad_pow_block = chainparams.GenesisBlock();
+    bad_pow_block.nBits = 0x1d00ffff;
+    BOOST_CHECK(!CheckProofOfWork(bad_pow_block.GetPoWHash(), bad_pow_block.nBits, chainparams.GetConsensus()));
+
+    // Append it to a block file that no other block uses.
+    FlatFilePos pos(1000, 0);
+    {
+        CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+        fileout << chainparams.MessageStart() << (unsigned int)GetSerializeSize(bad_pow_block, fileout.GetVersion());
+        pos.nPos = ftell(fileout.Get());
+        fileout << bad_pow_block;
+    }
+
+    const uint256 hash = bad_pow_block.GetHash();
+    CBlockIndex index{bad_pow_block};
+    index.phashBlock = &hash;
+    index.nFile = pos.nFile;
+    index.nDataPos = pos.nPos;
+    index.nStatus |= BLOCK_HAVE_DATA;
+
+    CBlock block;
+    const bool check_block_pow = fCheckBlockPoW;
+
+    // By default the block index is trusted, so the PoW isn't checked again.
+    fCheckBlockPoW = false;
+    BOOST_CHECK(ReadBlockFromDisk(block, &index, chainparams.GetConsensus()));
+    BOOST_CHECK_EQUAL(block.GetHash(), hash);
+
+    // -checkblockpow re-verifies it.
+    fCheckBlockPoW = true;
+    BOOST_CHECK(!ReadBlockFromDisk(block, &index, chainparams.GetConsensus()));
+
+    // Reads by position (as in -reindex) always check the PoW.
+    fCheckBlockPoW = false;
+    BOOST_CHECK(!ReadBlockFromDisk(block, pos, chainparams.GetConsensus()));
+
+    fCheckBlockPoW = check_block_pow;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
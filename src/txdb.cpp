@@ -30,6 +30,14 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+/**
+ * Key of the chainstate version. It sorts after the per-tx coins records
+ * (DB_COINS) of the format used before 0.15, and its one-byte value is too
+ * short to parse as one, so releases that predate it fail in Upgrade() and
+ * refuse to open the database rather than misreading it.
+ */
+static const std::pair<unsigned char, uint256> DB_VERSION{DB_COINS, uint256S("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff")};
+
 namespace {
 
 struct CoinEntry {
@@ -370,6 +378,14 @@ public:
 
 }
 
+bool CCoinsViewDB::WriteVersion() {
+    uint8_t version = 0;
+    if (m_db->Read(DB_VERSION, version) && version > CHAINSTATE_VERSION) {
+        return error("%s: chainstate database version %d is newer than the supported version %d", __func__, (int)version, (int)CHAINSTATE_VERSION);
+    }
+    return m_db->Write(DB_VERSION, CHAINSTATE_VERSION, true);
+}
+
 /** Upgrade the database from older formats.
  *
  * Currently implemented: from the per-tx utxo model (0.8..0.14.x) to per-txout.
@@ -377,7 +393,8 @@ public:
 bool CCoinsViewDB::Upgrade() {
     std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
     pcursor->Seek(std::make_pair(DB_COINS, uint256()));
-    if (!pcursor->Valid()) {
+    std::pair<unsigned char, uint256> key;
+    if (!pcursor->Valid() || (pcursor->GetKey(key) && key == DB_VERSION)) {
         return true;
     }
 
@@ -388,13 +405,12 @@ bool CCoinsViewDB::Upgrade() {
     size_t batch_size = 1 << 24;
     CDBBatch batch(*m_db);
     int reportDone = 0;
-    std::pair<unsigned char, uint256> key;
     std::pair<unsigned char, uint256> prev_key = {DB_COINS, uint256()};
     while (pcursor->Valid()) {
         if (ShutdownRequested()) {
             break;
         }
-        if (pcursor->GetKey(key) && key.first == DB_COINS) {
+        if (pcursor->GetKey(key) && key.first == DB_COINS && key != DB_VERSION) {
             if (count++ % 256 == 0) {
                 uint32_t high = 0x100 * *key.second.begin() + *(key.second.begin() + 1);
                 int percentageDone = (int)(high * 100.0 / 65536.0 + 0.5);
@@ -38,8 +38,15 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxTxIndexCache = 1024;
 //! Max memory allocated to all block filter index caches combined in MiB.
 static const int64_t max_filter_index_cache = 1024;
+//! Max memory allocated to MWEB output index DB specific cache (MiB)
+static const int64_t max_mweb_index_cache = 256;
+//! Max memory allocated to the MWEB MMR node hash cache (MiB)
+static const int64_t max_mmr_node_cache = 64;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Chainstate database version. Version 1 keys the MWEB UTXOs by binary output ID,
+//! and version 2 stores the MWEB leafset as compressed containers (lsetNNNNNN.dat).
+static const uint8_t CHAINSTATE_VERSION = 2;
 
 // Actually declared in validation.cpp; can't include because of circular dependency.
 extern RecursiveMutex cs_main;
@@ -69,6 +76,9 @@ public:
     mw::ICoinsView::Ptr GetMWEBView() const final { return mweb_view; }
     bool GetMWEBCoin(const mw::Hash& output_id, Output& coin) const final;
 
+    //! Mark the database with CHAINSTATE_VERSION, so releases that can't read it refuse to open it.
+    //! Returns false if the database was written by a newer version.
+    bool WriteVersion();
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
@@ -144,6 +144,7 @@ bool fPruneMode = false;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool fCheckBlockPoW = DEFAULT_CHECK_BLOCK_POW;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 
@@ -1173,7 +1174,7 @@ static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessa
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+static bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams, bool fCheckPOW)
 {
     block.SetNull();
 
@@ -1191,7 +1192,7 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     }
 
     // Check the header
-    if (!CheckProofOfWork(block.GetPoWHash(), block.nBits, consensusParams))
+    if (fCheckPOW && !CheckProofOfWork(block.GetPoWHash(), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
 
     // Signet only: check block solution
@@ -1202,6 +1203,24 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+{
+    return ReadBlockFromDisk(block, pos, consensusParams, /* fCheckPOW */ true);
+}
+
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const uint256& hash, const Consensus::Params& consensusParams)
+{
+    // A header only enters the block index after its proof of work has been
+    // checked, and the hash comparison below guarantees that the block read
+    // back carries that same header, so the slow hash need not be redone.
+    if (!ReadBlockFromDisk(block, pos, consensusParams, /* fCheckPOW */ fCheckBlockPoW))
+        return false;
+    if (block.GetHash() != hash)
+        return error("ReadBlockFromDisk(CBlock&, FlatFilePos, uint256): GetHash() doesn't match index for %s at %s",
+                hash.ToString(), pos.ToString());
+    return true;
+}
+
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
     FlatFilePos blockPos;
@@ -1210,12 +1229,7 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
         blockPos = pindex->GetBlockPos();
     }
 
-    if (!ReadBlockFromDisk(block, blockPos, consensusParams))
-        return false;
-    if (block.GetHash() != pindex->GetBlockHash())
-        return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
-                pindex->ToString(), pindex->GetBlockPos().ToString());
-    return true;
+    return ReadBlockFromDisk(block, blockPos, pindex->GetBlockHash(), consensusParams);
 }
 
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
@@ -1298,7 +1312,8 @@ void CChainState::InitCoinsDB(
     size_t cache_size_bytes,
     bool in_memory,
     bool should_wipe,
-    std::string leveldb_name)
+    std::string leveldb_name,
+    size_t mmr_node_cache_bytes)
 {
     if (!m_from_snapshot_blockhash.IsNull()) {
         leveldb_name += "_" + m_from_snapshot_blockhash.ToString();
@@ -1307,6 +1322,11 @@ void CChainState::InitCoinsDB(
     m_coins_views = MakeUnique<CoinsViews>(
         leveldb_name, cache_size_bytes, in_memory, should_wipe);
 
+    // Mark the database before the MWEB view migrates it, so older releases refuse to open it from then on.
+    if (!CoinsDB().WriteVersion()) {
+        throw std::runtime_error("Unsupported chainstate database version");
+    }
+
     CBlock block;
     CBlockIndex* pindex = LookupBlockIndex(CoinsDB().GetBestBlock());
     if (pindex != nullptr) {
@@ -1319,7 +1339,8 @@ void CChainState::InitCoinsDB(
     mw::CoinsViewDB::Ptr mweb_dbview = mw::CoinsViewDB::Open(
         FilePath{GetDataDir()},
         block.mweb_block.GetMWEBHeader(),
-        std::make_shared<MWEB::DBWrapper>(CoinsDB().GetDB())
+        std::make_shared<MWEB::DBWrapper>(CoinsDB().GetDB()),
+        mmr_node_cache_bytes > 0 ? std::make_shared<mmr::NodeCache>(mmr_node_cache_bytes) : nullptr
     );
     CoinsDB().SetMWEBView(mweb_dbview);
 }
@@ -1896,6 +1917,45 @@ void ThreadScriptCheck(int worker_num) {
     scriptcheckqueue.Thread();
 }
 
+/**
+ * Closure representing the proof-of-work check of a single header in a
+ * headers batch. The outcome is written to a caller-owned flag instead of
+ * being folded into the queue result, so that the headers preceding an
+ * invalid one can still be accepted.
+ */
+class CHeaderPoWCheck
+{
+private:
+    const CBlockHeader* m_header{nullptr};
+    const Consensus::Params* m_params{nullptr};
+    uint8_t* m_valid{nullptr};
+
+public:
+    CHeaderPoWCheck() = default;
+    CHeaderPoWCheck(const CBlockHeader& header, const Consensus::Params& params, uint8_t& valid) :
+        m_header(&header), m_params(&params), m_valid(&valid) { }
+
+    bool operator()()
+    {
+        *m_valid = CheckProofOfWork(m_header->GetPoWHash(), m_header->nBits, *m_params);
+        return true;
+    }
+
+    void swap(CHeaderPoWCheck& check)
+    {
+        std::swap(m_header, check.m_header);
+        std::swap(m_params, check.m_params);
+        std::swap(m_valid, check.m_valid);
+    }
+};
+
+static CCheckQueue<CHeaderPoWCheck> powcheckqueue(16);
+
+void ThreadHeaderPoWCheck(int worker_num) {
+    util::ThreadRename(strprintf("powch.%i", worker_num));
+    powcheckqueue.Thread();
+}
+
 VersionBitsCache versionbitscache GUARDED_BY(cs_main);
 
 int32_t ComputeBlockVersion(const CBlockIndex* pindexPrev, const Consensus::Params& params)
@@ -3718,7 +3778,7 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
     return true;
 }
 
-bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fCheckPOW)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
@@ -3738,7 +3798,7 @@ bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationS
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus())) {
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), fCheckPOW)) {
             LogPrint(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -3810,12 +3870,34 @@ bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationS
 bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, BlockValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
 {
     AssertLockNotHeld(cs_main);
+
+    // Verify the proof of work of all unknown headers on the check queue
+    // before taking cs_main for the contextual checks. A header whose flag
+    // is still unset is (re)checked serially by AcceptBlockHeader, which
+    // also produces the appropriate validation state if it is invalid.
+    std::vector<uint8_t> pow_valid(headers.size(), 0);
+    if (g_parallel_script_checks && headers.size() > 1) {
+        std::vector<CHeaderPoWCheck> checks;
+        checks.reserve(headers.size());
+        {
+            LOCK(cs_main);
+            for (size_t i = 0; i < headers.size(); ++i) {
+                if (m_blockman.m_block_index.count(headers[i].GetHash()) == 0) {
+                    checks.emplace_back(headers[i], chainparams.GetConsensus(), pow_valid[i]);
+                }
+            }
+        }
+        CCheckQueueControl<CHeaderPoWCheck> control(&powcheckqueue);
+        control.Add(checks);
+        control.Wait();
+    }
+
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
             bool accepted = m_blockman.AcceptBlockHeader(
-                header, state, chainparams, &pindex);
+                headers[i], state, chainparams, &pindex, /* fCheckPOW */ !pow_valid[i]);
             ::ChainstateActive().CheckBlockIndex(chainparams.GetConsensus());
 
             if (!accepted) {
@@ -73,7 +73,10 @@ static const int MAX_SCRIPTCHECK_THREADS = 15;
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
+/** Default for -checkblockpow */
+static const bool DEFAULT_CHECK_BLOCK_POW = false;
 static const bool DEFAULT_TXINDEX = false;
+static const bool DEFAULT_MWEBINDEX = false;
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -127,6 +130,8 @@ extern bool g_parallel_script_checks;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+/** Whether to re-verify the proof of work of blocks read from disk for a known block index entry. */
+extern bool fCheckBlockPoW;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
 /** If the tip is older than this (in seconds), the node is considered to be in initial block download. */
@@ -163,6 +168,8 @@ bool LoadGenesisBlock(const CChainParams& chainparams);
 void UnloadBlockIndex(CTxMemPool* mempool, ChainstateManager& chainman);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck(int worker_num);
+/** Run an instance of the header proof-of-work checking thread */
+void ThreadHeaderPoWCheck(int worker_num);
 /**
  * Return transaction from the block at block_index.
  * If block_index is not provided, fall back to mempool.
@@ -289,6 +296,7 @@ void InitScriptExecutionCache();
 
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams);
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const uint256& hash, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
@@ -439,12 +447,15 @@ public:
     /**
      * If a block header hasn't already been seen, call CheckBlockHeader on it, ensure
      * that it doesn't descend from an invalid block, and then add it to m_block_index.
+     * fCheckPOW may be cleared by callers that have already verified the header's
+     * proof of work.
      */
     bool AcceptBlockHeader(
         const CBlockHeader& block,
         BlockValidationState& state,
         const CChainParams& chainparams,
-        CBlockIndex** ppindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+        CBlockIndex** ppindex,
+        bool fCheckPOW = true) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     ~BlockManager() {
         Unload();
@@ -556,13 +567,15 @@ public:
      * Initialize the CoinsViews UTXO set database management data structures. The in-memory
      * cache is initialized separately.
      *
-     * All parameters forwarded to CoinsViews.
+     * All parameters but mmr_node_cache_bytes are forwarded to CoinsViews.
+     * mmr_node_cache_bytes bounds the memory used for caching MWEB MMR node hashes.
      */
     void InitCoinsDB(
         size_t cache_size_bytes,
         bool in_memory,
         bool should_wipe,
-        std::string leveldb_name = "chainstate");
+        std::string leveldb_name = "chainstate",
+        size_t mmr_node_cache_bytes = 0);
 
     //! Initialize the in-memory coins cache (to be done after the health of the on-disk database
     //! is verified).
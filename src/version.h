@@ -9,7 +9,7 @@
  * network protocol versioning
  */
 
-static const int PROTOCOL_VERSION = 70016;
+static const int PROTOCOL_VERSION = 70017;
 
 //! initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 209;
@@ -38,7 +38,10 @@ static const int INVALID_CB_NO_BAN_VERSION = 70015;
 //! "wtxidrelay" command for wtxid-based relay starts with this version
 static const int WTXID_RELAY_VERSION = 70016;
 
+//! MWEB inputs, outputs and kernels sent as short IDs in cmpctblocks starts with this version
+static const int MWEB_SHORT_IDS_VERSION = 70017;
+
 // Make sure that none of the values above collide with
-// `SERIALIZE_TRANSACTION_NO_WITNESS` or `ADDRV2_FORMAT`.
+// `SERIALIZE_TRANSACTION_NO_WITNESS`, `ADDRV2_FORMAT` or `SERIALIZE_MWEB_SHORT_IDS`.
 
 #endif // BITCOIN_VERSION_H
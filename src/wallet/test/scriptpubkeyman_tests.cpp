@@ -86,4 +86,47 @@ BOOST_AUTO_TEST_CASE(StealthAddresses)
     BOOST_CHECK(keyman.GetHDChain().nMWEBIndexCounter == 1002);
 }
 
+// Test that scanning a batch of outputs on multiple threads finds the same
+// coins as rewinding each output individually.
+BOOST_AUTO_TEST_CASE(RewindOutputsBatch)
+{
+    NodeContext node;
+    std::unique_ptr<interfaces::Chain> chain = interfaces::MakeChain(node);
+    CWallet wallet(chain.get(), "", CreateMockWalletDatabase());
+    wallet.SetMinVersion(WalletFeature::FEATURE_HD_SPLIT);
+    LegacyScriptPubKeyMan& keyman = *wallet.GetOrCreateLegacyScriptPubKeyMan();
+
+    CKey key = DecodeSecret("6usgJoGKXW12i7Ruxy8Z1C5hrRMVGfLmi9NU9uDQJMPXDJ6tQAH");
+    keyman.SetHDSeed(keyman.DeriveNewSeed(key));
+    keyman.TopUp();
+
+    mw::Keychain::Ptr mweb_keychain = keyman.GetMWEBKeychain();
+    BOOST_REQUIRE(mweb_keychain != nullptr);
+
+    // Spread a few owned outputs across several chunks of foreign ones.
+    std::vector<Output> outputs;
+    std::set<mw::Hash> owned_ids;
+    for (uint32_t i = 0; i < 300; i++) {
+        const bool owned = i % 97 == 0;
+        StealthAddress address = owned ? mweb_keychain->GetStealthAddress(2 + i) : StealthAddress::Random();
+        BlindingFactor blind;
+        outputs.push_back(Output::Create(&blind, SecretKey::Random(), address, 1000 + i));
+        if (owned) owned_ids.insert(outputs.back().GetOutputID());
+    }
+
+    std::vector<mw::Coin> coins = mweb_keychain->RewindOutputs(outputs, 4);
+    BOOST_CHECK_EQUAL(coins.size(), owned_ids.size());
+    for (const mw::Coin& coin : coins) {
+        BOOST_CHECK(owned_ids.count(coin.output_id) == 1);
+        BOOST_CHECK(coin.HasSpendKey());
+
+        auto iter = std::find_if(outputs.begin(), outputs.end(), [&coin](const Output& output) { return output.GetOutputID() == coin.output_id; });
+        BOOST_REQUIRE(iter != outputs.end());
+        mw::Coin single;
+        BOOST_CHECK(mweb_keychain->RewindOutput(*iter, single));
+        BOOST_CHECK_EQUAL(single.amount, coin.amount);
+        BOOST_CHECK_EQUAL(single.address_index, coin.address_index);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
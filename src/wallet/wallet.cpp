@@ -2122,26 +2122,24 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                     }
                 }
 
-                mw::Coin mweb_coin;
-                for (const Output& output : block.mweb_block.m_block->GetOutputs()) {
-                    if (mweb_wallet->RewindOutput(output, mweb_coin)) {
-                        const CWalletTx* wtx = FindWalletTx(mweb_coin.output_id);
-                        if (wtx) {
-                            SyncTransaction(
-                                wtx->tx,
-                                wtx->mweb_wtx_info,
-                                {CWalletTx::Status::CONFIRMED, block_height, block_hash, wtx->m_confirm.nIndex},
-                                fUpdate
-                            );
-                        } else {
-                            AddToWallet(
-                                MakeTransactionRef(),
-                                boost::make_optional<MWEB::WalletTxInfo>(mweb_coin),
-                                {CWalletTx::Status::CONFIRMED, block_height, block_hash, 0},
-                                nullptr,
-                                false
-                            );
-                        }
+                // Scan all of the block's outputs at once, so they can be checked in parallel.
+                for (const mw::Coin& mweb_coin : mweb_wallet->RewindOutputs(block.mweb_block.m_block->GetOutputs())) {
+                    const CWalletTx* wtx = FindWalletTx(mweb_coin.output_id);
+                    if (wtx) {
+                        SyncTransaction(
+                            wtx->tx,
+                            wtx->mweb_wtx_info,
+                            {CWalletTx::Status::CONFIRMED, block_height, block_hash, wtx->m_confirm.nIndex},
+                            fUpdate
+                        );
+                    } else {
+                        AddToWallet(
+                            MakeTransactionRef(),
+                            boost::make_optional<MWEB::WalletTxInfo>(mweb_coin),
+                            {CWalletTx::Status::CONFIRMED, block_height, block_hash, 0},
+                            nullptr,
+                            false
+                        );
                     }
                 }
 
@@ -61,6 +61,34 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(result_by_id[3]['error'], None)
         assert result_by_id[3]['result'] is not None
 
+    def test_work_queues(self):
+        self.log.info("Testing HTTP work queues...")
+
+        def served():
+            queues = self.nodes[0].getrpcinfo()['work_queues']
+            assert_equal([q['class'] for q in queues], ['light', 'default', 'heavy'])
+            return {q['class']: q['served'] for q in queues}
+
+        # getrpcinfo is served on the light queue itself
+        before = served()
+        for _ in range(3):
+            self.nodes[0].getbestblockhash()
+        after = served()
+        assert_equal(after['light'], before['light'] + 4)
+        assert_equal(after['heavy'], before['heavy'])
+
+        self.nodes[0].getblock(self.nodes[0].getbestblockhash())
+        self.nodes[0].validateaddress("")
+        # A batch is served on the queue of its most expensive request
+        self.nodes[0].batch([
+            {"method": "getblockcount", "id": 1},
+            {"method": "getrawmempool", "id": 2},
+        ])
+        final = served()
+        assert_equal(final['light'], after['light'] + 2)
+        assert_equal(final['default'], after['default'] + 1)
+        assert_equal(final['heavy'], after['heavy'] + 2)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC requests...")
 
@@ -70,6 +98,7 @@ class RPCInterfaceTest(BitcoinTestFramework):
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
+        self.test_work_queues()
         self.test_http_status_codes()
 
 
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 The OpayK Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test compact block relay of blocks with MWEB transactions.
+
+Peers using MWEB short IDs reconstruct the MWEB block from the MWEB
+transactions in their mempool, and request the inputs, outputs and
+kernels they're missing with getblocktxn.
+"""
+
+import os
+import re
+
+from test_framework.ltc_util import setup_mweb_chain
+from test_framework.messages import (
+    BlockTransactionsRequest,
+    CInv,
+    MSG_CMPCT_BLOCK,
+    msg_getblocktxn,
+    msg_getdata,
+    msg_sendcmpct,
+)
+from test_framework.p2p import P2PInterface
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+
+class CompactBlockReceiver(P2PInterface):
+    def __init__(self):
+        super().__init__()
+        self.cmpctblock = None
+        self.blocktxn = None
+
+    def on_cmpctblock(self, message):
+        self.cmpctblock = message.header_and_shortids
+
+    def on_blocktxn(self, message):
+        self.blocktxn = message.block_transactions
+
+
+class MWEBCompactBlocksTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 3
+        # node1 receives the MWEB transactions before the block, node2 doesn't relay transactions.
+        self.extra_args = [
+            ['-whitelist=noban@127.0.0.1', '-debug=cmpctblock'],
+            ['-whitelist=noban@127.0.0.1', '-debug=cmpctblock'],
+            ['-blocksonly', '-debug=cmpctblock'],
+        ]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self):
+        self.setup_nodes()
+        self.connect_nodes(0, 1)
+        self.connect_nodes(0, 2)
+
+    def reconstructed_mweb_counts(self, node, block_hash):
+        debug_log = os.path.join(node.datadir, self.chain, 'debug.log')
+        pattern = r"Reconstructed block {} requested (\d+) MWEB inputs, (\d+) outputs and (\d+) kernels".format(block_hash)
+        match = None
+        def log_matches():
+            nonlocal match
+            with open(debug_log, encoding='utf-8') as dl:
+                match = re.search(pattern, dl.read())
+            return match is not None
+        self.wait_until(log_matches)
+        return tuple(int(count) for count in match.groups())
+
+    def run_test(self):
+        node0 = self.nodes[0]
+
+        self.log.info("Setup MWEB chain")
+        setup_mweb_chain(node0)
+        mweb_addr = node0.getnewaddress(address_type='mweb')
+        for _ in range(3):
+            node0.sendtoaddress(mweb_addr, 10)
+        node0.generate(100)
+        self.sync_all()
+
+        self.log.info("Relay pegin, MWEB-to-MWEB and pegout transactions to node1")
+        node0.sendtoaddress(node0.getnewaddress(address_type='mweb'), 5)
+        node0.sendtoaddress(node0.getnewaddress(address_type='mweb'), 2)
+        node0.sendtoaddress(node0.getnewaddress(), 1)
+        self.sync_mempools(self.nodes[:2])
+        assert_equal(len(self.nodes[2].getrawmempool()), 0)
+
+        block_hash = node0.generate(1)[0]
+        self.sync_blocks()
+        mweb = node0.getblock(block_hash, 2)['mweb']
+        num_inputs, num_outputs, num_kernels = len(mweb['inputs']), len(mweb['outputs']), len(mweb['kernels'])
+        assert num_inputs > 0 and num_outputs > 0 and num_kernels > 0
+        for node in self.nodes[1:]:
+            assert_equal(node.getblock(block_hash, 2)['mweb'], mweb)
+
+        self.log.info("Check node1 reconstructed the MWEB block from its mempool")
+        assert_equal(self.reconstructed_mweb_counts(self.nodes[1], block_hash), (0, 0, 0))
+
+        self.log.info("Check node2 requested all MWEB inputs, outputs and kernels")
+        assert_equal(self.reconstructed_mweb_counts(self.nodes[2], block_hash), (num_inputs, num_outputs, num_kernels))
+
+        self.log.info("Check a compact block is sent with MWEB short IDs")
+        peer = node0.add_p2p_connection(CompactBlockReceiver())
+        peer.send_and_ping(msg_sendcmpct(announce=False, version=3))
+        peer.send_and_ping(msg_getdata([CInv(MSG_CMPCT_BLOCK, int(block_hash, 16))]))
+        peer.wait_until(lambda: peer.cmpctblock is not None)
+        cmpctblock = peer.cmpctblock
+        assert cmpctblock.prefilled_txn[-1].tx.hogex
+        assert_equal(cmpctblock.mweb_header.hash, mweb['hash'])
+        assert_equal(len(cmpctblock.mweb_input_shortids), num_inputs)
+        assert_equal(len(cmpctblock.mweb_output_shortids), num_outputs)
+        assert_equal(len(cmpctblock.mweb_kernel_shortids), num_kernels)
+
+        self.log.info("Check getblocktxn is answered with the requested MWEB inputs, outputs and kernels")
+        getblocktxn = msg_getblocktxn()
+        getblocktxn.block_txn_request = BlockTransactionsRequest(int(block_hash, 16), [])
+        getblocktxn.block_txn_request.mweb_input_indexes = list(range(num_inputs))
+        getblocktxn.block_txn_request.mweb_output_indexes = [num_outputs - 1]
+        getblocktxn.block_txn_request.mweb_kernel_indexes = []
+        peer.send_and_ping(getblocktxn)
+        peer.wait_until(lambda: peer.blocktxn is not None)
+        assert_equal(peer.blocktxn.transactions, [])
+        # The vectors of inputs and then outputs are each preceded by their (small) size.
+        assert_equal(peer.blocktxn.mweb_txn[0], num_inputs)
+        assert_equal(peer.blocktxn.mweb_txn[-1], 0)
+
+        self.log.info("Check out-of-range MWEB indexes are rejected")
+        getblocktxn.block_txn_request.mweb_input_indexes = []
+        getblocktxn.block_txn_request.mweb_output_indexes = []
+        getblocktxn.block_txn_request.mweb_kernel_indexes = [num_kernels]
+        with node0.assert_debug_log(['getblocktxn with out-of-bounds MWEB indices']):
+            peer.send_and_ping(getblocktxn)
+
+
+if __name__ == '__main__':
+    MWEBCompactBlocksTest().main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 The OpayK Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the MWEB output index and the getmweboutput RPC"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_raises_rpc_error
+
+class MWEBIndexTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.extra_args = [['-mwebindex'], []]
+        self.num_nodes = 2
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def run_test(self):
+        node = self.nodes[0]
+
+        self.log.info("Activate MWEB and pegin some coins")
+        node.generate(431)
+        addr = node.getnewaddress(address_type='mweb')
+        node.sendtoaddress(addr, 10)
+        node.generate(10)
+        self.sync_all()
+
+        self.log.info("Check getindexinfo reports the MWEB index")
+        assert 'mwebindex' in node.getindexinfo()
+        assert 'mwebindex' not in self.nodes[1].getindexinfo()
+
+        self.log.info("Look up every output created so far")
+        tip_height = node.getblockcount()
+        created = {}
+        for height in range(432, tip_height + 1):
+            block_hash = node.getblockhash(height)
+            block = node.getblock(block_hash, 2)
+            for position, output in enumerate(block['mweb']['outputs']):
+                created[output['output_id']] = (block_hash, height, position, output)
+        assert len(created) > 0
+
+        for output_id, (block_hash, height, position, output) in created.items():
+            result = node.getmweboutput(output_id)
+            assert_equal(result['blockhash'], block_hash)
+            assert_equal(result['height'], height)
+            assert_equal(result['position'], position)
+            assert_equal(result['confirmations'], tip_height - height + 1)
+            assert_equal(result['commit'], output['commit'])
+            assert_equal(result['spent'], False)
+
+        self.log.info("Spend MWEB coins and check the spent outputs are still found")
+        node.sendtoaddress(node.getnewaddress(address_type='mweb'), 5)
+        spend_hash = node.generate(1)[0]
+        spent_ids = node.getblock(spend_hash, 1)['mweb']['inputs']
+        assert len(spent_ids) > 0
+        for output_id in spent_ids:
+            result = node.getmweboutput(output_id)
+            assert_equal(result['blockhash'], created[output_id][0])
+            assert_equal(result['spent'], True)
+
+        self.log.info("Check outputs that follow inputs in their block are found")
+        for position, output in enumerate(node.getblock(spend_hash, 2)['mweb']['outputs']):
+            result = node.getmweboutput(output['output_id'])
+            assert_equal(result['blockhash'], spend_hash)
+            assert_equal(result['position'], position)
+            assert_equal(result['commit'], output['commit'])
+
+        self.log.info("Check leaf indexes are unique")
+        leaf_indexes = [node.getmweboutput(output_id)['leaf_index'] for output_id in created]
+        assert_equal(len(set(leaf_indexes)), len(leaf_indexes))
+
+        self.log.info("Check errors")
+        assert_raises_rpc_error(-5, "No such MWEB output", node.getmweboutput, "00" * 32)
+        assert_raises_rpc_error(-8, "output_id must be of length 64", node.getmweboutput, "00")
+        assert_raises_rpc_error(-1, "Requires -mwebindex", self.nodes[1].getmweboutput, "00" * 32)
+
+if __name__ == '__main__':
+    MWEBIndexTest().main()
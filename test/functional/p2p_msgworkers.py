@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 The OpayK Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test serving getdata, getheaders and getcfilters on message worker threads.
+
+Checks the responses served by -msgworkerthreads match the chain, and that
+a peer's responses are sent in the order its requests were received, also
+relative to messages handled by the message handler thread (ping/pong).
+"""
+
+from test_framework.messages import (
+    CInv,
+    FILTER_TYPE_BASIC,
+    MSG_BLOCK,
+    msg_getcfilters,
+    msg_getdata,
+    msg_getheaders,
+    msg_ping,
+)
+from test_framework.p2p import P2PInterface
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+
+class P2PEventStore(P2PInterface):
+    def __init__(self):
+        super().__init__()
+        # Responses received, in order.
+        self.events = []
+
+    def on_block(self, message):
+        message.block.calc_sha256()
+        self.events.append(("block", message.block.sha256))
+
+    def on_headers(self, message):
+        for header in message.headers:
+            header.calc_sha256()
+        self.events.append(("headers", [header.sha256 for header in message.headers]))
+
+    def on_cfilter(self, message):
+        self.events.append(("cfilter", message.block_hash))
+
+    def on_pong(self, message):
+        self.events.append(("pong", message.nonce))
+
+    def pop_events_until_pong(self, nonce):
+        self.wait_until(lambda: ("pong", nonce) in self.events)
+        with self.lock:
+            index = self.events.index(("pong", nonce))
+            events = self.events[:index]
+            self.events = self.events[index + 1:]
+        return events
+
+
+class MsgWorkersTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [["-msgworkerthreads=2", "-blockfilterindex", "-peerblockfilters"]]
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(20)
+        self.wait_until(lambda: node.getindexinfo()['basic block filter index']['synced'])
+        block_hashes = [int(node.getblockhash(height), 16) for height in range(1, 21)]
+        tip = block_hashes[-1]
+
+        peer = node.add_p2p_connection(P2PEventStore())
+
+        self.log.info("Check getdata is answered in order and before a following ping")
+        getdata = msg_getdata([CInv(MSG_BLOCK, block_hash) for block_hash in block_hashes])
+        peer.send_message(getdata)
+        peer.send_message(msg_ping(nonce=1))
+        assert_equal(peer.pop_events_until_pong(1), [("block", block_hash) for block_hash in block_hashes])
+
+        self.log.info("Check getheaders is answered before a following ping")
+        getheaders = msg_getheaders()
+        getheaders.locator.vHave = [int(node.getblockhash(0), 16)]
+        peer.send_message(getheaders)
+        peer.send_message(msg_ping(nonce=2))
+        assert_equal(peer.pop_events_until_pong(2), [("headers", block_hashes)])
+
+        self.log.info("Check getcfilters is answered in order and before a following ping")
+        peer.send_message(msg_getcfilters(filter_type=FILTER_TYPE_BASIC, start_height=1, stop_hash=tip))
+        peer.send_message(msg_ping(nonce=3))
+        assert_equal(peer.pop_events_until_pong(3), [("cfilter", block_hash) for block_hash in block_hashes])
+
+        self.log.info("Check interleaved requests are answered in the order they were sent")
+        for nonce in range(4, 14):
+            block_hash = block_hashes[nonce]
+            peer.send_message(msg_getdata([CInv(MSG_BLOCK, block_hash)]))
+            getheaders = msg_getheaders()
+            getheaders.locator.vHave = [block_hashes[nonce - 1]]
+            getheaders.hashstop = block_hash
+            peer.send_message(getheaders)
+            peer.send_message(msg_getcfilters(filter_type=FILTER_TYPE_BASIC, start_height=nonce + 1, stop_hash=block_hash))
+            peer.send_message(msg_ping(nonce=nonce))
+        for nonce in range(4, 14):
+            block_hash = block_hashes[nonce]
+            assert_equal(peer.pop_events_until_pong(nonce), [
+                ("block", block_hash),
+                ("headers", [block_hash]),
+                ("cfilter", block_hash),
+            ])
+
+        self.log.info("Check the peer is still connected")
+        peer.sync_with_ping()
+        assert_equal(len(node.getpeerinfo()), 1)
+
+
+if __name__ == '__main__':
+    MsgWorkersTest().main()
@@ -34,7 +34,7 @@ from test_framework.siphash import siphash256
 from test_framework.util import hex_str_to_bytes, assert_equal
 
 MIN_VERSION_SUPPORTED = 60001
-MY_VERSION = 70016  # past wtxid relay
+MY_VERSION = 70017  # past MWEB short IDs
 MY_SUBVERSION = b"/python-p2p-tester:0.0.3/"
 MY_RELAY = 1 # from version 70001 onwards, fRelay should be appended to version messages (BIP37)
 
@@ -847,7 +847,8 @@ class PrefilledTransaction:
 # This is what we send on the wire, in a cmpctblock message.
 class P2PHeaderAndShortIDs:
     __slots__ = ("header", "nonce", "prefilled_txn", "prefilled_txn_length",
-                 "shortids", "shortids_length", "mweb_block")
+                 "shortids", "shortids_length", "mweb_header", "mweb_input_shortids",
+                 "mweb_output_shortids", "mweb_kernel_shortids")
 
     def __init__(self):
         self.header = CBlockHeader()
@@ -856,35 +857,46 @@ class P2PHeaderAndShortIDs:
         self.shortids = []
         self.prefilled_txn_length = 0
         self.prefilled_txn = []
-        self.mweb_block = None
+        self.mweb_header = None
+        self.mweb_input_shortids = []
+        self.mweb_output_shortids = []
+        self.mweb_kernel_shortids = []
 
     def deserialize(self, f):
         self.header.deserialize(f)
         self.nonce = struct.unpack("<Q", f.read(8))[0]
-        self.shortids_length = deser_compact_size(f)
-        for _ in range(self.shortids_length):
-            # shortids are defined to be 6 bytes in the spec, so append
-            # two zero bytes and read it in as an 8-byte number
-            self.shortids.append(struct.unpack("<Q", f.read(6) + b'\x00\x00')[0])
+        self.shortids = deser_shortids(f)
+        self.shortids_length = len(self.shortids)
         self.prefilled_txn = deser_vector(f, PrefilledTransaction)
         self.prefilled_txn_length = len(self.prefilled_txn)
-        
+
+        # The MWEB header and the short IDs of the MWEB inputs, outputs and kernels,
+        # sent to version 3 peers using MWEB short IDs.
         if len(self.prefilled_txn) > 0 and self.prefilled_txn[-1].tx.hogex:
-            self.mweb_block = deser_mweb_block(f)
-                
+            if struct.unpack("B", f.read(1))[0] == 1:
+                self.mweb_header = MWEBHeader()
+                self.mweb_header.deserialize(f)
+                self.mweb_input_shortids = deser_shortids(f)
+                self.mweb_output_shortids = deser_shortids(f)
+                self.mweb_kernel_shortids = deser_shortids(f)
+
     # When using version 2 compact blocks, we must serialize with_witness.
     # When using version 3 compact blocks, we must serialize with_mweb.
     def serialize(self, version=1):
         r = b""
         r += self.header.serialize()
         r += struct.pack("<Q", self.nonce)
-        r += ser_compact_size(self.shortids_length)
-        for x in self.shortids:
-            # We only want the first 6 bytes
-            r += struct.pack("<Q", x)[0:6]
+        r += ser_shortids(self.shortids)
         if version >= 3:
             r += ser_vector(self.prefilled_txn, "serialize_with_mweb")
-            r += ser_mweb_block(self.mweb_block)
+            if self.mweb_header is None:
+                r += struct.pack("B", 0)
+            else:
+                r += struct.pack("B", 1)
+                r += self.mweb_header.serialize()
+                r += ser_shortids(self.mweb_input_shortids)
+                r += ser_shortids(self.mweb_output_shortids)
+                r += ser_shortids(self.mweb_kernel_shortids)
         elif version == 2:
             r += ser_vector(self.prefilled_txn, "serialize_with_witness")
         else:
@@ -894,6 +906,21 @@ class P2PHeaderAndShortIDs:
     def __repr__(self):
         return "P2PHeaderAndShortIDs(header=%s, nonce=%d, shortids_length=%d, shortids=%s, prefilled_txn_length=%d, prefilledtxn=%s" % (repr(self.header), self.nonce, self.shortids_length, repr(self.shortids), self.prefilled_txn_length, repr(self.prefilled_txn))
 
+# shortids are defined to be 6 bytes in the spec, so append two zero bytes
+# and read each in as an 8-byte number
+def deser_shortids(f):
+    nit = deser_compact_size(f)
+    return [struct.unpack("<Q", f.read(6) + b'\x00\x00')[0] for _ in range(nit)]
+
+
+def ser_shortids(l):
+    r = ser_compact_size(len(l))
+    for x in l:
+        # We only want the first 6 bytes
+        r += struct.pack("<Q", x)[0:6]
+    return r
+
+
 # Calculate the BIP 152-compact blocks shortid for a given transaction hash
 def calculate_shortid(k0, k1, tx_hash):
     expected_shortid = siphash256(k0, k1, tx_hash)
@@ -904,19 +931,27 @@ def calculate_shortid(k0, k1, tx_hash):
 # This version gets rid of the array lengths, and reinterprets the differential
 # encoding into indices that can be used for lookup.
 class HeaderAndShortIDs:
-    __slots__ = ("header", "nonce", "prefilled_txn", "shortids", "mweb_block")
+    __slots__ = ("header", "nonce", "prefilled_txn", "shortids", "mweb_header",
+                 "mweb_input_shortids", "mweb_output_shortids", "mweb_kernel_shortids")
 
     def __init__(self, p2pheaders_and_shortids = None):
         self.header = CBlockHeader()
         self.nonce = 0
         self.shortids = []
         self.prefilled_txn = []
-        self.mweb_block = None
+        self.mweb_header = None
+        self.mweb_input_shortids = []
+        self.mweb_output_shortids = []
+        self.mweb_kernel_shortids = []
 
         if p2pheaders_and_shortids is not None:
             self.header = p2pheaders_and_shortids.header
             self.nonce = p2pheaders_and_shortids.nonce
             self.shortids = p2pheaders_and_shortids.shortids
+            self.mweb_header = p2pheaders_and_shortids.mweb_header
+            self.mweb_input_shortids = p2pheaders_and_shortids.mweb_input_shortids
+            self.mweb_output_shortids = p2pheaders_and_shortids.mweb_output_shortids
+            self.mweb_kernel_shortids = p2pheaders_and_shortids.mweb_kernel_shortids
             last_index = -1
             for x in p2pheaders_and_shortids.prefilled_txn:
                 self.prefilled_txn.append(PrefilledTransaction(x.index + last_index + 1, x.tx))
@@ -928,7 +963,10 @@ class HeaderAndShortIDs:
         ret.nonce = self.nonce
         ret.shortids_length = len(self.shortids)
         ret.shortids = self.shortids
-        ret.mweb_block = self.mweb_block
+        ret.mweb_header = self.mweb_header
+        ret.mweb_input_shortids = self.mweb_input_shortids
+        ret.mweb_output_shortids = self.mweb_output_shortids
+        ret.mweb_kernel_shortids = self.mweb_kernel_shortids
         ret.prefilled_txn_length = len(self.prefilled_txn)
         ret.prefilled_txn = []
         last_index = -1
@@ -946,15 +984,16 @@ class HeaderAndShortIDs:
         return [ key0, key1 ]
 
     # Version 2 compact blocks use wtxid in shortids (rather than txid)
-    # Version 3 compact blocks include an optional mweb block
+    # Version 3 compact blocks include an optional mweb header and mweb shortids
     def initialize_from_block(self, block, nonce=0, prefill_list=None, version=1):
+        # MWEBBlock doesn't deserialize the inputs, outputs and kernels, so their shortids can't be calculated
+        assert block.mweb_block is None
         if prefill_list is None:
             prefill_list = [0]
         self.header = CBlockHeader(block)
         self.nonce = nonce
         self.prefilled_txn = [ PrefilledTransaction(i, block.vtx[i]) for i in prefill_list ]
         self.shortids = []
-        self.mweb_block = block.mweb_block
         [k0, k1] = self.get_siphash_keys()
         for i in range(len(block.vtx)):
             if i not in prefill_list:
@@ -964,28 +1003,42 @@ class HeaderAndShortIDs:
                 self.shortids.append(calculate_shortid(k0, k1, tx_hash))
 
     def __repr__(self):
-        return "HeaderAndShortIDs(header=%s, nonce=%d, shortids=%s, prefilledtxn=%s" % (repr(self.header), self.nonce, repr(self.shortids), repr(self.prefilled_txn))
+        return "HeaderAndShortIDs(header=%s, nonce=%d, shortids=%s, prefilledtxn=%s, mweb_header=%s" % (repr(self.header), self.nonce, repr(self.shortids), repr(self.prefilled_txn), repr(self.mweb_header))
 
 
 class BlockTransactionsRequest:
-    __slots__ = ("blockhash", "indexes")
+    __slots__ = ("blockhash", "indexes", "mweb_input_indexes", "mweb_output_indexes", "mweb_kernel_indexes")
 
+    # Unlike indexes, the MWEB indexes are absolute, and only differentially encoded on the wire.
     def __init__(self, blockhash=0, indexes = None):
         self.blockhash = blockhash
         self.indexes = indexes if indexes is not None else []
+        self.mweb_input_indexes = []
+        self.mweb_output_indexes = []
+        self.mweb_kernel_indexes = []
 
     def deserialize(self, f):
         self.blockhash = deser_uint256(f)
         indexes_length = deser_compact_size(f)
         for _ in range(indexes_length):
             self.indexes.append(deser_compact_size(f))
-
+        # Only sent to peers using MWEB short IDs
+        if f.read(1):
+            f.seek(-1, 1)
+            self.mweb_input_indexes = deser_differential_indexes(f)
+            self.mweb_output_indexes = deser_differential_indexes(f)
+            self.mweb_kernel_indexes = deser_differential_indexes(f)
+
+    # The MWEB indexes are always sent, since nodes ignore them from peers not using MWEB short IDs.
     def serialize(self):
         r = b""
         r += ser_uint256(self.blockhash)
         r += ser_compact_size(len(self.indexes))
         for x in self.indexes:
             r += ser_compact_size(x)
+        r += ser_differential_indexes(self.mweb_input_indexes)
+        r += ser_differential_indexes(self.mweb_output_indexes)
+        r += ser_differential_indexes(self.mweb_kernel_indexes)
         return r
 
     # helper to set the differentially encoded indexes from absolute ones
@@ -1005,25 +1058,49 @@ class BlockTransactionsRequest:
         return absolute_indexes
 
     def __repr__(self):
-        return "BlockTransactionsRequest(hash=%064x indexes=%s)" % (self.blockhash, repr(self.indexes))
+        return "BlockTransactionsRequest(hash=%064x indexes=%s mweb_input_indexes=%s mweb_output_indexes=%s mweb_kernel_indexes=%s)" % (
+            self.blockhash, repr(self.indexes), repr(self.mweb_input_indexes), repr(self.mweb_output_indexes), repr(self.mweb_kernel_indexes))
+
+
+def deser_differential_indexes(f):
+    indexes = []
+    last_index = -1
+    for _ in range(deser_compact_size(f)):
+        indexes.append(deser_compact_size(f) + last_index + 1)
+        last_index = indexes[-1]
+    return indexes
+
+
+def ser_differential_indexes(l):
+    r = ser_compact_size(len(l))
+    last_index = -1
+    for x in l:
+        r += ser_compact_size(x - last_index - 1)
+        last_index = x
+    return r
 
 
 class BlockTransactions:
-    __slots__ = ("blockhash", "transactions")
+    __slots__ = ("blockhash", "transactions", "mweb_txn")
 
+    # mweb_txn holds the serialized MWEB inputs, outputs and kernels, which default to none.
     def __init__(self, blockhash=0, transactions = None):
         self.blockhash = blockhash
         self.transactions = transactions if transactions is not None else []
+        self.mweb_txn = b"\x00\x00\x00"
 
     def deserialize(self, f):
         self.blockhash = deser_uint256(f)
         self.transactions = deser_vector(f, CTransaction)
+        # Only sent to peers using MWEB short IDs
+        self.mweb_txn = f.read()
 
     def serialize(self, with_witness=True, with_mweb=True):
         r = b""
         r += ser_uint256(self.blockhash)
         if with_mweb and with_witness:
             r += ser_vector(self.transactions, "serialize_with_mweb")
+            r += self.mweb_txn
         elif with_witness:
             r += ser_vector(self.transactions, "serialize_with_witness")
         else:
@@ -1956,11 +2033,11 @@ class MWEBHeader:
 
     def deserialize(self, f):
         self.height = deser_varint(f)
-        self.output_root = deser_uint256(f)
-        self.kernel_root = deser_uint256(f)
-        self.leafset_root = deser_uint256(f)
-        self.kernel_offset = deser_uint256(f)
-        self.stealth_offset = deser_uint256(f)
+        self.output_root = f.read(32)
+        self.kernel_root = f.read(32)
+        self.leafset_root = f.read(32)
+        self.kernel_offset = f.read(32)
+        self.stealth_offset = f.read(32)
         self.num_txos = deser_varint(f)
         self.num_kernels = deser_varint(f)
         self.rehash()
@@ -180,6 +180,7 @@ BASE_SCRIPTS = [
     'p2p_addr_relay.py',
     'p2p_getaddr_caching.py',
     'p2p_getdata.py',
+    'p2p_msgworkers.py',
     'rpc_net.py',
     'wallet_keypool.py',
     'wallet_keypool.py --descriptors',
@@ -246,6 +247,8 @@ BASE_SCRIPTS = [
     'feature_dersig.py',
     'feature_cltv.py',
     'mweb_basic.py',
+    'mweb_compactblocks.py',
+    'mweb_index.py',
     'mweb_mining.py',
     'mweb_reorg.py',
     'mweb_pegout_all.py',